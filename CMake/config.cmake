@@ -24,9 +24,11 @@
 # build options
 option(BUILD_UNIT_TESTS "Build unit tests for srcSAX" ON)
 option(BUILD_EXAMPLES "Build unit tests for srcSAX" ON)
+option(BUILD_BENCHMARKS "Build benchmarks for srcSAX (requires Google Benchmark)" OFF)
 
 # find needed libraries
 find_package(LibXml2 REQUIRED)
+find_package(Threads REQUIRED)
 
 # include needed includes
 include_directories(${LIBXML2_INCLUDE_DIR})
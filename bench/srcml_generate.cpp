@@ -0,0 +1,76 @@
+/**
+ * @file srcml_generate.cpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+ /*
+
+  Generate a synthetic srcML archive for benchmarking.
+
+  Useage: srcml_generate output_file.xml [units [elements [depth [attributes [text_ratio [seed]]]]]]
+
+  */
+
+#include "srcml_generator.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <iostream>
+
+/**
+ * main
+ * @param argc number of arguments
+ * @param argv the provided arguments (array of C strings)
+ *
+ * Write a generated srcML archive of the given shape to the output file.
+ */
+int main(int argc, char * argv[]) {
+
+  if(argc < 2) {
+
+    std::cerr << "Useage: srcml_generate output_file.xml [units [elements [depth [attributes [text_ratio [seed]]]]]]\n";
+    exit(1);
+
+  }
+
+  srcml_generator_options options;
+  if(argc > 2) options.units = strtoul(argv[2], 0, 10);
+  if(argc > 3) options.elements = strtoul(argv[3], 0, 10);
+  if(argc > 4) options.depth = strtoul(argv[4], 0, 10);
+  if(argc > 5) options.attributes = strtod(argv[5], 0);
+  if(argc > 6) options.text_ratio = strtod(argv[6], 0);
+  if(argc > 7) options.seed = (uint32_t)strtoul(argv[7], 0, 10);
+
+  if(options.depth == 0) options.depth = 1;
+
+  srcml_generator generator(options);
+  const std::string & srcml = generator.generate();
+
+  FILE * output = fopen(argv[1], "w");
+  if(output == 0) {
+
+    std::cerr << "Problems opening output file: " << argv[1] << '\n';
+    exit(1);
+
+  }
+
+  fwrite(srcml.c_str(), 1, srcml.size(), output);
+  fclose(output);
+
+  return 0;
+}
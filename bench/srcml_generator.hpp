@@ -0,0 +1,243 @@
+/**
+ * @file srcml_generator.hpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INCLUDED_SRCML_GENERATOR_HPP
+#define INCLUDED_SRCML_GENERATOR_HPP
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * srcml_generator_options
+ *
+ * Shape of a generated srcML archive.
+ */
+struct srcml_generator_options {
+
+    /** default constructor */
+    srcml_generator_options() : units(100), elements(500), depth(12), attributes(0.25), text_ratio(0.6), seed(1) {}
+
+    /** number of units in the archive */
+    size_t units;
+
+    /** number of elements in each unit */
+    size_t elements;
+
+    /** maximum element nesting depth within a unit */
+    size_t depth;
+
+    /** average number of attributes per element */
+    double attributes;
+
+    /** probability of text before each tag */
+    double text_ratio;
+
+    /** random seed, the same options always generate the same archive */
+    uint32_t seed;
+
+};
+
+/**
+ * srcml_generator
+ *
+ * Generator of synthetic srcML archives for benchmarking.
+ */
+class srcml_generator {
+
+private :
+
+    /** generation options */
+    srcml_generator_options options;
+
+    /** random state (xorshift32, identical on all platforms) */
+    uint32_t state;
+
+    /** generated archive */
+    std::string srcml;
+
+    /**
+     * next
+     *
+     * @returns the next random number.
+     */
+    uint32_t next() {
+
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+
+        return state;
+
+    }
+
+    /**
+     * chance
+     * @param probability the probability of true
+     *
+     * @returns true with the given probability.
+     */
+    bool chance(double probability) {
+
+        return (next() % 10000) < probability * 10000;
+
+    }
+
+    /**
+     * text
+     *
+     * Append a run of source code text, occasionally with escaped characters.
+     */
+    void text() {
+
+        static const char * const words[] = { "i", "x", "count", "size", "=", "+", "(", ")", "{", "}", ";", "&lt;", "&gt;", "&amp;", "return", "0", "1" };
+        static const size_t num_words = sizeof(words) / sizeof(words[0]);
+
+        size_t num = 1 + next() % 6;
+        for(size_t i = 0; i < num; ++i) {
+
+            if(i) srcml += ' ';
+            srcml += words[next() % num_words];
+
+        }
+
+    }
+
+    /**
+     * attributes
+     *
+     * Append the attributes of an element.
+     */
+    void attributes() {
+
+        static const char * const names[] = { "type", "ref", "id", "pos:line" };
+        static const size_t num_names = sizeof(names) / sizeof(names[0]);
+
+        size_t num = (size_t)options.attributes;
+        if(chance(options.attributes - num)) ++num;
+
+        for(size_t i = 0; i < num && i < num_names; ++i) {
+
+            srcml += ' ';
+            srcml += names[i];
+            srcml += "=\"";
+            srcml += std::to_string(next() % 1000);
+            srcml += '"';
+
+        }
+
+    }
+
+    /**
+     * unit
+     * @param number the unit's position in the archive
+     *
+     * Append a unit.
+     */
+    void unit(size_t number) {
+
+        static const char * const elements[] = { "function", "name", "block", "expr_stmt", "expr", "decl_stmt", "decl", "type",
+                                                 "call", "argument_list", "argument", "if", "condition", "then", "else", "return",
+                                                 "for", "while", "comment", "operator", "literal", "cpp:if", "cpp:include", "cpp:directive" };
+        static const size_t num_elements = sizeof(elements) / sizeof(elements[0]);
+
+        srcml += "<unit language=\"C++\" filename=\"file";
+        srcml += std::to_string(number);
+        srcml += ".cpp\">";
+
+        std::vector<const char *> open;
+        for(size_t count = 0; count < options.elements; ) {
+
+            if(chance(options.text_ratio)) text();
+
+            if(open.empty() || (open.size() < options.depth && chance(0.55))) {
+
+                const char * name = elements[next() % num_elements];
+                srcml += '<';
+                srcml += name;
+                attributes();
+                srcml += '>';
+
+                open.push_back(name);
+                ++count;
+
+            } else {
+
+                srcml += "</";
+                srcml += open.back();
+                srcml += '>';
+
+                open.pop_back();
+
+            }
+
+        }
+
+        while(!open.empty()) {
+
+            if(chance(options.text_ratio)) text();
+
+            srcml += "</";
+            srcml += open.back();
+            srcml += '>';
+
+            open.pop_back();
+
+        }
+
+        srcml += "</unit>\n\n";
+
+    }
+
+public :
+
+    /**
+     * srcml_generator
+     * @param options shape of the archive
+     *
+     * Constructor
+     */
+    srcml_generator(const srcml_generator_options & options) : options(options), state(options.seed ? options.seed : 1), srcml() {}
+
+    /**
+     * generate
+     *
+     * Generate the archive.
+     *
+     * @returns the srcML archive.
+     */
+    const std::string & generate() {
+
+        srcml = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+                "<unit xmlns=\"http://www.sdml.info/srcML/src\" xmlns:cpp=\"http://www.sdml.info/srcML/cpp\""
+                " xmlns:pos=\"http://www.sdml.info/srcML/position\">\n\n";
+
+        for(size_t number = 0; number < options.units; ++number)
+            unit(number);
+
+        srcml += "</unit>\n";
+
+        return srcml;
+
+    }
+
+};
+
+#endif
@@ -0,0 +1,664 @@
+/**
+ * @file srcsax_benchmark.cpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+ /*
+
+  Throughput benchmarks of srcSAX on generated srcML archives.
+
+  Reports MB/s (bytes_per_second), events/s and heap allocations per event
+  (operator new and the libxml2 allocator).
+
+  Useage: srcsax_benchmark [--benchmark_filter=regex] [other Google Benchmark options]
+
+  */
+
+#include "srcml_generator.hpp"
+
+#include <element_count/element_count_handler.hpp>
+#include <identity_copy/identity_copy_handler.hpp>
+#include <print_callbacks/print_callbacks_handler.hpp>
+
+#include <srcSAXController.hpp>
+#include <srcSAXHandler.hpp>
+#include <srcsax.h>
+#include <srcsax_writer.h>
+
+#include <benchmark/benchmark.h>
+
+#include <libxml/xmlmemory.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <map>
+#include <vector>
+#include <new>
+
+/** number of heap allocations */
+static std::atomic<size_t> allocations(0);
+
+// GCC takes the free of the replaced operator delete for one of memory from operator new
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void * operator new(size_t size) {
+
+    ++allocations;
+
+    void * ptr = malloc(size ? size : 1);
+    if(ptr == 0) throw std::bad_alloc();
+
+    return ptr;
+
+}
+
+void * operator new[](size_t size) {
+
+    return operator new(size);
+
+}
+
+void operator delete(void * ptr) noexcept {
+
+    free(ptr);
+
+}
+
+void operator delete[](void * ptr) noexcept {
+
+    free(ptr);
+
+}
+
+void operator delete(void * ptr, size_t) noexcept {
+
+    free(ptr);
+
+}
+
+void operator delete[](void * ptr, size_t) noexcept {
+
+    free(ptr);
+
+}
+
+#pragma GCC diagnostic pop
+
+/**
+ * count_malloc
+ * @param size the number of bytes
+ *
+ * libxml2 malloc counting allocations.
+ *
+ * @returns the allocated memory.
+ */
+static void * count_malloc(size_t size) {
+
+    ++allocations;
+
+    return malloc(size);
+
+}
+
+/**
+ * count_realloc
+ * @param ptr the memory to reallocate
+ * @param size the number of bytes
+ *
+ * libxml2 realloc counting allocations.
+ *
+ * @returns the reallocated memory.
+ */
+static void * count_realloc(void * ptr, size_t size) {
+
+    ++allocations;
+
+    return realloc(ptr, size);
+
+}
+
+/**
+ * count_strdup
+ * @param str the string to duplicate
+ *
+ * libxml2 strdup counting allocations.
+ *
+ * @returns the duplicated string.
+ */
+static char * count_strdup(const char * str) {
+
+    ++allocations;
+
+    return strdup(str);
+
+}
+
+/**
+ * count_event
+ * @param context a srcSAX context
+ *
+ * Count an event.
+ */
+static void count_event(struct srcsax_context * context) {
+
+    ++*(size_t *)context->data;
+
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+static void count_start(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                        int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                        const struct srcsax_attribute * attributes) { count_event(context); }
+static void count_end(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI) { count_event(context); }
+static void count_characters(struct srcsax_context * context, const char * ch, int len) { count_event(context); }
+static void count_comment(struct srcsax_context * context, const char * value) { count_event(context); }
+static void count_processing_instruction(struct srcsax_context * context, const char * target, const char * data) { count_event(context); }
+
+#pragma GCC diagnostic pop
+
+/**
+ * count_handler
+ *
+ * @returns srcsax_handler counting every event.
+ */
+static srcsax_handler count_handler() {
+
+    srcsax_handler handler;
+
+    handler.start_document = count_event;
+    handler.end_document = count_event;
+    handler.start_root = count_start;
+    handler.start_unit = count_start;
+    handler.start_element = count_start;
+    handler.end_root = count_end;
+    handler.end_unit = count_end;
+    handler.end_element = count_end;
+    handler.characters_root = count_characters;
+    handler.characters_unit = count_characters;
+    handler.meta_tag = count_start;
+    handler.comment = count_comment;
+    handler.cdata_block = count_characters;
+    handler.processing_instruction = count_processing_instruction;
+    handler.start_function = 0;
+    handler.end_function = 0;
+
+    return handler;
+
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+static void write_start_document(struct srcsax_context * context) { srcsax_write_start_document((srcsax_writer *)context->data); }
+static void write_end_document(struct srcsax_context * context) { srcsax_write_end_document((srcsax_writer *)context->data); }
+static void write_start(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                        int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                        const struct srcsax_attribute * attributes) {
+    srcsax_write_start_element((srcsax_writer *)context->data, localname, prefix, num_namespaces, namespaces, num_attributes, attributes);
+}
+static void write_start_root(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                             int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                             const struct srcsax_attribute * attributes) {
+    if(context->is_archive) write_start(context, localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+}
+static void write_end(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI) {
+    srcsax_write_end_element((srcsax_writer *)context->data, localname, prefix);
+}
+static void write_end_root(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI) {
+    if(context->is_archive) write_end(context, localname, prefix, URI);
+}
+static void write_meta_tag(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                           int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                           const struct srcsax_attribute * attributes) {
+    write_start(context, localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+    write_end(context, localname, prefix, URI);
+}
+static void write_characters(struct srcsax_context * context, const char * ch, int len) { srcsax_write_characters((srcsax_writer *)context->data, ch, len); }
+
+#pragma GCC diagnostic pop
+
+/**
+ * write_handler
+ *
+ * @returns srcsax_handler copying the document to the srcsax_writer in the context's data.
+ */
+static srcsax_handler write_handler() {
+
+    srcsax_handler handler = srcsax_handler();
+
+    handler.start_document = write_start_document;
+    handler.end_document = write_end_document;
+    handler.start_root = write_start_root;
+    handler.start_unit = write_start;
+    handler.start_element = write_start;
+    handler.end_root = write_end_root;
+    handler.end_unit = write_end;
+    handler.end_element = write_end;
+    handler.characters_root = write_characters;
+    handler.characters_unit = write_characters;
+    handler.meta_tag = write_meta_tag;
+
+    return handler;
+
+}
+
+/**
+ * corpus
+ *
+ * Generated archive and its number of events.
+ */
+struct corpus {
+
+    /** the srcML archive */
+    std::string srcml;
+
+    /** number of srcSAX events of the archive */
+    size_t events;
+
+};
+
+/**
+ * get_corpus
+ * @param units number of units in the archive
+ *
+ * Generate (once) the archive of the given number of units.
+ *
+ * @returns the corpus.
+ */
+static const corpus & get_corpus(size_t units) {
+
+    static std::map<size_t, corpus> corpora;
+
+    std::map<size_t, corpus>::iterator itr = corpora.find(units);
+    if(itr != corpora.end()) return itr->second;
+
+    srcml_generator_options options;
+    options.units = units;
+
+    corpus & generated = corpora[units];
+    generated.srcml = srcml_generator(options).generate();
+    generated.events = 0;
+
+    srcsax_context * context = srcsax_create_context_memory(generated.srcml.c_str(), generated.srcml.size(), 0);
+    srcsax_handler handler = count_handler();
+    context->data = &generated.events;
+    srcsax_parse_handler(context, &handler);
+    srcsax_free_context(context);
+
+    return generated;
+
+}
+
+/**
+ * run
+ * @param state the benchmark state
+ * @param parse parse the archive once
+ *
+ * Run a benchmark and report MB/s, events/s and allocations per event.
+ */
+template<class Parse>
+static void run(benchmark::State & state, Parse parse) {
+
+    const corpus & input = get_corpus(state.range(0));
+
+    size_t start_allocations = allocations;
+    for(auto _ : state)
+        parse(input.srcml);
+    size_t total_allocations = allocations - start_allocations;
+
+    double events = (double)input.events * state.iterations();
+
+    state.SetBytesProcessed((int64_t)(input.srcml.size() * state.iterations()));
+    state.counters["events/s"] = benchmark::Counter(events, benchmark::Counter::kIsRate);
+    state.counters["allocs/event"] = benchmark::Counter(events ? total_allocations / events : 0);
+
+}
+
+/**
+ * BM_srcsax_parse
+ *
+ * C API parse with an event counting handler.
+ */
+static void BM_srcsax_parse(benchmark::State & state) {
+
+    run(state, [](const std::string & srcml) {
+
+        size_t events = 0;
+        srcsax_context * context = srcsax_create_context_memory(srcml.c_str(), srcml.size(), 0);
+        srcsax_handler handler = count_handler();
+        context->data = &events;
+        srcsax_parse_handler(context, &handler);
+        srcsax_free_context(context);
+
+        benchmark::DoNotOptimize(events);
+
+    });
+
+}
+
+/**
+ * BM_srcsax_write
+ *
+ * C API parse copying the document with srcsax_writer to /dev/null, compare to
+ * BM_identity_copy for the same copy through the example handler.
+ */
+static void BM_srcsax_write(benchmark::State & state) {
+
+    int fd = open("/dev/null", O_WRONLY);
+
+    run(state, [fd](const std::string & srcml) {
+
+        srcsax_writer * writer = srcsax_create_writer_fd(fd);
+        srcsax_context * context = srcsax_create_context_memory(srcml.c_str(), srcml.size(), 0);
+        srcsax_handler handler = write_handler();
+        context->data = writer;
+        srcsax_parse_handler(context, &handler);
+        srcsax_free_context(context);
+        srcsax_free_writer(writer);
+
+    });
+
+    close(fd);
+
+}
+
+/**
+ * BM_srcsax_reset_context
+ *
+ * C API parse of each unit as its own document, creating a context per document
+ * (range(1) == 0) or resetting one context (range(1) == 1).
+ */
+static void BM_srcsax_reset_context(benchmark::State & state) {
+
+    const corpus & input = get_corpus(state.range(0));
+
+    // split the archive into its units
+    std::vector<std::string> documents;
+    for(size_t pos = input.srcml.find("<unit language"); pos != std::string::npos; ) {
+
+        size_t end = input.srcml.find("</unit>\n", pos) + 7;
+        documents.push_back(input.srcml.substr(pos, end - pos));
+        pos = input.srcml.find("<unit language", end);
+
+    }
+
+    srcsax_handler handler = count_handler();
+    size_t events = 0;
+    size_t bytes = 0;
+    for(std::vector<std::string>::const_iterator citr = documents.begin(); citr != documents.end(); ++citr)
+        bytes += citr->size();
+
+    bool reuse = state.range(1) != 0;
+    srcsax_context * context = 0;
+
+    size_t start_allocations = allocations;
+    size_t start_events = events;
+    for(auto _ : state) {
+
+        for(std::vector<std::string>::const_iterator citr = documents.begin(); citr != documents.end(); ++citr) {
+
+            if(context == 0) {
+
+                context = srcsax_create_context_memory(citr->c_str(), citr->size(), 0);
+                context->data = &events;
+
+            } else {
+
+                srcsax_reset_context_memory(context, citr->c_str(), citr->size(), 0);
+
+            }
+
+            srcsax_parse_handler(context, &handler);
+
+            if(!reuse) {
+
+                srcsax_free_context(context);
+                context = 0;
+
+            }
+
+        }
+
+    }
+    size_t total_allocations = allocations - start_allocations;
+    double total_events = (double)(events - start_events);
+
+    srcsax_free_context(context);
+
+    state.SetBytesProcessed((int64_t)(bytes * state.iterations()));
+    state.counters["events/s"] = benchmark::Counter(total_events, benchmark::Counter::kIsRate);
+    state.counters["allocs/event"] = benchmark::Counter(total_events ? total_allocations / total_events : 0);
+
+}
+
+/**
+ * characters_budget
+ *
+ * Allocations made between the characters events of a unit.
+ */
+struct characters_budget {
+
+    /** number of characters events after the first of their unit */
+    size_t events;
+
+    /** allocations since the previous characters event of the unit */
+    size_t allocations;
+
+    /** allocation count at the previous characters event, if in a unit */
+    size_t last;
+
+    /** if a characters event of the current unit was seen */
+    bool in_unit;
+
+};
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+static void budget_start_unit(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                              int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                              const struct srcsax_attribute * attributes) { ((characters_budget *)context->data)->in_unit = false; }
+
+#pragma GCC diagnostic pop
+
+/**
+ * budget_characters
+ * @param context a srcSAX context
+ * @param ch the characters
+ * @param len number of characters
+ *
+ * Count the allocations made since the previous characters event of the unit.
+ */
+static void budget_characters(struct srcsax_context * context, const char * ch, int len) {
+
+    characters_budget * budget = (characters_budget *)context->data;
+    benchmark::DoNotOptimize(ch[len - 1]);
+
+    if(budget->in_unit) {
+
+        ++budget->events;
+        budget->allocations += allocations - budget->last;
+
+    }
+
+    budget->in_unit = true;
+    budget->last = allocations;
+
+}
+
+/**
+ * BM_srcsax_characters
+ *
+ * C API parse of a text heavy unit, split by entity references and elements, with
+ * coalescing disabled (range(0) == 0) or enabled (range(0) == 1).  After the first
+ * document the characters path has a budget of zero allocations per characters event,
+ * otherwise the benchmark fails.
+ */
+static void BM_srcsax_characters(benchmark::State & state) {
+
+    std::string srcml = "<unit xmlns=\"http://www.srcML.org/srcML/src\">";
+    for(int line = 0; line < 1000; ++line)
+        srcml += "<expr><name>a</name> &lt;&lt; \"text &amp; more text\" &gt;&gt; <name>b</name></expr>;\n";
+    srcml += "</unit>";
+
+    srcsax_handler handler = srcsax_handler();
+    handler.start_unit = budget_start_unit;
+    handler.characters_unit = budget_characters;
+
+    characters_budget budget = characters_budget();
+    srcsax_context * context = srcsax_create_context_memory(srcml.c_str(), srcml.size(), 0);
+    context->data = &budget;
+    srcsax_enable_coalescing(context, (int)state.range(0));
+
+    // first document grows the buffers
+    srcsax_parse_handler(context, &handler);
+    budget = characters_budget();
+
+    for(auto _ : state) {
+
+        srcsax_reset_context_memory(context, srcml.c_str(), srcml.size(), 0);
+        srcsax_parse_handler(context, &handler);
+
+    }
+
+    srcsax_free_context(context);
+
+    state.SetBytesProcessed((int64_t)(srcml.size() * state.iterations()));
+    state.counters["characters/s"] = benchmark::Counter((double)budget.events, benchmark::Counter::kIsRate);
+    state.counters["allocs/characters"] = benchmark::Counter(budget.events ? (double)budget.allocations / budget.events : 0);
+
+    if(budget.allocations != 0)
+        state.SkipWithError("characters events allocate");
+
+}
+
+/**
+ * BM_srcSAXController_parse
+ *
+ * C++ API parse with the default (empty) srcSAXHandler.
+ */
+static void BM_srcSAXController_parse(benchmark::State & state) {
+
+    run(state, [](const std::string & srcml) {
+
+        srcSAXController control(srcml);
+        srcSAXHandler handler;
+        control.parse(&handler);
+
+    });
+
+}
+
+/**
+ * BM_element_count
+ *
+ * C++ API parse with the element_count example handler.
+ */
+static void BM_element_count(benchmark::State & state) {
+
+    run(state, [](const std::string & srcml) {
+
+        srcSAXController control(srcml);
+        element_count_handler handler;
+        control.parse(&handler);
+
+        benchmark::DoNotOptimize(handler.get_counts().size());
+
+    });
+
+}
+
+/**
+ * BM_identity_copy
+ *
+ * C++ API parse with the identity_copy example handler writing to /dev/null.
+ */
+static void BM_identity_copy(benchmark::State & state) {
+
+    run(state, [](const std::string & srcml) {
+
+        srcSAXController control(srcml);
+        identity_copy_handler handler("/dev/null");
+        control.parse(&handler);
+
+    });
+
+}
+
+/**
+ * BM_print_callbacks
+ *
+ * C++ API parse with the print_callbacks example handler, stderr redirected to /dev/null.
+ */
+static void BM_print_callbacks(benchmark::State & state) {
+
+    fflush(stderr);
+    int save_stderr = dup(STDERR_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDERR_FILENO);
+    close(null_fd);
+
+    run(state, [](const std::string & srcml) {
+
+        srcSAXController control(srcml);
+        print_callbacks_handler handler;
+        control.parse(&handler);
+
+    });
+
+    fflush(stderr);
+    dup2(save_stderr, STDERR_FILENO);
+    close(save_stderr);
+
+}
+
+BENCHMARK(BM_srcsax_parse)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_srcsax_write)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_srcsax_reset_context)->Args({100, 0})->Args({100, 1})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_srcsax_characters)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_srcSAXController_parse)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_element_count)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_identity_copy)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_print_callbacks)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+
+/**
+ * main
+ * @param argc number of arguments
+ * @param argv the provided arguments (array of C strings)
+ *
+ * Count libxml2 allocations and run the benchmarks.
+ */
+int main(int argc, char * argv[]) {
+
+  xmlMemSetup(free, count_malloc, count_realloc, count_strdup);
+
+  benchmark::Initialize(&argc, argv);
+  if(benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  return 0;
+}
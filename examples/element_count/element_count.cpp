@@ -53,7 +53,8 @@ int main(int argc, char * argv[]) {
   element_count_handler handler;
   control.parse(&handler);
 
-  for(std::map<std::string, unsigned long long>::const_iterator citr = handler.get_counts().begin(); citr != handler.get_counts().end(); ++citr) {
+  const std::map<std::string, unsigned long long> & counts = handler.get_counts();
+  for(std::map<std::string, unsigned long long>::const_iterator citr = counts.begin(); citr != counts.end(); ++citr) {
 
   	std::cout << citr->first << ": " << citr->second << '\n';
 
@@ -23,6 +23,8 @@
 
 #include <srcSAXHandler.hpp>
 #include <map>
+#include <vector>
+#include <string>
 
 /**
  * element_count_handler
@@ -33,6 +35,12 @@ class element_count_handler : public srcSAXHandler {
 
 private :
 
+    /** count of each srcML element indexed by element ID */
+    std::vector<unsigned long long> id_counts;
+
+    /** full name (prefix + localname) of each counted element indexed by element ID */
+    std::vector<std::string> id_names;
+
     /** map to count srcML elements */
     std::map<std::string, unsigned long long> element_counts;
 
@@ -59,14 +67,24 @@ public :
      * @param prefix the element's prefix
      * @param localname the element name
      *
-     * Helper function to update the count of an element or add it if necessary.
-     * Need the full name (prefix + localname) of elemement to disambiguate between
-     * elements with the same name, but different prefix/namespaces (e.g. cpp:if, if).
-     * A more general find approach is used instead of relying on access using the
-     * operator[] to default non-existant items to 0. 
+     * Helper function to update the count of the current element.
+     * Counting is by the element's interned ID, so no string comparisons are
+     * needed per element.  The ID of an element disambiguates between elements
+     * with the same name, but different prefix/namespaces (e.g. cpp:if, if).
+     * The full name (prefix + localname) is only built the first time an element is seen.
      */
     void update_count(const char * prefix, const char * localname) {
 
+        std::vector<unsigned long long>::size_type id = get_element_id();
+        if(id >= id_counts.size()) {
+
+            id_counts.resize(id + 1, 0);
+            id_names.resize(id + 1);
+
+        }
+
+        if(id_counts[id]++ != 0) return;
+
         std::string element = "";
         if(prefix) {
 
@@ -76,25 +94,30 @@ public :
         }
         element += (const char *)localname;
 
-        /* Note: in map could just use operator[], however, this a bit more general */
-        std::map<std::string, unsigned long long>::iterator itr = element_counts.find(element);
-        if(itr == element_counts.end()) {
-
-            element_counts.insert(std::pair<std::string, unsigned long long>(element, 1));
-
-        } else {
-
-            ++itr->second;
-
-        }
+        id_names[id] = element;
 
     }
 
     /*
     virtual void startDocument() {}
-    virtual void endDocument() {}
     */
 
+    /**
+     * endDocument
+     *
+     * SAX handler function for end of document.
+     * Builds the element count map from the per ID counts.
+     * Overide for desired behaviour.
+     */
+    virtual void endDocument() {
+
+        element_counts.clear();
+        for(std::vector<unsigned long long>::size_type id = 0; id < id_counts.size(); ++id)
+            if(id_counts[id])
+                element_counts[id_names[id]] += id_counts[id];
+
+    }
+
     /**
      * startRoot
      * @param localname the name of the element tag
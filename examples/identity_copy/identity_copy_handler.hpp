@@ -22,11 +22,10 @@
 #define INCLUDED_IDENTITY_COPY_HANDLER_HPP
 
 #include <srcSAXHandler.hpp>
+#include <srcSAXWriter.hpp>
 #include <iostream>
 #include <string>
 
-#include <libxml/xmlwriter.h>
-
 /**
  * identity_copy_handler
  *
@@ -36,19 +35,22 @@ class identity_copy_handler : public srcSAXHandler {
 
 private :
 
-    xmlTextWriterPtr writer;
-    std::string content;
+    srcSAXWriter * writer;
 
 public :
 
     /**
      * identity_copy_handler
      *
-     * Constructor.  Open xmlwriter. 
+     * Constructor.  Open the srcML writer.
      */
     identity_copy_handler(std::string output_filename) : writer(0) {
 
-        if((writer = xmlNewTextWriterFilename(output_filename.c_str(), 0)) == 0) {
+        try {
+
+            writer = new srcSAXWriter(output_filename.c_str());
+
+        } catch(std::string) {
 
             std::cerr << "Problems opening output file: " << output_filename << '\n';
             exit(1);
@@ -64,8 +66,7 @@ public :
      */
     ~identity_copy_handler() {
 
-        if(writer)
-            xmlFreeTextWriter(writer);
+        delete writer;
 
     }
 
@@ -82,7 +83,7 @@ public :
      */
     virtual void startDocument() {
 
-        xmlTextWriterStartDocument(writer, "1.0", "UTF-8", "yes");
+        writer->start_document();
 
     }
 
@@ -96,93 +97,7 @@ public :
      */
     virtual void endDocument() {
 
-        xmlTextWriterEndDocument(writer);
-
-    }
-
-    /**
-     * write_start_tag
-     * @param localname the name of the element tag
-     * @param prefix the tag prefix
-     * @param URI the namespace of tag
-     * @param num_namespaces number of namespaces definitions
-     * @param namespaces the defined namespaces
-     * @param nb_attributes the number of attributes on the tag
-     * @param attributes list of attributes
-     *
-     * SAX handler function for start of the root element.
-     * Write out a start tag.
-     *
-     * Overide for desired behaviour.
-     */
-    void write_start_tag(const char* localname, const char* prefix, const char* URI,
-                           int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
-                           const struct srcsax_attribute * attributes) {
-
-        xmlTextWriterStartElementNS(writer, (const xmlChar *)prefix, (const xmlChar *)localname, 0);
-
-        for(int pos = 0; pos < num_namespaces; ++pos) {
-
-            std::string name = "xmlns";
-            if(namespaces[pos].prefix) {
-                name += ":";
-
-                name += (const char *)namespaces[pos].prefix;
-
-            }
-
-            xmlTextWriterWriteAttribute(writer, (const xmlChar *)name.c_str(), (const xmlChar *)namespaces[pos].uri);
-
-        }
-
-        for(int pos = 0; pos < num_attributes; ++pos) {
-
-            xmlTextWriterWriteAttributeNS(writer, (const xmlChar *)attributes[pos].prefix, (const xmlChar *)attributes[pos].localname,
-                (const xmlChar *)attributes[pos].uri, (const xmlChar *)attributes[pos].value);
-
-        }
-
-    }
-
-    /**
-     * write_content
-     * @param text_content
-     *
-     * Write out the provided text content, escaping everything but ".
-     */
-    void write_content(std::string & text_content) {
-
-        if(text_content != "") {
-
-            /*
-                Normal output of text is for the most part
-                identical to what libxml2 provides.  However,
-                srcML does not escape " while libxml2 does escape
-                quotations.
-            */
-            int ret = 0;
-            char * text = (char *)text_content.c_str();
-            for(char * pos = text; *pos; ++pos) {
-
-              if(*pos != '"') continue;
-
-              *pos = 0;
-              ret = xmlTextWriterWriteString(writer, (const xmlChar *)text);
-              //if(ret == -1) return false;
-
-              *pos = '\"';
-              xmlTextWriterWriteRaw(writer, (const xmlChar *)"\"");
-              //if(ret == -1) return false;
-
-              text = pos + 1;
-
-            }
-
-            ret = xmlTextWriterWriteString(writer, (const xmlChar *)text);
-
-            text_content = "";
-
-        }
+        writer->end_document();
 
     }
 
@@ -206,7 +121,7 @@ public :
                            const struct srcsax_attribute * attributes) {
 
         if(is_archive)
-            write_start_tag(localname, prefix, URI, num_namespaces, namespaces, nb_attributes, attributes);
+            writer->start_element(localname, prefix, num_namespaces, namespaces, nb_attributes, attributes);
 
     }
 
@@ -221,7 +136,7 @@ public :
      * @param attributes list of attributes
      *
      * SAX handler function for start of an unit.
-     * Write out any saved text, then write out the unit tag.
+     * Write out the unit tag.
      *
      * Overide for desired behaviour.
      */
@@ -229,10 +144,7 @@ public :
                            int num_namespaces, const struct srcsax_namespace * namespaces, int nb_attributes,
                            const struct srcsax_attribute * attributes) {
 
-        // write out buffered root level characters
-        write_content(content);
-
-        write_start_tag(localname, prefix, URI, num_namespaces, namespaces, nb_attributes, attributes);
+        writer->start_element(localname, prefix, num_namespaces, namespaces, nb_attributes, attributes);
 
     }
 
@@ -247,7 +159,7 @@ public :
      * @param attributes list of attributes
      *
      * SAX handler function for start of an element.
-     * Write out any saved text, then write out the elementtag.
+     * Write out the element tag.
      * 
      * Overide for desired behaviour.
      */
@@ -255,10 +167,7 @@ public :
                                 int num_namespaces, const struct srcsax_namespace * namespaces, int nb_attributes,
                                 const struct srcsax_attribute * attributes) {
 
-        // write out buffered characters
-        write_content(content);
-
-        write_start_tag(localname, prefix, URI, num_namespaces, namespaces, nb_attributes, attributes);
+        writer->start_element(localname, prefix, num_namespaces, namespaces, nb_attributes, attributes);
 
     }
 
@@ -269,20 +178,14 @@ public :
      * @param URI the namespace of tag
      *
      * SAX handler function for end of the root element.
-     * Write out any saved content, then end the root tag.
+     * End the root tag.
      *
      * Overide for desired behaviour.
      */
     virtual void endRoot(const char* localname, const char* prefix, const char* URI) {
 
-        // write out buffered root level characters
-        if(is_archive) {
-
-            write_content(content);
-
-            xmlTextWriterEndElement(writer);
-
-        }
+        if(is_archive)
+            writer->end_element(localname, prefix);
 
     }
 
@@ -293,16 +196,13 @@ public :
      * @param URI the namespace of tag
      *
      * SAX handler function for end of an unit.
-     * Write out any saved up content, then write out ending unit tag.
+     * Write out ending unit tag.
      *
      * Overide for desired behaviour.
      */
     virtual void endUnit(const char* localname, const char* prefix, const char* URI) {
 
-        // write out any buffered characters
-        write_content(content);
-
-        xmlTextWriterEndElement(writer);
+        writer->end_element(localname, prefix);
 
     }
 
@@ -313,16 +213,13 @@ public :
      * @param URI the namespace of tag
      *
      * SAX handler function for end of an element.
-     * Write out any saved content, then write out ending element tag.
+     * Write out ending element tag.
      *
      * Overide for desired behaviour.
      */
     virtual void endElement(const char* localname, const char* prefix, const char* URI) {
 
-        // write out any buffered characters
-        write_content(content);
-
-        xmlTextWriterEndElement(writer);
+        writer->end_element(localname, prefix);
 
     }
 
@@ -332,21 +229,16 @@ public :
      * @param len number of characters
      *
      * SAX handler function for character handling at the root level.
-     * Collect/write root level charactes.
-     * 
-     * Characters may be called multiple times in succession
-     * in some cases the text may need to be gathered all at once
-     * before output. Both methods are shown here although the delayed
-     * output is used.
+     * Write root level charactes.
+     *
+     * Characters may be called multiple times in succession,
+     * the writer outputs each piece as it arrives.
      *
      * Overide for desired behaviour.
      */
     virtual void charactersRoot(const char* ch, int len) {
 
-
-        //std::string content = "";
-        content.append((const char *)ch, len);
-        //write_content(content);
+        writer->characters(ch, len);
 
     }
 
@@ -356,27 +248,16 @@ public :
      * @param len number of characters
      *
      * SAX handler function for character handling within a unit.
-     * Collect/write unit level charactes.
+     * Write unit level charactes, escaping everything but ".
      * 
-     * Characters may be called multiple times in succession
-     * in some cases the text may need to be gathered all at once
-     * before output. Both methods are shown here although the delayed
-     * output is used.
+     * Characters may be called multiple times in succession,
+     * the writer outputs each piece as it arrives.
      * 
      * Overide for desired behaviour.
      */
     virtual void charactersUnit(const char* ch, int len) {
 
-        /*
-            Characters may be called multiple times in succession
-            in some cases the text may need to be gathered all at once
-            before output. Both methods are shown here although the delayed
-            output is used.
-        */
-
-        //std::string content = "";
-        content.append((const char *)ch, len);
-        //write_content(content);
+        writer->characters(ch, len);
 
     }
 
@@ -399,11 +280,8 @@ public :
                            int num_namespaces, const struct srcsax_namespace * namespaces, int nb_attributes,
                            const struct srcsax_attribute * attributes) {
 
-        // write out any buffered characters
-        write_content(content);
-
-        write_start_tag(localname, prefix, URI, num_namespaces, namespaces, nb_attributes, attributes);
-        xmlTextWriterEndElement(writer);
+        writer->start_element(localname, prefix, num_namespaces, namespaces, nb_attributes, attributes);
+        writer->end_element(localname, prefix);
 
     }
 
@@ -67,6 +67,8 @@ public:
         handler.comment = comment;
         handler.cdata_block = cdata_block;
         handler.processing_instruction = processing_instruction;
+        handler.start_function = start_function;
+        handler.end_function = end_function;
 
         return handler;
 
@@ -77,10 +79,12 @@ public:
      * @param prefix the element to push prefix
      * @param localname the elements name
      *
-     * Push the element to the stack.
+     * Push the element to the stack, if the handler uses the legacy stack.
      */
     void srcml_element_stack_push(const char * prefix, const char * localname) {
 
+        if(!handler->is_legacy_stack()) return;
+
         std::string srcml_element_string = "";
         if(prefix) {
 
@@ -120,6 +124,7 @@ public:
 
         cppCallbackAdapter * cpp_adapter = (cppCallbackAdapter *)context->data;
 
+        cpp_adapter->handler->set_context(context);
         cpp_adapter->handler->set_encoding(context->encoding);
 
         cpp_adapter->handler->startDocument();
@@ -136,6 +141,7 @@ public:
 
         cppCallbackAdapter * cpp_adapter = (cppCallbackAdapter *)context->data;
 
+        cpp_adapter->handler->set_context(context);
         cpp_adapter->handler->get_stack().clear();
 
         cpp_adapter->handler->endDocument();
@@ -162,6 +168,7 @@ public:
 
         cppCallbackAdapter * cpp_adapter = (cppCallbackAdapter *)context->data;
 
+        cpp_adapter->handler->set_context(context);
         cpp_adapter->handler->set_is_archive(context->is_archive);
 
         cpp_adapter->handler->startRoot(localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
@@ -191,30 +198,35 @@ public:
 
         cppCallbackAdapter * cpp_adapter = (cppCallbackAdapter *)context->data;
 
+        cpp_adapter->handler->set_context(context);
         cpp_adapter->handler->startUnit(localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
 
         cpp_adapter->srcml_element_stack_push((const char *)prefix, (const char *)localname);
 
 
     }
-#if 0
+
     /**
      * start_function
      * @param context a srcSAX context
      * @param name the function's name
      * @param return_type the function return type
+     * @param num_parameters the number of parameters
      * @param parameter_list a list of the function parameters in struct containing (declaration.type/declaration.name)
-     * @param is_decl indicates if the call is a function declaration (true) or definition (false)
+     * @param is_decl indicates if the call is a function declaration (1) or definition (0)
      *
      * Callback. Forwards C API start_function to C++ API srcSAXHandler startFunction.
-     */ 
-     static void start_function(struct srcsax_context * context, const char * name, const char * return_type, const struct declaration * parameter_list, _Bool is_decl) {
+     */
+    static void start_function(struct srcsax_context * context, const char * name, const char * return_type,
+                               int num_parameters, const struct srcsax_declaration * parameter_list, int is_decl) {
 
         cppCallbackAdapter * cpp_adapter = (cppCallbackAdapter *)context->data;
 
+        cpp_adapter->handler->startFunction(name, return_type, num_parameters, parameter_list, is_decl != 0);
 
-     }
-#endif
+        cpp_adapter->srcml_element_stack_push(0, context->srcml_element_stack[context->stack_size - 1]);
+
+    }
 
     /**
      * start_element
@@ -255,6 +267,7 @@ public:
 
         cppCallbackAdapter * cpp_adapter = (cppCallbackAdapter *)context->data;
 
+        cpp_adapter->handler->set_context(context);
         cpp_adapter->srcml_element_stack_pop();
 
         cpp_adapter->handler->endRoot(localname, prefix, URI);
@@ -279,7 +292,7 @@ public:
         cpp_adapter->handler->endUnit(localname, prefix, URI);
 
     }
-#if 0
+
     /**
      * end_function
      * @param context a srcSAX context
@@ -290,9 +303,12 @@ public:
 
         cppCallbackAdapter * cpp_adapter = (cppCallbackAdapter *)context->data;
 
+        cpp_adapter->srcml_element_stack_pop();
+
+        cpp_adapter->handler->endFunction();
 
     }
-#endif
+
     /**
      * end_element
      * @param context a srcSAX context
@@ -324,6 +340,7 @@ public:
 
         cppCallbackAdapter * cpp_adapter = (cppCallbackAdapter *)context->data;
 
+        cpp_adapter->handler->set_context(context);
         cpp_adapter->handler->charactersRoot(ch, len);
 
 
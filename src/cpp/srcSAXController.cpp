@@ -35,7 +35,7 @@
  *
  * Constructor
  */
-srcSAXController::srcSAXController(const char * filename, const char * encoding) {
+srcSAXController::srcSAXController(const char * filename, const char * encoding) : push_adapter(0) {
 
     context = srcsax_create_context_filename(filename, encoding);
 
@@ -44,13 +44,29 @@ srcSAXController::srcSAXController(const char * filename, const char * encoding)
 
 }
 
+/**
+ * srcSAXController
+ * @param filename name of a file
+ * @param encoding the xml encoding
+ * @param memory_map map the file into memory instead of reading it
+ *
+ * Constructor
+ */
+srcSAXController::srcSAXController(const char * filename, const char * encoding, bool memory_map) : push_adapter(0) {
+
+    context = memory_map ? srcsax_create_context_mmap(filename, encoding) : srcsax_create_context_filename(filename, encoding);
+
+    if(context == NULL) throw std::string("File does not exist");
+
+}
+
 /**
  * srcSAXController
  * @param srcml_buffer a string buffer
  *
  * Constructor
  */
-srcSAXController::srcSAXController(const std::string & srcml_buffer, const char * encoding) : srcml_buffer(srcml_buffer) {
+srcSAXController::srcSAXController(const std::string & srcml_buffer, const char * encoding) : srcml_buffer(srcml_buffer), push_adapter(0) {
 
     context = srcsax_create_context_memory(this->srcml_buffer.c_str(), this->srcml_buffer.size(), encoding);
 
@@ -64,7 +80,7 @@ srcSAXController::srcSAXController(const std::string & srcml_buffer, const char
  *
  * Constructor
  */
-srcSAXController::srcSAXController(FILE * srcml_file, const char * encoding) {
+srcSAXController::srcSAXController(FILE * srcml_file, const char * encoding) : push_adapter(0) {
 
     context = srcsax_create_context_FILE(srcml_file, encoding);
 
@@ -78,7 +94,7 @@ srcSAXController::srcSAXController(FILE * srcml_file, const char * encoding) {
  *
  * Constructor
  */
-srcSAXController::srcSAXController(int srcml_fd, const char * encoding) {
+srcSAXController::srcSAXController(int srcml_fd, const char * encoding) : push_adapter(0) {
 
     context = srcsax_create_context_fd(srcml_fd, encoding);
 
@@ -94,7 +110,7 @@ srcSAXController::srcSAXController(int srcml_fd, const char * encoding) {
  *
  * Constructor
  */
-srcSAXController::srcSAXController(void * srcml_context, int (*read_callback)(void * context, char * buffer, int len), int (*close_callback)(void * context), const char * encoding) {
+srcSAXController::srcSAXController(void * srcml_context, int (*read_callback)(void * context, char * buffer, int len), int (*close_callback)(void * context), const char * encoding) : push_adapter(0) {
 
     context = srcsax_create_context_io(srcml_context, read_callback, close_callback, encoding);
 
@@ -109,7 +125,7 @@ srcSAXController::srcSAXController(void * srcml_context, int (*read_callback)(vo
  *
  * Constructor
  */
-srcSAXController::srcSAXController(xmlParserInputBufferPtr input) {
+srcSAXController::srcSAXController(xmlParserInputBufferPtr input) : push_adapter(0) {
 
     context = srcsax_create_context_parser_input_buffer(input);
 
@@ -117,6 +133,97 @@ srcSAXController::srcSAXController(xmlParserInputBufferPtr input) {
 
 }
 
+/**
+ * srcSAXController
+ * @param filename name of a srcML archive file
+ * @param index the unit index of the archive
+ * @param first the position of the first unit to parse
+ * @param last the position after the last unit to parse
+ * @param encoding the xml encoding
+ *
+ * Constructor
+ */
+srcSAXController::srcSAXController(const char * filename, const srcsax_unit_index * index, size_t first, size_t last, const char * encoding) : push_adapter(0) {
+
+    context = srcsax_create_context_unit(filename, index, first, last, encoding);
+
+    if(context == NULL) throw std::string("Unit does not exist");
+
+}
+
+/**
+ * srcSAXController
+ *
+ * Constructor for incremental parsing of a document fed with parse_chunk.
+ */
+srcSAXController::srcSAXController() : push_adapter(0) {
+
+    context = srcsax_create_push_context(0);
+
+    if(context == NULL) throw std::string("Unable to create push parser");
+
+}
+
+/**
+ * srcSAXController
+ * @param context a srcSAX context to take ownership of
+ *
+ * Constructor for the contexts of a srcSAXControllerPool.
+ */
+srcSAXController::srcSAXController(srcsax_context * context) : context(context), push_adapter(0) {}
+
+/**
+ * reset
+ * @param filename name of a file
+ * @param encoding the xml encoding
+ *
+ * Reuse the controller, and its parser, for another document.
+ */
+void srcSAXController::reset(const char * filename, const char * encoding) {
+
+    if(srcsax_reset_context_filename(context, filename, encoding) != 0) throw std::string("Unable to reset for file");
+
+}
+
+/**
+ * reset
+ * @param srcml_buffer a string buffer
+ * @param encoding the xml encoding
+ *
+ * Reuse the controller, and its parser, for another document.
+ */
+void srcSAXController::reset(const std::string & srcml_buffer, const char * encoding) {
+
+    this->srcml_buffer = srcml_buffer;
+
+    if(srcsax_reset_context_memory(context, this->srcml_buffer.c_str(), this->srcml_buffer.size(), encoding) != 0)
+        throw std::string("Unable to reset for buffer");
+
+}
+
+/**
+ * reset
+ * @param input a parser input buffer
+ *
+ * Reuse the controller, and its parser, for another document.
+ */
+void srcSAXController::reset(xmlParserInputBufferPtr input) {
+
+    if(srcsax_reset_context(context, input) != 0) throw std::string("Unable to reset for input");
+
+}
+
+/**
+ * reset
+ *
+ * Reuse an incremental parsing controller for another document.
+ */
+void srcSAXController::reset() {
+
+    if(srcsax_reset_context(context, 0) != 0) throw std::string("Unable to reset push parser");
+
+}
+
 /**
  * ~srcSAXController
  *
@@ -126,6 +233,8 @@ srcSAXController::~srcSAXController() {
 
     if(context) srcsax_free_context(context);
 
+    delete push_adapter;
+
 }
 
 /**
@@ -346,11 +455,103 @@ void srcSAXController::enable_processingInstruction(bool enable) {
 * enable_function
 * @param enable bool indicate enable or disable special function parsing.
 *
-* Enables or disables special function parsing.
+* Enables or disables special function parsing: startFunction/endFunction with the
+* name, return type and parameters of each function instead of the element events of
+* the function and its header.  Takes effect at the start of the next document.
 */
 void srcSAXController::enable_function(bool enable) {
 
-    //sax2_handler.parse_function = enable;
+    srcsax_enable_function(context, enable);
+
+}
+
+/**
+* enable_coalescing
+* @param enable bool indicate enable or disable coalescing of characters.
+*
+* Enables or disables delivering each text run in a unit with a single charactersUnit
+* call instead of one call per piece parsed by libxml2, e.g., around entity references.
+* Takes effect at the start of the next document.
+*/
+void srcSAXController::enable_coalescing(bool enable) {
+
+    srcsax_enable_coalescing(context, enable);
+
+}
+
+/**
+ * subscribe
+ * @param qname qualified name of an element, e.g., function or cpp:include
+ *
+ * Only call startElement/endElement for subscribed elements,
+ * and charactersUnit inside of them.  Other elements are not converted
+ * nor dispatched.
+ */
+void srcSAXController::subscribe(const char * qname) {
+
+    if(srcsax_subscribe_element(context, qname) != 0) throw std::string("Unable to subscribe to element");
+
+}
+
+/**
+ * subscribe
+ * @param element_id the srcml_element_id of a known srcML element
+ *
+ * Subscribe to an element by ID.
+ */
+void srcSAXController::subscribe(int element_id) {
+
+    if(srcsax_subscribe_element_id(context, element_id) != 0) throw std::string("Unable to subscribe to element");
+
+}
+
+/**
+ * clear_subscriptions
+ *
+ * Receive all elements again.
+ */
+void srcSAXController::clear_subscriptions() {
+
+    srcsax_clear_subscriptions(context);
+
+}
+
+/**
+ * enable_stats
+ * @param timing time the callbacks and the parser
+ *
+ * Start collecting statistics of the parse, resetting any collected.
+ */
+void srcSAXController::enable_stats(bool timing) {
+
+    if(srcsax_enable_stats(context, timing) != 0) throw std::string("Unable to enable statistics");
+
+}
+
+/**
+ * disable_stats
+ *
+ * Stop collecting statistics.
+ */
+void srcSAXController::disable_stats() {
+
+    srcsax_disable_stats(context);
+
+}
+
+/**
+ * get_stats
+ *
+ * Get the statistics collected since enabled.
+ *
+ * @returns the statistics.
+ */
+srcsax_stats srcSAXController::get_stats() const {
+
+    srcsax_stats stats;
+    if(srcsax_get_stats(context, &stats) != 0) throw std::string("Statistics not enabled");
+
+    return stats;
 
 }
 
@@ -365,9 +566,23 @@ void srcSAXController::parse(srcSAXHandler * handler) {
     handler->set_controller(this);
 
     cppCallbackAdapter adapter(handler);
-    context->data = &adapter;
     srcsax_handler sax_handler = cppCallbackAdapter::factory();
-    context->handler = &sax_handler;
+
+    parse_handler(&sax_handler, &adapter);
+
+}
+
+/**
+ * parse_handler
+ * @param sax_handler the srcSAX callbacks
+ * @param data the data of the callbacks
+ *
+ * Parse the xml document with the srcSAX callbacks.
+ */
+void srcSAXController::parse_handler(srcsax_handler * sax_handler, void * data) {
+
+    context->data = data;
+    context->handler = sax_handler;
 
     int status = srcsax_parse(context);
 
@@ -386,3 +601,89 @@ void srcSAXController::parse(srcSAXHandler * handler) {
 
 }
 
+
+/**
+ * parse_chunk
+ * @param handler srcMLHandler with hooks for sax parsing
+ * @param chunk the next chunk of the document
+ * @param size the size of the chunk
+ * @param is_last the chunk is the end of the document
+ *
+ * Parse the next chunk of the xml document with the supplied hooks.
+ */
+void srcSAXController::parse_chunk(srcSAXHandler * handler, const char * chunk, size_t size, bool is_last) {
+
+    handler->set_controller(this);
+
+    // the adapter is used by the callbacks of later chunks
+    if(push_adapter == 0)
+        push_adapter = new cppCallbackAdapter(handler);
+    else
+        *push_adapter = cppCallbackAdapter(handler);
+
+    context->data = push_adapter;
+    push_handler = cppCallbackAdapter::factory();
+    context->handler = &push_handler;
+
+    int status = srcsax_parse_chunk(context, chunk, size, is_last);
+
+    if(status != 0) {
+
+        xmlErrorPtr ep = xmlCtxtGetLastError(context->libxml2_context);
+
+        SAXError error = { std::string(ep && ep->message ? (const char *)ep->message : "Unable to parse chunk"), ep ? ep->code : 0 };
+
+        throw error;
+    }
+
+}
+
+/**
+ * parse_parallel
+ * @param handlers srcMLHandlers with hooks for sax parsing, one per thread
+ * @param ordered deliver startUnit/endUnit in document order
+ *
+ * Parse the units of a srcML archive in parallel, one thread per handler.
+ */
+void srcSAXController::parse_parallel(const std::vector<srcSAXHandler *> & handlers, bool ordered) {
+
+    if(handlers.empty()) {
+
+        SAXError error = { std::string("No handlers for parallel parse"), 0 };
+        throw error;
+
+    }
+
+    std::vector<cppCallbackAdapter> adapters;
+    adapters.reserve(handlers.size());
+    std::vector<void *> thread_data;
+    for(std::vector<srcSAXHandler *>::const_iterator citr = handlers.begin(); citr != handlers.end(); ++citr) {
+
+        (*citr)->set_controller(this);
+        adapters.push_back(cppCallbackAdapter(*citr));
+        thread_data.push_back(&adapters.back());
+
+    }
+
+    context->data = &adapters.front();
+    srcsax_handler sax_handler = cppCallbackAdapter::factory();
+    context->handler = &sax_handler;
+
+    int status = srcsax_parse_parallel(context, (int)handlers.size(), &thread_data.front(), ordered);
+
+    context->data = 0;
+
+    // the unit contexts no longer exist
+    for(std::vector<srcSAXHandler *>::const_iterator citr = handlers.begin(); citr != handlers.end(); ++citr)
+        (*citr)->set_context(0);
+
+    if(status != 0) {
+
+        xmlErrorPtr ep = xmlCtxtGetLastError(context->libxml2_context);
+
+        SAXError error = { std::string(ep && ep->message ? (const char *)ep->message : "Unable to parse in parallel"), ep ? ep->code : 0 };
+
+        throw error;
+    }
+
+}
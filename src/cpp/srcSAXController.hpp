@@ -22,12 +22,15 @@
 #define INCLUDED_SRCSAX_CONTROLLER_HPP
 
 class srcSAXHandler;
+class cppCallbackAdapter;
+template<class Handler> class staticCallbackAdapter;
 #include <srcsax.h>
 
 #include <libxml/parser.h>
 #include <libxml/parserInternals.h>
 
 #include <string>
+#include <vector>
 
 /**
  * SAXError
@@ -60,6 +63,31 @@ private :
     // memory buffer storage
     std::string srcml_buffer;
 
+    // adapter for the callbacks of incremental parsing
+    cppCallbackAdapter * push_adapter;
+
+    // srcSAX handler for the callbacks of incremental parsing
+    srcsax_handler push_handler;
+
+    /**
+     * parse_handler
+     * @param sax_handler the srcSAX callbacks
+     * @param data the data of the callbacks
+     *
+     * Parse the xml document with the srcSAX callbacks.
+     */
+    void parse_handler(srcsax_handler * sax_handler, void * data);
+
+    /**
+     * srcSAXController
+     * @param context a srcSAX context to take ownership of
+     *
+     * Constructor for the contexts of a srcSAXControllerPool.
+     */
+    srcSAXController(srcsax_context * context);
+
+    friend class srcSAXControllerPool;
+
 public :
 
     /**
@@ -71,6 +99,16 @@ public :
      */
     srcSAXController(const char * filename, const char * encoding = 0);
 
+    /**
+     * srcSAXController
+     * @param filename name of a file
+     * @param encoding the xml encoding
+     * @param memory_map map the file into memory instead of reading it
+     *
+     * Constructor
+     */
+    srcSAXController(const char * filename, const char * encoding, bool memory_map);
+
     /**
      * srcSAXController
      * @param srcml_buffer a string buffer
@@ -114,6 +152,58 @@ public :
      */
     srcSAXController(xmlParserInputBufferPtr input);
 
+    /**
+     * srcSAXController
+     * @param filename name of a srcML archive file
+     * @param index the unit index of the archive
+     * @param first the position of the first unit to parse
+     * @param last the position after the last unit to parse
+     * @param encoding the xml encoding
+     *
+     * Constructor for parsing the units [first, last) of an indexed archive.
+     */
+    srcSAXController(const char * filename, const srcsax_unit_index * index, size_t first, size_t last, const char * encoding = 0);
+
+    /**
+     * srcSAXController
+     *
+     * Constructor for incremental parsing of a document fed with parse_chunk.
+     */
+    srcSAXController();
+
+    /**
+     * reset
+     * @param filename name of a file
+     * @param encoding the xml encoding
+     *
+     * Reuse the controller, and its parser, for another document.
+     */
+    void reset(const char * filename, const char * encoding = 0);
+
+    /**
+     * reset
+     * @param srcml_buffer a string buffer
+     * @param encoding the xml encoding
+     *
+     * Reuse the controller, and its parser, for another document.
+     */
+    void reset(const std::string & srcml_buffer, const char * encoding = 0);
+
+    /**
+     * reset
+     * @param input a parser input buffer
+     *
+     * Reuse the controller, and its parser, for another document.
+     */
+    void reset(xmlParserInputBufferPtr input);
+
+    /**
+     * reset
+     *
+     * Reuse an incremental parsing controller for another document.
+     */
+    void reset();
+
     /**
      * getCtxt
      *
@@ -246,10 +336,70 @@ public :
      * enable_function
      * @param enable bool indicate enable or disable special function parsing.
      *
-     * Enables or disables special function parsing.
+     * Enables or disables special function parsing: startFunction/endFunction with the
+     * name, return type and parameters of each function instead of the element events of
+     * the function and its header.  Takes effect at the start of the next document.
      */
     void enable_function(bool enable);
 
+    /**
+     * enable_coalescing
+     * @param enable bool indicate enable or disable coalescing of characters.
+     *
+     * Deliver each text run in a unit with a single charactersUnit call.
+     * Takes effect at the start of the next document.
+     */
+    void enable_coalescing(bool enable);
+
+    /**
+     * subscribe
+     * @param qname qualified name of an element, e.g., function or cpp:include
+     *
+     * Only call startElement/endElement for subscribed elements,
+     * and charactersUnit inside of them.
+     */
+    void subscribe(const char * qname);
+
+    /**
+     * subscribe
+     * @param element_id the srcml_element_id of a known srcML element
+     *
+     * Subscribe to an element by ID.
+     */
+    void subscribe(int element_id);
+
+    /**
+     * clear_subscriptions
+     *
+     * Receive all elements again.
+     */
+    void clear_subscriptions();
+
+    /**
+     * enable_stats
+     * @param timing time the callbacks and the parser
+     *
+     * Start collecting statistics of the parse (event counts, bytes consumed,
+     * stack depth, marshalling allocations and optionally times), resetting any collected.
+     */
+    void enable_stats(bool timing = false);
+
+    /**
+     * disable_stats
+     *
+     * Stop collecting statistics.
+     */
+    void disable_stats();
+
+    /**
+     * get_stats
+     *
+     * Get the statistics collected since enabled.
+     *
+     * @returns the statistics.
+     */
+    srcsax_stats get_stats() const;
+
     /**
      * parse
      * @param handler srcMLHandler with hooks for sax parsing
@@ -258,6 +408,43 @@ public :
      */
     void parse(srcSAXHandler * handler);
 
+    /**
+     * parse
+     * @param handler handler with methods named as the srcSAXHandler hooks
+     *
+     * Parse the xml document with hooks dispatched at compile time.
+     * Hooks the handler does not define are never called.  The legacy stack,
+     * archive and unit count of srcSAXHandler are not maintained, use
+     * get_element_stack or the srcsax_context (getContext) instead, and the
+     * enable_ functions do not apply.  Defined in staticCallbackAdapter.hpp.
+     */
+    template<class Handler>
+    void parse(Handler & handler);
+
+    /**
+     * parse_chunk
+     * @param handler srcMLHandler with hooks for sax parsing
+     * @param chunk the next chunk of the document
+     * @param size the size of the chunk
+     * @param is_last the chunk is the end of the document
+     *
+     * Parse the next chunk of the xml document with the supplied hooks.
+     * Requires a controller constructed for incremental parsing.
+     */
+    void parse_chunk(srcSAXHandler * handler, const char * chunk, size_t size, bool is_last = false);
+
+    /**
+     * parse_parallel
+     * @param handlers srcMLHandlers with hooks for sax parsing, one per thread
+     * @param ordered deliver the startUnit calls, and the endUnit calls, each in document order
+     *
+     * Parse the units of a srcML archive in parallel, one thread per handler.
+     * Document, root and meta tag hooks are called on the first handler from the calling thread,
+     * the hooks of each unit on the handler of the thread parsing it.  Ordered, a startUnit may
+     * still come before the endUnit of a preceding unit (see srcsax_parse_parallel).
+     */
+    void parse_parallel(const std::vector<srcSAXHandler *> & handlers, bool ordered = false);
+
     /**
      * stop_parser
      *
@@ -267,4 +454,6 @@ public :
 
 };
 
+#include <staticCallbackAdapter.hpp>
+
 #endif
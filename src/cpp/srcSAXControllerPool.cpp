@@ -0,0 +1,119 @@
+/**
+ * @file srcSAXControllerPool.cpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <srcSAXControllerPool.hpp>
+
+/**
+ * srcSAXControllerPool
+ * @param max_idle the maximum number of idle parsers to keep, 0 for no limit
+ *
+ * Constructor
+ */
+srcSAXControllerPool::srcSAXControllerPool(size_t max_idle) {
+
+    pool = srcsax_create_context_pool(max_idle);
+
+    if(pool == NULL) throw std::string("Unable to create pool");
+
+}
+
+/**
+ * ~srcSAXControllerPool
+ *
+ * Destructor.  Acquired controllers must be released first.
+ */
+srcSAXControllerPool::~srcSAXControllerPool() {
+
+    srcsax_free_context_pool(pool);
+
+}
+
+/**
+ * acquire
+ * @param srcml_buffer a string buffer
+ * @param encoding the xml encoding
+ *
+ * Acquire a controller for the document in the buffer.  The controller is
+ * used by one thread at a time, and is returned with release.
+ */
+srcSAXController * srcSAXControllerPool::acquire(const std::string & srcml_buffer, const char * encoding) {
+
+    srcSAXController * controller = new srcSAXController((srcsax_context *)0);
+    controller->srcml_buffer = srcml_buffer;
+
+    controller->context = srcsax_context_pool_acquire_memory(pool, controller->srcml_buffer.c_str(), controller->srcml_buffer.size(), encoding);
+
+    if(controller->context == NULL) {
+
+        delete controller;
+        throw std::string("Unable to acquire for buffer");
+
+    }
+
+    return controller;
+
+}
+
+/**
+ * acquire
+ * @param filename name of a file
+ * @param encoding the xml encoding
+ *
+ * Acquire a controller for the document in the file.  The controller is
+ * used by one thread at a time, and is returned with release.
+ */
+srcSAXController * srcSAXControllerPool::acquire(const char * filename, const char * encoding) {
+
+    srcsax_context * context = srcsax_context_pool_acquire_filename(pool, filename, encoding);
+
+    if(context == NULL) throw std::string("Unable to acquire for file");
+
+    return new srcSAXController(context);
+
+}
+
+/**
+ * release
+ * @param controller a controller acquired from the pool
+ *
+ * Release the controller, and return its parser to the pool.
+ */
+void srcSAXControllerPool::release(srcSAXController * controller) {
+
+    if(controller == 0) return;
+
+    srcsax_context * context = controller->context;
+    controller->context = 0;
+    delete controller;
+
+    srcsax_context_pool_release(pool, context);
+
+}
+
+/**
+ * idle
+ *
+ * The number of idle parsers in the pool.
+ */
+size_t srcSAXControllerPool::idle() const {
+
+    return srcsax_context_pool_idle(pool);
+
+}
@@ -0,0 +1,99 @@
+/**
+ * @file srcSAXControllerPool.hpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INCLUDED_SRCSAX_CONTROLLER_POOL_HPP
+#define INCLUDED_SRCSAX_CONTROLLER_POOL_HPP
+
+#include <srcSAXController.hpp>
+
+#include <string>
+
+/**
+ * srcSAXControllerPool
+ *
+ * Thread-safe pool handing out controllers whose parsers
+ * are reused from earlier documents.
+ */
+class srcSAXControllerPool {
+
+private :
+
+    // the C context pool
+    srcsax_context_pool * pool;
+
+    /** Not copyable */
+    srcSAXControllerPool(const srcSAXControllerPool &);
+
+    /** Not assignable */
+    srcSAXControllerPool & operator=(const srcSAXControllerPool &);
+
+public :
+
+    /**
+     * srcSAXControllerPool
+     * @param max_idle the maximum number of idle parsers to keep, 0 for no limit
+     *
+     * Constructor
+     */
+    srcSAXControllerPool(size_t max_idle = 0);
+
+    /**
+     * ~srcSAXControllerPool
+     *
+     * Destructor
+     */
+    ~srcSAXControllerPool();
+
+    /**
+     * acquire
+     * @param srcml_buffer a string buffer
+     * @param encoding the xml encoding
+     *
+     * Acquire a controller for the document in the buffer.
+     */
+    srcSAXController * acquire(const std::string & srcml_buffer, const char * encoding = 0);
+
+    /**
+     * acquire
+     * @param filename name of a file
+     * @param encoding the xml encoding
+     *
+     * Acquire a controller for the document in the file.
+     */
+    srcSAXController * acquire(const char * filename, const char * encoding = 0);
+
+    /**
+     * release
+     * @param controller a controller acquired from the pool
+     *
+     * Release the controller, and return its parser to the pool.
+     */
+    void release(srcSAXController * controller);
+
+    /**
+     * idle
+     *
+     * The number of idle parsers in the pool.
+     */
+    size_t idle() const;
+
+};
+
+#endif
@@ -22,11 +22,120 @@
 #define INCLUDED_SRCSAX_HANDLER_HPP
 
 #include <srcSAXController.hpp>
+#include <srcSAXWriter.hpp>
 
 #include <libxml/parser.h>
 
 #include <vector>
 
+/**
+ * srcSAXElementStack
+ *
+ * View of the open srcML element stack kept by the srcSAX context.
+ * Names are qualified (prefix:localname), bottom first, and are not copied.
+ * A view is only valid until the next push/pop, i.e., within a callback.
+ */
+class srcSAXElementStack {
+
+private :
+
+    /** open element names */
+    const char * const * names;
+
+    /** number of open elements */
+    size_t count;
+
+public :
+
+    /**
+     * srcSAXElementStack
+     * @param names the open element names
+     * @param count the number of open elements
+     *
+     * Constructor
+     */
+    srcSAXElementStack(const char * const * names = 0, size_t count = 0) : names(names), count(count) {}
+
+    /**
+     * size
+     *
+     * @returns the number of open elements.
+     */
+    size_t size() const {
+
+        return count;
+
+    }
+
+    /**
+     * empty
+     *
+     * @returns if there are no open elements.
+     */
+    bool empty() const {
+
+        return count == 0;
+
+    }
+
+    /**
+     * operator[]
+     * @param pos position from the bottom of the stack
+     *
+     * @returns the qualified name of the element at pos.
+     */
+    const char * operator[](size_t pos) const {
+
+        return names[pos];
+
+    }
+
+    /**
+     * front
+     *
+     * @returns the qualified name of the outermost open element.
+     */
+    const char * front() const {
+
+        return names[0];
+
+    }
+
+    /**
+     * back
+     *
+     * @returns the qualified name of the innermost open element.
+     */
+    const char * back() const {
+
+        return names[count - 1];
+
+    }
+
+    /**
+     * begin
+     *
+     * @returns iterator to the outermost open element.
+     */
+    const char * const * begin() const {
+
+        return names;
+
+    }
+
+    /**
+     * end
+     *
+     * @returns iterator past the innermost open element.
+     */
+    const char * const * end() const {
+
+        return names + count;
+
+    }
+
+};
+
 /**
  * srcSAXHandler
  *
@@ -39,6 +148,20 @@ private :
     /** Controller for parser */
     srcSAXController * controller;
 
+    /** srcSAX context of the callbacks (a unit's own context when parsing in parallel) */
+    srcsax_context * context;
+
+    /**
+     * current_context
+     *
+     * @returns the srcSAX context of the callbacks.
+     */
+    srcsax_context * current_context() {
+
+        return context ? context : controller->getContext();
+
+    }
+
 protected:
 
     /** is the document an archive */
@@ -47,9 +170,12 @@ protected:
     /** the current unit count */
     int unit_count;
 
-    /** open srcML element stack */
+    /** open srcML element stack, only maintained in legacy stack mode */
     std::vector<std::string> srcml_element_stack;
 
+    /** maintain the std::string copy of the element stack */
+    bool legacy_stack;
+
     /** the xml documents encoding */
     const char * encoding;
 
@@ -60,7 +186,7 @@ public :
      *
      * Default constructor default values to everything
      */
-    srcSAXHandler() : controller(0), is_archive(false), unit_count(0), encoding(0) {}
+    srcSAXHandler() : controller(0), context(0), is_archive(false), unit_count(0), legacy_stack(false), encoding(0) {}
 
     /**
      * set_controller
@@ -75,6 +201,19 @@ public :
 
     }
 
+    /**
+     * set_context
+     * @param context the srcSAX context of the callbacks
+     *
+     * Used by cppCallbackAdapter to provide the context the
+     * callbacks are made with.
+     */
+    void set_context(srcsax_context * context) {
+
+        this->context = context;
+
+    }
+
     /**
      * increment_unit_count
      *
@@ -89,7 +228,8 @@ public :
     /**
      * get_stack
      *
-     * Used internally to update the stack.
+     * Used internally to update the stack.  The stack is only
+     * maintained when enabled with enable_legacy_stack.
      */
     std::vector<std::string> & get_stack() {
 
@@ -97,6 +237,48 @@ public :
 
     }
 
+    /**
+     * enable_legacy_stack
+     * @param enable bool indicate enable or disable the legacy stack.
+     *
+     * Enables or disables maintaining the std::string element stack of get_stack.
+     */
+    void enable_legacy_stack(bool enable) {
+
+        legacy_stack = enable;
+
+    }
+
+    /**
+     * is_legacy_stack
+     *
+     * @returns if the std::string element stack of get_stack is maintained.
+     */
+    bool is_legacy_stack() const {
+
+        return legacy_stack;
+
+    }
+
+    /**
+     * get_element_stack
+     *
+     * Get a view of the open srcML element stack without copying the names.
+     * Unlike get_stack, the element of the current start callback is already
+     * on, and of the current end callback still on, the stack.
+     *
+     * @returns the open srcML element stack.
+     */
+    srcSAXElementStack get_element_stack() {
+
+        if(context == 0 && controller == 0) return srcSAXElementStack();
+
+        srcsax_context * current = current_context();
+
+        return srcSAXElementStack(current->srcml_element_stack, current->stack_size);
+
+    }
+
     /**
      * get_controller
      *
@@ -115,9 +297,123 @@ public :
      */
     void stop_parser() {
 
-        srcsax_stop_parser(controller->getContext());
+        srcsax_stop_parser(current_context());
+
+    }
+
+    /**
+     * skip_element
+     *
+     * Skip the contents of the element of the current startUnit or
+     * startElement callback.  The element's endUnit/endElement is
+     * still called.
+     *
+     * @returns if the element is skipped.
+     */
+    bool skip_element() {
+
+        return srcsax_skip_subtree(current_context()) == 0;
+
+    }
+
+    /**
+     * copy_element
+     * @param writer the writer of the transform
+     *
+     * Copy the element of the current startUnit or startElement callback
+     * unchanged to writer, from the original bytes of a memory or memory mapped
+     * input.  As with skip_element, the element's endUnit/endElement is
+     * still called, and its writer end_element writes nothing.
+     *
+     * @returns if the element is copied.
+     */
+    bool copy_element(srcSAXWriter & writer) {
+
+        return srcsax_copy_subtree(current_context(), writer.get_writer()) == 0;
 
-    } 
+    }
+
+    /**
+     * get_offset
+     *
+     * @returns the byte offset in the input of the current callback's
+     * start or end tag (see srcsax_current_offset), -1 if not known.
+     */
+    long get_offset() {
+
+        return srcsax_current_offset(current_context());
+
+    }
+
+    /**
+     * get_position
+     * @param line the line of the current callback's start or end tag
+     * @param column its byte column, 0 if not known
+     *
+     * @returns if the position is known, i.e., in a start or end callback.
+     */
+    bool get_position(int & line, int & column) {
+
+        return srcsax_current_position(current_context(), &line, &column) == 0;
+
+    }
+
+    /**
+     * get_element_id
+     *
+     * Get the interned ID (srcml_element_id) of the element of the
+     * current start/end element, unit, root or meta tag callback.
+     *
+     * @returns the current element's ID.
+     */
+    int get_element_id() {
+
+        return current_context()->element_id;
+
+    }
+
+    /**
+     * get_element_name
+     * @param element_id an element ID
+     *
+     * Get the localname of an element ID.
+     *
+     * @returns the element's localname or 0 if the ID is not known.
+     */
+    const char * get_element_name(int element_id) {
+
+        return srcsax_element_name(current_context(), element_id);
+
+    }
+
+    /**
+     * get_root_namespaces
+     * @param num_namespaces set to the number of root namespaces
+     *
+     * Get the namespaces of the root element from any callback after startRoot.
+     *
+     * @returns the root namespaces or 0 if there is no root element.
+     */
+    const struct srcsax_namespace * get_root_namespaces(int & num_namespaces) {
+
+        return srcsax_get_root_namespaces(current_context(), &num_namespaces);
+
+    }
+
+    /**
+     * get_root_attributes
+     * @param num_attributes set to the number of root attributes
+     *
+     * Get the attributes of the root element from any callback after startRoot,
+     * e.g., the archive's attributes while processing one of its units.
+     *
+     * @returns the root attributes or 0 if there is no root element.
+     */
+    const struct srcsax_attribute * get_root_attributes(int & num_attributes) {
+
+        return srcsax_get_root_attributes(current_context(), &num_attributes);
+
+    }
 
     /**
      * set_encoding
@@ -196,21 +492,24 @@ public :
     virtual void startUnit(const char * localname, const char * prefix, const char * URI,
                            int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
                            const struct srcsax_attribute * attributes) {}
-#if 0
+
     /**
      * startFunction
      * @param name the function's name
      * @param return_type the function return type
+     * @param num_parameters the number of parameters
      * @param parameter_list a list of the function parameters in struct containing (declaration.type/declaration.name)
      * @param is_decl indicates if the call is a function declaration (true) or definition (false)
      *
      * SAX handler function for start of function with prototype.
-     * Accessing references after callback termination is undefined.
+     * Only called after srcSAXController::enable_function(true).
+     * Accessing the strings after callback termination is undefined.
      *
      * Overide for desired behaviour.
      */
-    virtual void startFunction(const std::string & name, const std::string & return_type, const std::vector<declaration> & parameter_list, bool is_decl) {}
-#endif
+    virtual void startFunction(const char * name, const char * return_type, int num_parameters,
+                               const struct srcsax_declaration * parameter_list, bool is_decl) {}
+
     /**
      * startElement
      * @param localname the name of the element tag
@@ -249,15 +548,16 @@ public :
      * Overide for desired behaviour.
      */
     virtual void endUnit(const char * localname, const char * prefix, const char * URI) {}
-#if 0
+
     /**
      * endFunction
      *
      * SAX handler function for end of a function.
+     * Only called after srcSAXController::enable_function(true).
      * Overide for desired behaviour.
      */
     virtual void endFunction() {}
-#endif
+
     /**
      * endElement
      * @param localname the name of the element tag
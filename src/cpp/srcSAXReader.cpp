@@ -0,0 +1,112 @@
+/**
+ * @file srcSAXReader.cpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <srcSAXReader.hpp>
+
+#include <string>
+
+/**
+ * srcSAXReader
+ * @param controller the controller of the document
+ *
+ * Constructor.  The controller must outlive the reader.
+ */
+srcSAXReader::srcSAXReader(srcSAXController & controller) : current(0) {
+
+    reader = srcsax_create_reader(controller.getContext());
+
+    if(reader == NULL) throw std::string("Unable to create reader");
+
+}
+
+/**
+ * ~srcSAXReader
+ *
+ * Destructor
+ */
+srcSAXReader::~srcSAXReader() {
+
+    srcsax_free_reader(reader);
+
+}
+
+/**
+ * next
+ *
+ * Advance to the next event, parsing more of the document when needed.
+ *
+ * @returns true for an event or false at the end of the document.
+ */
+bool srcSAXReader::next() {
+
+    int status = srcsax_reader_next(reader, &current);
+
+    if(status < 0) {
+
+        xmlErrorPtr ep = xmlCtxtGetLastError(srcsax_reader_context(reader)->libxml2_context);
+
+        SAXError error = { std::string(ep && ep->message ? (const char *)ep->message : "Unable to read document"), ep ? ep->code : 0 };
+
+        throw error;
+
+    }
+
+    return status != 0;
+
+}
+
+/**
+ * event
+ *
+ * The current event, valid until the next call to next().
+ *
+ * @returns the current event.
+ */
+const srcsax_event & srcSAXReader::event() const {
+
+    return *current;
+
+}
+
+/**
+ * get_element_name
+ * @param element_id an element ID
+ *
+ * Get the localname of an element ID.
+ *
+ * @returns the element's localname or 0 if the ID is not known.
+ */
+const char * srcSAXReader::get_element_name(int element_id) {
+
+    return srcsax_element_name(srcsax_reader_context(reader), element_id);
+
+}
+
+/**
+ * stop_parser
+ *
+ * Stop reading the document, next() returns false
+ * after the already parsed events.
+ */
+void srcSAXReader::stop_parser() {
+
+    srcsax_stop_parser(srcsax_reader_context(reader));
+
+}
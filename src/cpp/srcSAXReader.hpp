@@ -0,0 +1,97 @@
+/**
+ * @file srcSAXReader.hpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INCLUDED_SRCSAX_READER_HPP
+#define INCLUDED_SRCSAX_READER_HPP
+
+#include <srcSAXController.hpp>
+#include <srcsax_reader.h>
+
+/**
+ * srcSAXReader
+ *
+ * Pull reader returning the srcSAX events of a
+ * controller's document one at a time.
+ */
+class srcSAXReader {
+
+private :
+
+    // the C reader
+    srcsax_reader * reader;
+
+    // the current event
+    const srcsax_event * current;
+
+    /** Not copyable */
+    srcSAXReader(const srcSAXReader &);
+
+    /** Not assignable */
+    srcSAXReader & operator=(const srcSAXReader &);
+
+public :
+
+    /**
+     * srcSAXReader
+     * @param controller the controller of the document
+     *
+     * Constructor
+     */
+    srcSAXReader(srcSAXController & controller);
+
+    /**
+     * ~srcSAXReader
+     *
+     * Destructor
+     */
+    ~srcSAXReader();
+
+    /**
+     * next
+     *
+     * Advance to the next event.
+     */
+    bool next();
+
+    /**
+     * event
+     *
+     * The current event, valid until the next call to next().
+     */
+    const srcsax_event & event() const;
+
+    /**
+     * get_element_name
+     * @param element_id an element ID
+     *
+     * Get the localname of an element ID.
+     */
+    const char * get_element_name(int element_id);
+
+    /**
+     * stop_parser
+     *
+     * Stop reading the document.
+     */
+    void stop_parser();
+
+};
+
+#endif
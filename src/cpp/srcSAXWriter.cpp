@@ -0,0 +1,218 @@
+/**
+ * @file srcSAXWriter.cpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <srcSAXWriter.hpp>
+
+/**
+ * srcSAXWriter
+ *
+ * Constructor, writing to memory, see str().
+ */
+srcSAXWriter::srcSAXWriter() {
+
+    writer = srcsax_create_writer_memory();
+
+    if(writer == NULL) throw std::string("Unable to create writer");
+
+}
+
+/**
+ * srcSAXWriter
+ * @param filename name of the output file
+ *
+ * Constructor, writing to a file, created or truncated.
+ */
+srcSAXWriter::srcSAXWriter(const char * filename) {
+
+    writer = srcsax_create_writer_filename(filename);
+
+    if(writer == NULL) throw std::string("Unable to open output file");
+
+}
+
+/**
+ * srcSAXWriter
+ * @param fd an open file descriptor
+ *
+ * Constructor, writing to a file descriptor.  The file
+ * descriptor is not closed.
+ */
+srcSAXWriter::srcSAXWriter(int fd) {
+
+    writer = srcsax_create_writer_fd(fd);
+
+    if(writer == NULL) throw std::string("Unable to create writer");
+
+}
+
+/**
+ * ~srcSAXWriter
+ *
+ * Destructor, writes out the buffered output.
+ */
+srcSAXWriter::~srcSAXWriter() {
+
+    srcsax_free_writer(writer);
+
+}
+
+/**
+ * check
+ * @param status status of a C writer function
+ *
+ * Throw on a failed write.
+ */
+void srcSAXWriter::check(int status) {
+
+    if(status != 0) throw std::string("Unable to write output");
+
+}
+
+/**
+ * start_document
+ *
+ * Write the XML declaration.
+ */
+void srcSAXWriter::start_document() {
+
+    check(srcsax_write_start_document(writer));
+
+}
+
+/**
+ * end_document
+ *
+ * End the document and write out the buffered output.
+ */
+void srcSAXWriter::end_document() {
+
+    check(srcsax_write_end_document(writer));
+
+}
+
+/**
+ * start_element
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param num_namespaces number of namespaces definitions
+ * @param namespaces the defined namespaces
+ * @param num_attributes the number of attributes on the tag
+ * @param attributes list of attributes
+ *
+ * Write a start tag, e.g., from startRoot, startUnit, startElement or metaTag.
+ */
+void srcSAXWriter::start_element(const char * localname, const char * prefix,
+                                 int num_namespaces, const struct srcsax_namespace * namespaces,
+                                 int num_attributes, const struct srcsax_attribute * attributes) {
+
+    check(srcsax_write_start_element(writer, localname, prefix, num_namespaces, namespaces, num_attributes, attributes));
+
+}
+
+/**
+ * end_element
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ *
+ * Write an end tag, or end an element without content as an empty element.
+ */
+void srcSAXWriter::end_element(const char * localname, const char * prefix) {
+
+    check(srcsax_write_end_element(writer, localname, prefix));
+
+}
+
+/**
+ * characters
+ * @param ch the characters
+ * @param len number of characters
+ *
+ * Write text, escaping <, > and &.
+ */
+void srcSAXWriter::characters(const char * ch, int len) {
+
+    check(srcsax_write_characters(writer, ch, len));
+
+}
+
+/**
+ * comment
+ * @param value the comment content
+ *
+ * Write a comment.
+ */
+void srcSAXWriter::comment(const char * value) {
+
+    check(srcsax_write_comment(writer, value));
+
+}
+
+/**
+ * cdata_block
+ * @param value the pcdata content
+ * @param len the block length
+ *
+ * Write a CDATA section.
+ */
+void srcSAXWriter::cdata_block(const char * value, int len) {
+
+    check(srcsax_write_cdata_block(writer, value, len));
+
+}
+
+/**
+ * processing_instruction
+ * @param target the processing instruction target.
+ * @param data the processing instruction data.
+ *
+ * Write a processing instruction.
+ */
+void srcSAXWriter::processing_instruction(const char * target, const char * data) {
+
+    check(srcsax_write_processing_instruction(writer, target, data));
+
+}
+
+/**
+ * flush
+ *
+ * Write out the buffered output of a file writer.
+ */
+void srcSAXWriter::flush() {
+
+    check(srcsax_writer_flush(writer));
+
+}
+
+/**
+ * str
+ *
+ * The output of a memory writer.
+ *
+ * @returns the output, empty if not a memory writer.
+ */
+std::string srcSAXWriter::str() {
+
+    size_t size = 0;
+    const char * output = srcsax_writer_memory(writer, &size);
+
+    return output ? std::string(output, size) : std::string();
+
+}
@@ -0,0 +1,187 @@
+/**
+ * @file srcSAXWriter.hpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INCLUDED_SRCSAX_WRITER_HPP
+#define INCLUDED_SRCSAX_WRITER_HPP
+
+#include <srcsax_writer.h>
+
+#include <string>
+
+/**
+ * srcSAXWriter
+ *
+ * Streaming srcML writer, e.g., for writing out
+ * the (modified) events of a srcSAXHandler.
+ */
+class srcSAXWriter {
+
+private :
+
+    // the C writer
+    srcsax_writer * writer;
+
+    /** Not copyable */
+    srcSAXWriter(const srcSAXWriter &);
+
+    /** Not assignable */
+    srcSAXWriter & operator=(const srcSAXWriter &);
+
+    /**
+     * check
+     * @param status status of a C writer function
+     *
+     * Throw on a failed write.
+     */
+    void check(int status);
+
+public :
+
+    /**
+     * srcSAXWriter
+     *
+     * Constructor, writing to memory.
+     */
+    srcSAXWriter();
+
+    /**
+     * srcSAXWriter
+     * @param filename name of the output file
+     *
+     * Constructor, writing to a file.
+     */
+    srcSAXWriter(const char * filename);
+
+    /**
+     * srcSAXWriter
+     * @param fd an open file descriptor
+     *
+     * Constructor, writing to a file descriptor.
+     */
+    srcSAXWriter(int fd);
+
+    /**
+     * ~srcSAXWriter
+     *
+     * Destructor
+     */
+    ~srcSAXWriter();
+
+    /**
+     * start_document
+     *
+     * Write the XML declaration.
+     */
+    void start_document();
+
+    /**
+     * end_document
+     *
+     * End the document and write out the buffered output.
+     */
+    void end_document();
+
+    /**
+     * start_element
+     * @param localname the name of the element tag
+     * @param prefix the tag prefix
+     * @param num_namespaces number of namespaces definitions
+     * @param namespaces the defined namespaces
+     * @param num_attributes the number of attributes on the tag
+     * @param attributes list of attributes
+     *
+     * Write a start tag.
+     */
+    void start_element(const char * localname, const char * prefix,
+                       int num_namespaces, const struct srcsax_namespace * namespaces,
+                       int num_attributes, const struct srcsax_attribute * attributes);
+
+    /**
+     * end_element
+     * @param localname the name of the element tag
+     * @param prefix the tag prefix
+     *
+     * Write an end tag.
+     */
+    void end_element(const char * localname, const char * prefix);
+
+    /**
+     * characters
+     * @param ch the characters
+     * @param len number of characters
+     *
+     * Write escaped text.
+     */
+    void characters(const char * ch, int len);
+
+    /**
+     * comment
+     * @param value the comment content
+     *
+     * Write a comment.
+     */
+    void comment(const char * value);
+
+    /**
+     * cdata_block
+     * @param value the pcdata content
+     * @param len the block length
+     *
+     * Write a CDATA section.
+     */
+    void cdata_block(const char * value, int len);
+
+    /**
+     * processing_instruction
+     * @param target the processing instruction target.
+     * @param data the processing instruction data.
+     *
+     * Write a processing instruction.
+     */
+    void processing_instruction(const char * target, const char * data);
+
+    /**
+     * flush
+     *
+     * Write out the buffered output.
+     */
+    void flush();
+
+    /**
+     * str
+     *
+     * The output of a memory writer.
+     */
+    std::string str();
+
+    /**
+     * get_writer
+     *
+     * @returns the C writer.
+     */
+    srcsax_writer * get_writer() {
+
+        return writer;
+
+    }
+
+};
+
+#endif
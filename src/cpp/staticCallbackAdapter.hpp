@@ -0,0 +1,522 @@
+/**
+ * @file staticCallbackAdapter.hpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INCLUDED_STATIC_CALLBACK_ADAPTER_HPP
+#define INCLUDED_STATIC_CALLBACK_ADAPTER_HPP
+
+#include <srcSAXController.hpp>
+#include <srcSAXHandler.hpp>
+
+#include <srcsax.h>
+
+#include <type_traits>
+
+/**
+ * srcsax_method_owner
+ *
+ * Deduces the class declaring the overload of a method with the signature
+ * of a srcSAXHandler method, e.g., decltype(owner(&Handler::startUnit)).
+ */
+template<class Method>
+struct srcsax_method_owner;
+
+template<class... Args>
+struct srcsax_method_owner<void (srcSAXHandler::*)(Args...)> {
+
+    template<class Class>
+    static Class * owner(void (Class::*)(Args...));
+
+};
+
+/**
+ * SRCSAX_DEFINES_METHOD
+ * @param METHOD a srcSAXHandler callback method
+ *
+ * Define the trait srcsax_defines_METHOD<Handler>.  Its value is true if Handler has
+ * the method with the signature of srcSAXHandler's, other than the empty one inherited
+ * from srcSAXHandler.  A Handler member of that name without such an overload, e.g.,
+ * one with a slightly different signature, is an error instead of silently not called.
+ */
+#define SRCSAX_DEFINES_METHOD(METHOD)                                                                                        \
+template<class Handler, class Base = srcSAXHandler>                                                                          \
+class srcsax_defines_##METHOD {                                                                                              \
+                                                                                                                             \
+    template<class T>                                                                                                        \
+    static decltype(srcsax_method_owner<decltype(&Base::METHOD)>::owner(&T::METHOD)) owner(int);                             \
+                                                                                                                             \
+    template<class T>                                                                                                        \
+    static void * owner(...);                                                                                                \
+                                                                                                                             \
+    /* a member of the name makes that of the fallback ambiguous, a final class is not probed for overloads */               \
+    template<class T, bool = __is_final(T)>                                                                                  \
+    struct has_member {                                                                                                      \
+                                                                                                                             \
+        struct fallback { int METHOD; };                                                                                     \
+        struct probe : T, fallback {};                                                                                       \
+                                                                                                                             \
+        template<class U>                                                                                                    \
+        static long test(decltype(&U::METHOD));                                                                              \
+                                                                                                                             \
+        template<class U>                                                                                                    \
+        static char test(...);                                                                                               \
+                                                                                                                             \
+        static const bool value = sizeof(test<probe>(0)) == sizeof(char);                                                    \
+                                                                                                                             \
+    };                                                                                                                       \
+                                                                                                                             \
+    template<class T>                                                                                                        \
+    struct has_member<T, true> {                                                                                             \
+                                                                                                                             \
+        template<class U>                                                                                                    \
+        static char test(decltype(&U::METHOD));                                                                              \
+                                                                                                                             \
+        template<class U>                                                                                                    \
+        static long test(...);                                                                                               \
+                                                                                                                             \
+        static const bool value = sizeof(test<T>(0)) == sizeof(char);                                                        \
+                                                                                                                             \
+    };                                                                                                                       \
+                                                                                                                             \
+    typedef decltype(owner<Handler>(0)) owner_type;                                                                          \
+                                                                                                                             \
+    static const bool matches = !std::is_same<owner_type, void *>::value;                                                    \
+                                                                                                                             \
+    static_assert(matches || !has_member<Handler>::value,                                                                    \
+                  "Handler::" #METHOD " does not have the signature of srcSAXHandler::" #METHOD);                            \
+                                                                                                                             \
+public :                                                                                                                     \
+                                                                                                                             \
+    static const bool value = matches && !std::is_same<owner_type, Base *>::value;                                           \
+                                                                                                                             \
+};
+
+SRCSAX_DEFINES_METHOD(startDocument)
+SRCSAX_DEFINES_METHOD(endDocument)
+SRCSAX_DEFINES_METHOD(startRoot)
+SRCSAX_DEFINES_METHOD(startUnit)
+SRCSAX_DEFINES_METHOD(startElement)
+SRCSAX_DEFINES_METHOD(endRoot)
+SRCSAX_DEFINES_METHOD(endUnit)
+SRCSAX_DEFINES_METHOD(endElement)
+SRCSAX_DEFINES_METHOD(charactersRoot)
+SRCSAX_DEFINES_METHOD(charactersUnit)
+SRCSAX_DEFINES_METHOD(metaTag)
+SRCSAX_DEFINES_METHOD(comment)
+SRCSAX_DEFINES_METHOD(cdataBlock)
+SRCSAX_DEFINES_METHOD(processingInstruction)
+SRCSAX_DEFINES_METHOD(startFunction)
+SRCSAX_DEFINES_METHOD(endFunction)
+
+#undef SRCSAX_DEFINES_METHOD
+
+/**
+ * SRCSAX_SELECT_CALLBACK
+ * @param CALLBACK a srcsax_handler callback
+ * @param METHOD the handler method it forwards to
+ *
+ * Define select_CALLBACK<Handler>() returning the callback if Handler
+ * defines the method and 0 otherwise.  Only the selected overload is
+ * instantiated, so the callback of an undefined method is never compiled.
+ */
+#define SRCSAX_SELECT_CALLBACK(CALLBACK, METHOD)                                                                            \
+    template<class H>                                                                                                        \
+    static typename std::enable_if<srcsax_defines_##METHOD<H>::value, decltype(srcsax_handler::CALLBACK)>::type              \
+    select_##CALLBACK() { return CALLBACK; }                                                                                 \
+                                                                                                                             \
+    template<class H>                                                                                                        \
+    static typename std::enable_if<!srcsax_defines_##METHOD<H>::value, decltype(srcsax_handler::CALLBACK)>::type             \
+    select_##CALLBACK() { return 0; }
+
+/**
+ * staticCallbackAdapter
+ *
+ * Compile-time counterpart of cppCallbackAdapter.  The callbacks call the
+ * Handler's methods directly (non-virtually), and callbacks for methods the
+ * Handler does not define are left null so they are never dispatched.
+ * Handler may, but does not have to, derive from srcSAXHandler.
+ */
+template<class Handler>
+class staticCallbackAdapter {
+
+private :
+
+    SRCSAX_SELECT_CALLBACK(start_document, startDocument)
+    SRCSAX_SELECT_CALLBACK(end_document, endDocument)
+    SRCSAX_SELECT_CALLBACK(start_root, startRoot)
+    SRCSAX_SELECT_CALLBACK(start_unit, startUnit)
+    SRCSAX_SELECT_CALLBACK(start_element, startElement)
+    SRCSAX_SELECT_CALLBACK(end_root, endRoot)
+    SRCSAX_SELECT_CALLBACK(end_unit, endUnit)
+    SRCSAX_SELECT_CALLBACK(end_element, endElement)
+    SRCSAX_SELECT_CALLBACK(characters_root, charactersRoot)
+    SRCSAX_SELECT_CALLBACK(characters_unit, charactersUnit)
+    SRCSAX_SELECT_CALLBACK(meta_tag, metaTag)
+    SRCSAX_SELECT_CALLBACK(comment, comment)
+    SRCSAX_SELECT_CALLBACK(cdata_block, cdataBlock)
+    SRCSAX_SELECT_CALLBACK(processing_instruction, processingInstruction)
+    SRCSAX_SELECT_CALLBACK(start_function, startFunction)
+    SRCSAX_SELECT_CALLBACK(end_function, endFunction)
+
+    /**
+     * attach
+     * @param handler the handler
+     * @param controller the controller of the parse
+     *
+     * Provide srcSAXHandler based handlers with the controller for
+     * stop_parser, skip_element and the element ID functions.
+     */
+    template<class H>
+    static auto attach(H & handler, srcSAXController * controller, int) -> decltype(handler.set_controller(controller), void()) {
+
+        handler.set_controller(controller);
+        handler.set_context(0);
+
+    }
+
+    /**
+     * attach
+     *
+     * Handlers not based on srcSAXHandler have nothing to attach.
+     */
+    template<class H>
+    static void attach(H &, srcSAXController *, long) {}
+
+public :
+
+    /**
+     * factory
+     *
+     * Generate the srcsax_handler for a Handler.
+     *
+     * @returns the srcsax_handler with the callbacks of the methods Handler defines.
+     */
+    static srcsax_handler factory() {
+
+        srcsax_handler handler;
+
+        handler.start_document = select_start_document<Handler>();
+        handler.end_document = select_end_document<Handler>();
+        handler.start_root = select_start_root<Handler>();
+        handler.start_unit = select_start_unit<Handler>();
+        handler.start_element = select_start_element<Handler>();
+        handler.end_root = select_end_root<Handler>();
+        handler.end_unit = select_end_unit<Handler>();
+        handler.end_element = select_end_element<Handler>();
+        handler.characters_root = select_characters_root<Handler>();
+        handler.characters_unit = select_characters_unit<Handler>();
+        handler.meta_tag = select_meta_tag<Handler>();
+        handler.comment = select_comment<Handler>();
+        handler.cdata_block = select_cdata_block<Handler>();
+        handler.processing_instruction = select_processing_instruction<Handler>();
+        handler.start_function = select_start_function<Handler>();
+        handler.end_function = select_end_function<Handler>();
+
+        return handler;
+
+    }
+
+    /**
+     * prepare
+     * @param handler the handler
+     * @param controller the controller of the parse
+     *
+     * Prepare the handler for a parse.
+     */
+    static void prepare(Handler & handler, srcSAXController * controller) {
+
+        attach(handler, controller, 0);
+
+    }
+
+    /**
+     * start_document
+     * @param context a srcSAX context
+     *
+     * Callback. Forwards C API start_document to Handler startDocument.
+     */
+    static void start_document(struct srcsax_context * context) {
+
+        ((Handler *)context->data)->Handler::startDocument();
+
+    }
+
+    /**
+     * end_document
+     * @param context a srcSAX context
+     *
+     * Callback. Forwards C API end_document to Handler endDocument.
+     */
+    static void end_document(struct srcsax_context * context) {
+
+        ((Handler *)context->data)->Handler::endDocument();
+
+    }
+
+    /**
+     * start_root
+     * @param context a srcSAX context
+     * @param localname the name of the element tag
+     * @param prefix the tag prefix
+     * @param URI the namespace of tag
+     * @param num_namespaces number of namespaces definitions
+     * @param namespaces the defined namespaces
+     * @param num_attributes the number of attributes on the tag
+     * @param attributes list of attributes
+     *
+     * Callback. Forwards C API start_root to Handler startRoot.
+     */
+    static void start_root(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                           int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                           const struct srcsax_attribute * attributes) {
+
+        ((Handler *)context->data)->Handler::startRoot(localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+    }
+
+    /**
+     * start_unit
+     * @param context a srcSAX context
+     * @param localname the name of the element tag
+     * @param prefix the tag prefix
+     * @param URI the namespace of tag
+     * @param num_namespaces number of namespaces definitions
+     * @param namespaces the defined namespaces
+     * @param num_attributes the number of attributes on the tag
+     * @param attributes list of attributes
+     *
+     * Callback. Forwards C API start_unit to Handler startUnit.
+     */
+    static void start_unit(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                           int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                           const struct srcsax_attribute * attributes) {
+
+        ((Handler *)context->data)->Handler::startUnit(localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+    }
+
+    /**
+     * start_element
+     * @param context a srcSAX context
+     * @param localname the name of the element tag
+     * @param prefix the tag prefix
+     * @param URI the namespace of tag
+     * @param num_namespaces number of namespaces definitions
+     * @param namespaces the defined namespaces
+     * @param num_attributes the number of attributes on the tag
+     * @param attributes list of attributes
+     *
+     * Callback. Forwards C API start_element to Handler startElement.
+     */
+    static void start_element(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                              int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                              const struct srcsax_attribute * attributes) {
+
+        ((Handler *)context->data)->Handler::startElement(localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+    }
+
+    /**
+     * end_root
+     * @param context a srcSAX context
+     * @param localname the name of the element tag
+     * @param prefix the tag prefix
+     * @param URI the namespace of tag
+     *
+     * Callback. Forwards C API end_root to Handler endRoot.
+     */
+    static void end_root(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI) {
+
+        ((Handler *)context->data)->Handler::endRoot(localname, prefix, URI);
+
+    }
+
+    /**
+     * end_unit
+     * @param context a srcSAX context
+     * @param localname the name of the element tag
+     * @param prefix the tag prefix
+     * @param URI the namespace of tag
+     *
+     * Callback. Forwards C API end_unit to Handler endUnit.
+     */
+    static void end_unit(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI) {
+
+        ((Handler *)context->data)->Handler::endUnit(localname, prefix, URI);
+
+    }
+
+    /**
+     * end_element
+     * @param context a srcSAX context
+     * @param localname the name of the element tag
+     * @param prefix the tag prefix
+     * @param URI the namespace of tag
+     *
+     * Callback. Forwards C API end_element to Handler endElement.
+     */
+    static void end_element(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI) {
+
+        ((Handler *)context->data)->Handler::endElement(localname, prefix, URI);
+
+    }
+
+    /**
+     * characters_root
+     * @param context a srcSAX context
+     * @param ch the characers
+     * @param len number of characters
+     *
+     * Callback. Forwards C API characters_root to Handler charactersRoot.
+     */
+    static void characters_root(struct srcsax_context * context, const char * ch, int len) {
+
+        ((Handler *)context->data)->Handler::charactersRoot(ch, len);
+
+    }
+
+    /**
+     * characters_unit
+     * @param context a srcSAX context
+     * @param ch the characers
+     * @param len number of characters
+     *
+     * Callback. Forwards C API characters_unit to Handler charactersUnit.
+     */
+    static void characters_unit(struct srcsax_context * context, const char * ch, int len) {
+
+        ((Handler *)context->data)->Handler::charactersUnit(ch, len);
+
+    }
+
+    /**
+     * meta_tag
+     * @param context a srcSAX context
+     * @param localname the name of the element tag
+     * @param prefix the tag prefix
+     * @param URI the namespace of tag
+     * @param num_namespaces number of namespaces definitions
+     * @param namespaces the defined namespaces
+     * @param num_attributes the number of attributes on the tag
+     * @param attributes list of attributes
+     *
+     * Callback. Forwards C API meta_tag to Handler metaTag.
+     */
+    static void meta_tag(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                         int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                         const struct srcsax_attribute * attributes) {
+
+        ((Handler *)context->data)->Handler::metaTag(localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+    }
+
+    /**
+     * comment
+     * @param context a srcSAX context
+     * @param value the comment content
+     *
+     * Callback. Forwards C API comment to Handler comment.
+     */
+    static void comment(struct srcsax_context * context, const char * value) {
+
+        ((Handler *)context->data)->Handler::comment(value);
+
+    }
+
+    /**
+     * cdata_block
+     * @param context a srcSAX context
+     * @param value the pcdata content
+     * @param len the block length
+     *
+     * Callback. Forwards C API cdata_block to Handler cdataBlock.
+     */
+    static void cdata_block(struct srcsax_context * context, const char * value, int len) {
+
+        ((Handler *)context->data)->Handler::cdataBlock(value, len);
+
+    }
+
+    /**
+     * processing_instruction
+     * @param context a srcSAX context
+     * @param target the processing instruction target.
+     * @param data the processing instruction data.
+     *
+     * Callback. Forwards C API processing_instruction to Handler processingInstruction.
+     */
+    static void processing_instruction(struct srcsax_context * context, const char * target, const char * data) {
+
+        ((Handler *)context->data)->Handler::processingInstruction(target, data);
+
+    }
+
+    /**
+     * start_function
+     * @param context a srcSAX context
+     * @param name the function's name
+     * @param return_type the function return type
+     * @param num_parameters the number of parameters
+     * @param parameter_list a list of the function parameters
+     * @param is_decl indicates if the call is a function declaration (1) or definition (0)
+     *
+     * Callback. Forwards C API start_function to Handler startFunction.
+     */
+    static void start_function(struct srcsax_context * context, const char * name, const char * return_type,
+                               int num_parameters, const struct srcsax_declaration * parameter_list, int is_decl) {
+
+        ((Handler *)context->data)->Handler::startFunction(name, return_type, num_parameters, parameter_list, is_decl != 0);
+
+    }
+
+    /**
+     * end_function
+     * @param context a srcSAX context
+     *
+     * Callback. Forwards C API end_function to Handler endFunction.
+     */
+    static void end_function(struct srcsax_context * context) {
+
+        ((Handler *)context->data)->Handler::endFunction();
+
+    }
+
+};
+
+#undef SRCSAX_SELECT_CALLBACK
+
+/**
+ * parse
+ * @param handler a handler with methods named as the srcSAXHandler hooks
+ *
+ * Parse the xml document, calling the handler's methods without
+ * virtual dispatch.  Only the hooks the handler defines are called.
+ */
+template<class Handler>
+void srcSAXController::parse(Handler & handler) {
+
+    staticCallbackAdapter<Handler>::prepare(handler, this);
+
+    srcsax_handler sax_handler = staticCallbackAdapter<Handler>::factory();
+
+    parse_handler(&sax_handler, &handler);
+
+}
+
+#endif
@@ -62,15 +62,25 @@ xmlSAXHandler srcsax_sax2_factory() {
  * libxml2_namespaces2srcsax_namespaces
  * @param number_namespaces the number of namespaces
  * @param libxml2_namespaces
+ * @param buffer reusable conversion storage
  *
  * Helper function to convert the libxml2 namespaces to srcsax namespaces
- * returning a dynamically allocated struct containing the namespaces.
+ * using the supplied storage.  The storage is only grown when needed.
+ * The result is valid until the next conversion into the same buffer.
  *
  * @returns the converted namespaces as srcsax_namespace.
  */
-static inline srcsax_namespace * libxml2_namespaces2srcsax_namespaces(int number_namespaces, const xmlChar ** libxml2_namespaces) {
+static inline srcsax_namespace * libxml2_namespaces2srcsax_namespaces(int number_namespaces, const xmlChar ** libxml2_namespaces,
+                                                                      srcsax_marshal_buffer & buffer) {
 
-    struct srcsax_namespace * srcsax_namespaces = (srcsax_namespace *)calloc(number_namespaces, sizeof(srcsax_namespace));
+    if(buffer.namespaces.size() < (size_t)number_namespaces) {
+
+        if(buffer.namespaces.capacity() < (size_t)number_namespaces) ++buffer.allocations;
+        buffer.namespaces.resize(number_namespaces);
+
+    }
+
+    struct srcsax_namespace * srcsax_namespaces = buffer.namespaces.data();
 
     for(int pos = 0, index = 0; pos < number_namespaces; ++pos, index += 2) {
 
@@ -82,61 +92,62 @@ static inline srcsax_namespace * libxml2_namespaces2srcsax_namespaces(int number
     return srcsax_namespaces;
 }
 
-/**
- * free_srcsax_namespaces
- * @param number_namespaces the number of namespaces (not currently used)
- * @param libxml2_namespaces
- *
- * Helper function to free srcsax_namespace * struct allocated by libxml2_namespaces2srcsax_namespaces.
- */
-static inline void free_srcsax_namespaces(int /*number_namespaces*/, srcsax_namespace * namespaces) {
-
-    free((void *)namespaces);
-
-}
-
 /**
  * libxml2_attributes2srcsax_attributes
  * @param number_attributes the number of attributes
  * @param libxml2_attributes
+ * @param buffer reusable conversion storage
  *
  * Helper function to convert the libxml2 attributes to srcsax attributes
- * returning a dynamically allocated struct containing the attributes.
+ * using the supplied storage.  libxml2 attribute values are not null terminated,
+ * so they are copied, terminated, into the buffer's value storage.  The storage
+ * is only grown when needed.  The result is valid until the next conversion
+ * into the same buffer.
  *
  * @returns the converted attributes as srcsax_attribute.
  */
-static inline srcsax_attribute * libxml2_attributes2srcsax_attributes(int number_attributes, const xmlChar ** libxml2_attributes) {
+static inline srcsax_attribute * libxml2_attributes2srcsax_attributes(int number_attributes, const xmlChar ** libxml2_attributes,
+                                                                      srcsax_marshal_buffer & buffer) {
+
+    size_t values_length = 0;
+    for(int pos = 0, index = 0; pos < number_attributes; ++pos, index += 5)
+        values_length += (libxml2_attributes[index + 4] - libxml2_attributes[index + 3]) + 1;
+
+    if(buffer.attributes.size() < (size_t)number_attributes) {
+
+        if(buffer.attributes.capacity() < (size_t)number_attributes) ++buffer.allocations;
+        buffer.attributes.resize(number_attributes);
+
+    }
+
+    if(buffer.values.size() < values_length) {
+
+        if(buffer.values.capacity() < values_length) ++buffer.allocations;
+        buffer.values.resize(values_length);
 
-    struct srcsax_attribute * srcsax_attributes = (srcsax_attribute *)calloc(number_attributes, sizeof(srcsax_attribute));
+    }
+
+    struct srcsax_attribute * srcsax_attributes = buffer.attributes.data();
+    char * value = buffer.values.data();
 
     for(int pos = 0, index = 0; pos < number_attributes; ++pos, index += 5) {
 
+        size_t value_length = libxml2_attributes[index + 4] - libxml2_attributes[index + 3];
+        memcpy(value, libxml2_attributes[index + 3], value_length);
+        value[value_length] = '\0';
+
         srcsax_attributes[pos].localname = (const char *)libxml2_attributes[index];
         srcsax_attributes[pos].prefix = (const char *)libxml2_attributes[index + 1];
         srcsax_attributes[pos].uri = (const char *)libxml2_attributes[index + 2];
-        srcsax_attributes[pos].value = strndup((const char *)libxml2_attributes[index + 3], libxml2_attributes[index + 4] - libxml2_attributes[index + 3]);
+        srcsax_attributes[pos].value = value;
+
+        value += value_length + 1;
 
     }
 
     return srcsax_attributes;
 }
 
-/**
- * free_srcsax_attributes
- * @param number_attributes the number of attributes
- * @param libxml2_attributes
- *
- * Helper function to free srcsax_attribute * struct allocated by libxml2_attributes2srcsax_attributes.
- */
-static inline void free_srcsax_attributes(int number_attributes, srcsax_attribute * attributes) {
-
-    for(int pos = 0; pos < number_attributes; ++pos)
-        free((void *)attributes[pos].value);
-
-    free((void *)attributes);
-
-}
-
 /** 
  * srcml_element_stack_push
  * @param context the srcsax_context
@@ -146,28 +157,12 @@ static inline void free_srcsax_attributes(int number_attributes, srcsax_attribut
  *
  * Push the element on to the stack.
  */
- void srcml_element_stack_push(srcsax_context * context, std::vector<const char *> & srcml_element_stack, const char * prefix, const char * localname) {
-
-    size_t prefix_length = prefix ? strlen(prefix) : 0;
-    size_t name_length = strlen(localname);
-    size_t srcml_element_length = prefix ? prefix_length + name_length + 1 : name_length;
-    char * srcml_element_string = (char *)calloc(srcml_element_length + 1, sizeof(char));
-
-    size_t offset = 0;
-    if(prefix) {
-
-        strncat(srcml_element_string, prefix, prefix_length);
-        srcml_element_string[prefix_length] = ':';
-        offset = prefix_length + 1;
-
-    }
+ void srcml_element_stack_push(srcsax_context * context, srcml_element_name_stack & srcml_element_stack, const char * prefix, const char * localname) {
 
-    strncat(srcml_element_string + offset, localname, name_length);
-
-    srcml_element_stack.push_back(srcml_element_string);
+    srcml_element_stack.push(prefix, localname);
 
     context->stack_size = srcml_element_stack.size();
-    context->srcml_element_stack = &srcml_element_stack.front();
+    context->srcml_element_stack = srcml_element_stack.data();
 
  }
 
@@ -178,24 +173,162 @@ static inline void free_srcsax_attributes(int number_attributes, srcsax_attribut
  *
  * Pop an element off the stack.
  */
- void srcml_element_stack_pop(srcsax_context * context, std::vector<const char *> & srcml_element_stack) {
-
-    if(srcml_element_stack.size() == 0) return;
-
-    const char * srcml_element = srcml_element_stack.back();
+ void srcml_element_stack_pop(srcsax_context * context, srcml_element_name_stack & srcml_element_stack) {
 
-    srcml_element_stack.pop_back();
+    if(srcml_element_stack.empty()) return;
 
-    free((void *)srcml_element);
+    srcml_element_stack.pop();
 
     context->stack_size = srcml_element_stack.size();
-    if(context->stack_size == 0)
-        context->srcml_element_stack = 0;
-    else
-        context->srcml_element_stack = &srcml_element_stack.front();
+    context->srcml_element_stack = srcml_element_stack.data();
 
  }
 
+/**
+ * is_subscribed
+ * @param state the parse state
+ * @param element_id the ID of the element
+ * @param prefix the element prefix
+ * @param localname the name of the element
+ *
+ * @returns if the element's start/end callbacks are made, i.e., there are no
+ * subscriptions or it is subscribed.
+ */
+static inline bool is_subscribed(sax2_srcsax_handler * state, int element_id, const xmlChar * prefix, const xmlChar * localname) {
+
+    const srcml_element_filter * filter = (const srcml_element_filter *)state->context->element_filter;
+
+    return filter == 0 || filter->is_subscribed(element_id, (const char *)prefix, (const char *)localname, state->subscribed_ids);
+
+}
+
+/**
+ * characters_flush
+ * @param state the parse state
+ *
+ * Deliver the coalesced characters of the text run, if any.
+ */
+static inline void characters_flush(sax2_srcsax_handler * state) {
+
+    if(state->coalesced_characters.empty()) return;
+
+    if(!state->context->terminate && state->context->handler->characters_unit)
+        state->context->handler->characters_unit(state->context, state->coalesced_characters.c_str(), (int)state->coalesced_characters.size());
+
+    state->coalesced_characters.clear();
+
+}
+
+/**
+ * characters_run_end
+ * @param ctxt the libxml2 parser context
+ * @param ch the characters
+ * @param len number of characters
+ *
+ * @returns if the characters are the last of their text run, i.e., markup follows them.
+ * Characters in the input are followed by the input after them, others (e.g., of an
+ * entity reference) by the parser's position.  At the end of the input read so far,
+ * e.g., between chunks, it is not known.
+ */
+static inline bool characters_run_end(xmlParserCtxtPtr ctxt, const xmlChar * ch, int len) {
+
+    xmlParserInputPtr input = ctxt->input;
+    if(input == 0 || input->cur == 0 || input->end == 0) return false;
+
+    const xmlChar * next = (input->base && ch >= input->base && ch < input->end) ? ch + len : input->cur;
+
+    return next < input->end && *next == '<';
+
+}
+
+/**
+ * trim_whitespace
+ * @param str a string
+ *
+ * Remove the leading and trailing whitespace of the string in place.
+ */
+static inline void trim_whitespace(std::string & str) {
+
+    static const char * whitespace = " \t\n\r";
+
+    size_t last = str.find_last_not_of(whitespace);
+    if(last == std::string::npos) {
+
+        str.clear();
+        return;
+
+    }
+
+    str.erase(last + 1);
+    str.erase(0, str.find_first_not_of(whitespace));
+
+}
+
+/**
+ * function_header_end
+ * @param ctxt the libxml2 parser context
+ * @param state the parse state
+ * @param skippable if start_function may skip the rest of the function
+ *
+ * Deliver start_function for the collected function header.
+ */
+static void function_header_end(xmlParserCtxtPtr ctxt, sax2_srcsax_handler * state, bool skippable) {
+
+    state->in_function_header = false;
+
+    if(state->context->terminate) return;
+
+    function_prototype & function = state->current_function;
+    trim_whitespace(function.name);
+    trim_whitespace(function.return_type);
+
+    state->function_parameters.resize(function.parameter_list.size());
+    for(size_t pos = 0; pos < function.parameter_list.size(); ++pos) {
+
+        trim_whitespace(function.parameter_list[pos].type);
+        trim_whitespace(function.parameter_list[pos].name);
+
+        state->function_parameters[pos].type = function.parameter_list[pos].type.c_str();
+        state->function_parameters[pos].name = function.parameter_list[pos].name.c_str();
+
+    }
+
+    state->context->element_id = function.is_decl ? SRCML_SRC_FUNCTION_DECL : SRCML_SRC_FUNCTION;
+    if(state->context->handler->start_function) {
+
+        state->skippable = skippable;
+        state->in_start_function = true;
+        state->position = FUNCTION_POSITION;
+        state->context->handler->start_function(state->context, function.name.c_str(), function.return_type.c_str(),
+            (int)function.parameter_list.size(), state->function_parameters.empty() ? 0 : &state->function_parameters.front(),
+            function.is_decl);
+        state->position = TAG_POSITION;
+        state->in_start_function = false;
+        state->skippable = false;
+
+    }
+
+    if(state->skip_stack_size) skip_subtree_begin(ctxt, state);
+
+}
+
+/**
+ * function_end
+ * @param state the parse state
+ * @param element_id the ID of the function element
+ *
+ * Deliver end_function.
+ */
+static void function_end(sax2_srcsax_handler * state, int element_id) {
+
+    if(state->context->terminate) return;
+
+    state->context->element_id = element_id;
+    if(state->context->handler->end_function)
+        state->context->handler->end_function(state->context);
+
+}
+
 /**
  * start_document
  * @param ctx an xmlParserCtxtPtr
@@ -214,9 +347,14 @@ void start_document(void * ctx) {
     xmlParserCtxtPtr ctxt = (xmlParserCtxtPtr) ctx;
     sax2_srcsax_handler * state = (sax2_srcsax_handler *) ctxt->_private;
 
+    state->position = INPUT_POSITION;
+
     state->context->stack_size = 0;
     state->context->srcml_element_stack = 0;
 
+    state->parse_function = state->context->parse_function != 0;
+    state->coalesce_characters = state->context->coalesce_characters != 0;
+
     state->context->encoding = "UTF-8";
     if(ctxt->encoding && ctxt->encoding[0]!= '\0')
         state->context->encoding = (const char *)ctxt->encoding;
@@ -253,6 +391,8 @@ void end_document(void * ctx) {
     xmlParserCtxtPtr ctxt = (xmlParserCtxtPtr) ctx;
     sax2_srcsax_handler * state = (sax2_srcsax_handler *) ctxt->_private;
 
+    state->position = state->root_end_position.offset != -1 ? ROOT_END_POSITION : INPUT_POSITION;
+
     state->context->stack_size = 0;
     state->context->srcml_element_stack = 0;
 
@@ -302,7 +442,13 @@ void start_root(void * ctx, const xmlChar * localname, const xmlChar * prefix, c
 
     srcml_element_stack_push(state->context, state->srcml_element_stack, (const char *)prefix, (const char *)localname);
 
+    state->root_id = state->element_table.intern((const char *)localname, (const char *)URI);
     state->root = srcml_element(state->context, localname, prefix, URI, nb_namespaces, namespaces, nb_attributes, nb_defaulted, attributes);
+    ++state->element_copies;
+    state->namespace_table.build(nb_namespaces, namespaces, state->root.namespaces);
+
+    // root callbacks are delayed until the first element, and the root of a non-archive is its unit, which may be copied
+    state->root_position = markup_position(ctxt, true, true);
 
     state->mode = ROOT;
 
@@ -343,42 +489,41 @@ void start_element_ns_first(void * ctx, const xmlChar * localname, const xmlChar
     xmlParserCtxtPtr ctxt = (xmlParserCtxtPtr) ctx;
     sax2_srcsax_handler * state = (sax2_srcsax_handler *) ctxt->_private;
 
-    int ns_length = state->root.nb_namespaces * 2;
-    for (int i = 0; i < ns_length; i += 2)
-        if(prefix && state->root.namespaces[i] && strcmp((const char *)state->root.namespaces[i], (const char *)prefix) == 0)
-            prefix = state->root.namespaces[i];
+    int element_id = state->element_table.intern((const char *)localname, (const char *)URI);
 
-    for (int i = 1; i < ns_length; i += 2)
-        if(URI && state->root.namespaces[i] && strcmp((const char *)state->root.namespaces[i], (const char *)URI) == 0)
-            URI = state->root.namespaces[i];
+    state->namespace_table.resolve(prefix, URI);
 
-    if(strcmp((const char *)localname, "macro-list") == 0) {
+    if(state->element_table.kind(element_id) == SRCML_KIND_MACRO_LIST) {
 
-        if(state->context->handler->meta_tag)
-            state->meta_tags.push_back(srcml_element(state->context, localname, prefix, URI, nb_namespaces, namespaces, nb_attributes, nb_defaulted, attributes));
+        if(state->context->handler->meta_tag) {
+
+            state->meta_tags.emplace_back(state->context, localname, prefix, URI, nb_namespaces, namespaces, nb_attributes, nb_defaulted, attributes);
+            state->meta_tag_ids.push_back(element_id);
+            ++state->element_copies;
+
+        }
 
         return;
 
     }
 
-    srcsax_namespace * srcsax_namespaces = (srcsax_namespace *)libxml2_namespaces2srcsax_namespaces(nb_namespaces, namespaces);
-    srcsax_attribute * srcsax_attributes = (srcsax_attribute *)libxml2_attributes2srcsax_attributes(nb_attributes, attributes);
+    srcsax_namespace * srcsax_namespaces = libxml2_namespaces2srcsax_namespaces(nb_namespaces, namespaces, state->element_buffer);
+    srcsax_attribute * srcsax_attributes = libxml2_attributes2srcsax_attributes(nb_attributes, attributes, state->element_buffer);
 
-    state->is_archive = strcmp((const char *)localname, "unit") == 0;
+    state->is_archive = state->element_table.kind(element_id) == SRCML_KIND_UNIT;
     state->context->is_archive = state->is_archive;
 
+    // the delayed root callbacks are at the root's start tag
+    state->position = ROOT_POSITION;
+
     if(state->context->terminate) return;
 
     if(state->context->handler->start_root) {
 
-        srcsax_namespace * srcsax_namespaces_root = (srcsax_namespace *)libxml2_namespaces2srcsax_namespaces(state->root.nb_namespaces, state->root.namespaces);
-        srcsax_attribute * srcsax_attributes_root = (srcsax_attribute *)libxml2_attributes2srcsax_attributes(state->root.nb_attributes, state->root.attributes);
+        state->context->element_id = state->root_id;
         state->context->handler->start_root(state->context, (const char *)state->root.localname, (const char *)state->root.prefix, (const char *)state->root.URI,
-                                            state->root.nb_namespaces, srcsax_namespaces_root, state->root.nb_attributes,
-                                            srcsax_attributes_root);
-
-        free_srcsax_namespaces(state->root.nb_namespaces, srcsax_namespaces_root);
-        free_srcsax_attributes(state->root.nb_attributes, srcsax_attributes_root);
+                                            state->root.nb_namespaces, state->root.srcsax_namespaces, state->root.nb_attributes,
+                                            state->root.srcsax_attributes);
 
     }
 
@@ -392,15 +537,10 @@ void start_element_ns_first(void * ctx, const xmlChar * localname, const xmlChar
 
             srcml_element_stack_push(state->context, state->srcml_element_stack, (const char *)citr->prefix, (const char *)citr->localname);
 
-            srcsax_namespace * srcsax_namespaces_meta_tag = (srcsax_namespace *)libxml2_namespaces2srcsax_namespaces(citr->nb_namespaces, citr->namespaces);
-            srcsax_attribute * srcsax_attributes_meta_tag = (srcsax_attribute *)libxml2_attributes2srcsax_attributes(citr->nb_attributes, citr->attributes);  
-
+            state->context->element_id = state->meta_tag_ids[citr - state->meta_tags.begin()];
             state->context->handler->meta_tag(state->context, (const char *)citr->localname, (const char *)citr->prefix, (const char *)citr->URI,
-                                                citr->nb_namespaces, srcsax_namespaces_meta_tag, citr->nb_attributes,
-                                                srcsax_attributes_meta_tag);
-
-            free_srcsax_namespaces(citr->nb_namespaces, srcsax_namespaces_meta_tag);
-            free_srcsax_attributes(citr->nb_attributes, srcsax_attributes_meta_tag);
+                                                citr->nb_namespaces, citr->srcsax_namespaces, citr->nb_attributes,
+                                                citr->srcsax_attributes);
 
             srcml_element_stack_pop(state->context, state->srcml_element_stack);
 
@@ -420,36 +560,60 @@ void start_element_ns_first(void * ctx, const xmlChar * localname, const xmlChar
 
         if(state->context->handler->start_unit) {
 
-            srcsax_namespace * srcsax_namespaces_root = (srcsax_namespace *)libxml2_namespaces2srcsax_namespaces(state->root.nb_namespaces, state->root.namespaces);
-            srcsax_attribute * srcsax_attributes_root = (srcsax_attribute *)libxml2_attributes2srcsax_attributes(state->root.nb_attributes, state->root.attributes);        
+            state->context->element_id = state->root_id;
+            state->skippable = true;
             state->context->handler->start_unit(state->context, (const char *)state->root.localname, (const char *)state->root.prefix, (const char *)state->root.URI,
-                                                state->root.nb_namespaces, srcsax_namespaces_root, state->root.nb_attributes,
-                                                srcsax_attributes_root);
-
-            free_srcsax_namespaces(state->root.nb_namespaces, srcsax_namespaces_root);
-            free_srcsax_attributes(state->root.nb_attributes, srcsax_attributes_root);
+                                                state->root.nb_namespaces, state->root.srcsax_namespaces, state->root.nb_attributes,
+                                                state->root.srcsax_attributes);
+            state->skippable = false;
 
         }
 
         if(state->context->terminate) return;
 
-        if(state->characters.size() != 0 && state->context->handler->characters_unit)
+        bool subscribed = is_subscribed(state, element_id, prefix, localname);
+
+        state->position = INPUT_POSITION;
+
+        // a skipped unit also skips its characters and first element
+        if(state->skip_stack_size == 0 && state->context->element_filter == 0 && state->characters.size() != 0 && state->context->handler->characters_unit)
             state->context->handler->characters_unit(state->context, state->characters.c_str(), (int)state->characters.size());
 
         if(state->context->terminate) return;
 
+        state->position = TAG_POSITION;
+
         srcml_element_stack_push(state->context, state->srcml_element_stack, (const char *)prefix, (const char *)localname);
 
-        if(state->context->handler->start_element)
+        if(state->context->element_filter && subscribed) ++state->subscribed_depth;
+
+        state->context->element_id = element_id;
+        if(state->skip_stack_size == 0 && state->parse_function && (element_id == SRCML_SRC_FUNCTION_DECL || element_id == SRCML_SRC_FUNCTION)) {
+
+            state->in_function_header = true;
+            state->current_function.clear(element_id == SRCML_SRC_FUNCTION_DECL, state->srcml_element_stack.size());
+            state->function_position = markup_position(ctxt, true, true);
+
+        } else if(state->skip_stack_size == 0 && subscribed && state->context->handler->start_element) {
+
+            state->skippable = true;
             state->context->handler->start_element(state->context, (const char *)localname, (const char *)prefix, (const char *)URI,
                                                       nb_namespaces, srcsax_namespaces, nb_attributes, srcsax_attributes);
+            state->skippable = false;
+
+        }
+
     } else {
 
         if(state->context->terminate) return;
+
+        state->position = INPUT_POSITION;
         
         if(state->context->handler->characters_root)
             state->context->handler->characters_root(state->context, state->characters.c_str(), (int)state->characters.size());
 
+        state->position = TAG_POSITION;
+
         ++state->context->unit_count;
 
         srcml_element_stack_push(state->context, state->srcml_element_stack, (const char *)prefix, (const char *)localname);
@@ -457,10 +621,15 @@ void start_element_ns_first(void * ctx, const xmlChar * localname, const xmlChar
         if(state->context->terminate) return;
 
         state->mode = UNIT;
-        if(state->context->handler->start_unit)
+        state->context->element_id = element_id;
+        if(state->context->handler->start_unit) {
+
+            state->skippable = true;
             state->context->handler->start_unit(state->context, (const char *)localname, (const char *)prefix, (const char *)URI,
                                                 nb_namespaces, srcsax_namespaces, nb_attributes, srcsax_attributes);
+            state->skippable = false;
 
+        }
 
     }
 
@@ -474,8 +643,7 @@ void start_element_ns_first(void * ctx, const xmlChar * localname, const xmlChar
 
     }
 
-    free_srcsax_namespaces(nb_namespaces, srcsax_namespaces);
-    free_srcsax_attributes(nb_attributes, srcsax_attributes);
+    if(state->skip_stack_size) skip_subtree_begin(ctxt, state);
 
 #ifdef SRCSAX_DEBUG
     fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, (const char *)localname);
@@ -511,31 +679,32 @@ void start_unit(void * ctx, const xmlChar * localname, const xmlChar * prefix, c
     xmlParserCtxtPtr ctxt = (xmlParserCtxtPtr) ctx;
     sax2_srcsax_handler * state = (sax2_srcsax_handler *) ctxt->_private;
 
+    state->position = TAG_POSITION;
+
     if(state->context->terminate) return;
 
-    srcsax_namespace * srcsax_namespaces = (srcsax_namespace *)libxml2_namespaces2srcsax_namespaces(nb_namespaces, namespaces);
-    srcsax_attribute * srcsax_attributes = (srcsax_attribute *)libxml2_attributes2srcsax_attributes(nb_attributes, attributes);
+    int element_id = state->element_table.intern((const char *)localname, (const char *)URI);
 
-    srcml_element_stack_push(state->context, state->srcml_element_stack, (const char *)prefix, (const char *)localname);
+    srcsax_namespace * srcsax_namespaces = libxml2_namespaces2srcsax_namespaces(nb_namespaces, namespaces, state->element_buffer);
+    srcsax_attribute * srcsax_attributes = libxml2_attributes2srcsax_attributes(nb_attributes, attributes, state->element_buffer);
 
-    int ns_length = state->root.nb_namespaces * 2;
-    for (int i = 0; i < ns_length; i += 2)
-        if(prefix && state->root.namespaces[i] && strcmp((const char *)state->root.namespaces[i], (const char *)prefix) == 0)
-            prefix = state->root.namespaces[i];
+    srcml_element_stack_push(state->context, state->srcml_element_stack, (const char *)prefix, (const char *)localname);
 
-    for (int i = 1; i < ns_length; i += 2)
-        if(URI && state->root.namespaces[i] && strcmp((const char *)state->root.namespaces[i], (const char *)URI) == 0)
-            URI = state->root.namespaces[i];
+    state->namespace_table.resolve(prefix, URI);
 
     ++state->context->unit_count;
 
     state->mode = UNIT;
 
+    state->context->element_id = element_id;
+    if(state->context->handler->start_unit) {
 
-
-    if(state->context->handler->start_unit)
+        state->skippable = true;
         state->context->handler->start_unit(state->context, (const char *)localname, (const char *)prefix, (const char *)URI,
             nb_namespaces, srcsax_namespaces, nb_attributes, srcsax_attributes);
+        state->skippable = false;
+
+    }
 
     if(ctxt->sax->startElementNs) ctxt->sax->startElementNs = &start_element_ns;
     if(ctxt->sax->characters) {
@@ -545,8 +714,7 @@ void start_unit(void * ctx, const xmlChar * localname, const xmlChar * prefix, c
 
     }
 
-    free_srcsax_namespaces(nb_namespaces, srcsax_namespaces);
-    free_srcsax_attributes(nb_attributes, srcsax_attributes);
+    if(state->skip_stack_size) skip_subtree_begin(ctxt, state);
 
 #ifdef SRCSAX_DEBUG
     fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, (const char *)localname);
@@ -582,57 +750,87 @@ void start_element_ns(void * ctx, const xmlChar * localname, const xmlChar * pre
     xmlParserCtxtPtr ctxt = (xmlParserCtxtPtr) ctx;
     sax2_srcsax_handler * state = (sax2_srcsax_handler *) ctxt->_private;
     
+    characters_flush(state);
+
+    state->position = TAG_POSITION;
+
     if(state->context->terminate) return;
 
-    srcsax_namespace * srcsax_namespaces = (srcsax_namespace *)libxml2_namespaces2srcsax_namespaces(nb_namespaces, namespaces);
-    srcsax_attribute * srcsax_attributes = (srcsax_attribute *)libxml2_attributes2srcsax_attributes(nb_attributes, attributes);
+    int element_id = state->element_table.intern((const char *)localname, (const char *)URI);
 
     srcml_element_stack_push(state->context, state->srcml_element_stack, (const char *)prefix, (const char *)localname);
 
-    int ns_length = state->root.nb_namespaces * 2;
-    for (int i = 0; i < ns_length; i += 2)
-        if(prefix && state->root.namespaces[i] && strcmp((const char *)state->root.namespaces[i], (const char *)prefix) == 0)
-            prefix = state->root.namespaces[i];
+    // elements outside of the subscriptions are neither converted nor dispatched
+    bool subscribed = is_subscribed(state, element_id, prefix, localname);
+    if(!subscribed && !state->parse_function) return;
+
+    if(state->context->element_filter && subscribed) ++state->subscribed_depth;
 
-    for (int i = 1; i < ns_length; i += 2)
-        if(URI && state->root.namespaces[i] && strcmp((const char *)state->root.namespaces[i], (const char *)URI) == 0)
-            URI = state->root.namespaces[i];
+    state->namespace_table.resolve(prefix, URI);
 
-    if(state->parse_function && (strcmp((const char *)localname, "function_decl") == 0 || strcmp((const char *)localname, "function") == 0)) {
+    if(state->parse_function && !state->in_function_header && (element_id == SRCML_SRC_FUNCTION_DECL || element_id == SRCML_SRC_FUNCTION)) {
 
         state->in_function_header = true;
-        state->current_function = function_prototype(strcmp((const char *)localname, "function_decl") == 0);
+        state->current_function.clear(element_id == SRCML_SRC_FUNCTION_DECL, state->srcml_element_stack.size());
+        state->function_position = markup_position(ctxt, true, true);
 
     } else if(!state->in_function_header) {
 
-        if(state->context->handler->start_element)
+        if(!subscribed) return;
+
+        srcsax_namespace * srcsax_namespaces = libxml2_namespaces2srcsax_namespaces(nb_namespaces, namespaces, state->element_buffer);
+        srcsax_attribute * srcsax_attributes = libxml2_attributes2srcsax_attributes(nb_attributes, attributes, state->element_buffer);
+
+        state->context->element_id = element_id;
+        if(state->context->handler->start_element) {
+
+            state->skippable = true;
             state->context->handler->start_element(state->context, (const char *)localname, (const char *)prefix, (const char *)URI,
                 nb_namespaces, srcsax_namespaces, nb_attributes, srcsax_attributes);
+            state->skippable = false;
+
+        }
+
+        if(state->skip_stack_size) skip_subtree_begin(ctxt, state);
 
     } else {
 
-        if(state->current_function.mode == function_prototype::NAME && strcmp((const char *)localname, "parameter_list") == 0) {
+        // depth in the function, i.e., 1 for type, name and parameter_list, 4 for the type and name of a parameter's decl
+        function_prototype & function = state->current_function;
+        size_t depth = state->srcml_element_stack.size() - function.depth;
 
-            state->current_function.mode = function_prototype::PARAMETER_LIST;
+        if(depth == 1) {
 
-        } else if(state->current_function.mode == function_prototype::PARAMETER_LIST && strcmp((const char *)localname, "param") == 0) {
+            if(element_id == SRCML_SRC_TYPE)
+                function.mode = function_prototype::RETURN_TYPE;
+            else if(element_id == SRCML_SRC_NAME)
+                function.mode = function_prototype::NAME;
+            else if(element_id == SRCML_SRC_PARAMETER_LIST)
+                function.mode = function_prototype::PARAMETER_LIST;
+            else
+                function.mode = function_prototype::HEADER;
 
-            state->current_function.parameter_list.push_back(declaration());
-            state->current_function.mode = function_prototype::PARAMETER;
+        } else if(function.mode == function_prototype::PARAMETER_LIST) {
 
-        } else if(state->current_function.mode == function_prototype::PARAMETER && strcmp((const char *)localname, "init") == 0) {
+            if(depth == 2 && (element_id == SRCML_SRC_PARAM || element_id == SRCML_SRC_PARAMETER)) {
 
-            state->current_function.parameter_list.back().mode = declaration::INIT;
+                function.parameter_list.push_back(declaration());
 
-            state->current_function.mode = function_prototype::PARAMETER_LIST;
+            } else if(depth == 4 && !function.parameter_list.empty()) {
+
+                if(element_id == SRCML_SRC_TYPE)
+                    function.parameter_list.back().mode = declaration::TYPE;
+                else if(element_id == SRCML_SRC_NAME)
+                    function.parameter_list.back().mode = declaration::NAME;
+                else
+                    function.parameter_list.back().mode = declaration::INIT;
+
+            }
 
         }
 
     }
 
-    free_srcsax_namespaces(nb_namespaces, srcsax_namespaces);
-    free_srcsax_attributes(nb_attributes, srcsax_attributes);
-
 #ifdef SRCSAX_DEBUG
     fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, (const char *)localname);
 #endif
@@ -658,31 +856,38 @@ void end_element_ns(void * ctx, const xmlChar * localname, const xmlChar * prefi
 
     if(ctx == NULL) return;
 
-    if(strcmp((const char *)localname, "macro-list") == 0) {
+    xmlParserCtxtPtr ctxt = (xmlParserCtxtPtr) ctx;
+    sax2_srcsax_handler * state = (sax2_srcsax_handler *) ctxt->_private;  
+
+    characters_flush(state);
+
+    state->position = TAG_POSITION;
+
+    int element_id = state->element_table.intern((const char *)localname, (const char *)URI);
+
+    if(state->element_table.kind(element_id) == SRCML_KIND_MACRO_LIST) {
 
         return;
 
     }    
 
-    xmlParserCtxtPtr ctxt = (xmlParserCtxtPtr) ctx;
-    sax2_srcsax_handler * state = (sax2_srcsax_handler *) ctxt->_private;  
-
-    if(strcmp((const char *)localname, "unit") == 0) {
+    if(state->element_table.kind(element_id) == SRCML_KIND_UNIT) {
 
         if(state->mode == ROOT) {
 
             state->is_archive = false;
             state->context->is_archive = state->is_archive;
 
-            if(state->context->terminate) return;
+            // the delayed root callbacks are at the root's start tag
+            state->position = ROOT_POSITION;
 
-            srcsax_namespace * srcsax_namespaces_root = (srcsax_namespace *)libxml2_namespaces2srcsax_namespaces(state->root.nb_namespaces, state->root.namespaces);
-            srcsax_attribute * srcsax_attributes_root = (srcsax_attribute *)libxml2_attributes2srcsax_attributes(state->root.nb_attributes, state->root.attributes);            
+            if(state->context->terminate) return;
 
+            state->context->element_id = state->root_id;
             if(state->context->handler->start_root)
                 state->context->handler->start_root(state->context, (const char *)state->root.localname, (const char *)state->root.prefix, (const char *)state->root.URI,
-                                                    state->root.nb_namespaces, srcsax_namespaces_root, state->root.nb_attributes,
-                                                    srcsax_attributes_root);
+                                                    state->root.nb_namespaces, state->root.srcsax_namespaces, state->root.nb_attributes,
+                                                    state->root.srcsax_attributes);
 
             if(state->context->terminate) return;
 
@@ -692,23 +897,12 @@ void end_element_ns(void * ctx, const xmlChar * localname, const xmlChar * prefi
 
                     srcml_element_stack_push(state->context, state->srcml_element_stack, (const char *)citr->prefix, (const char *)citr->localname);
 
-                    srcsax_namespace * srcsax_namespaces_meta_tag = (srcsax_namespace *)libxml2_namespaces2srcsax_namespaces(citr->nb_namespaces, citr->namespaces);
-                    srcsax_attribute * srcsax_attributes_meta_tag = (srcsax_attribute *)libxml2_attributes2srcsax_attributes(citr->nb_attributes, citr->attributes);  
-
-                    if(state->context->terminate) {
-
-                        free_srcsax_namespaces(state->root.nb_namespaces, srcsax_namespaces_root);
-                        free_srcsax_attributes(state->root.nb_attributes, srcsax_attributes_root);
-                        return;
-
-                    }
+                    if(state->context->terminate) return;
 
+                    state->context->element_id = state->meta_tag_ids[citr - state->meta_tags.begin()];
                     state->context->handler->meta_tag(state->context, (const char *)citr->localname, (const char *)citr->prefix, (const char *)citr->URI,
-                                                        citr->nb_namespaces, srcsax_namespaces_meta_tag, citr->nb_attributes,
-                                                        srcsax_attributes_meta_tag);
-
-                    free_srcsax_namespaces(citr->nb_namespaces, srcsax_namespaces_meta_tag);
-                    free_srcsax_attributes(citr->nb_attributes, srcsax_attributes_meta_tag);
+                                                        citr->nb_namespaces, citr->srcsax_namespaces, citr->nb_attributes,
+                                                        citr->srcsax_attributes);
 
                     srcml_element_stack_pop(state->context, state->srcml_element_stack);
 
@@ -716,27 +910,23 @@ void end_element_ns(void * ctx, const xmlChar * localname, const xmlChar * prefi
 
             }
 
-            if(state->context->terminate) {
-
-                free_srcsax_namespaces(state->root.nb_namespaces, srcsax_namespaces_root);
-                free_srcsax_attributes(state->root.nb_attributes, srcsax_attributes_root);
-                return;
-
-            }
+            if(state->context->terminate) return;
 
+            state->context->element_id = state->root_id;
             if(state->context->handler->start_unit)
                 state->context->handler->start_unit(state->context, (const char *)state->root.localname, (const char *)state->root.prefix, (const char *)state->root.URI,
-                                                    state->root.nb_namespaces, srcsax_namespaces_root, state->root.nb_attributes,
-                                                    srcsax_attributes_root);
-
-            free_srcsax_namespaces(state->root.nb_namespaces, srcsax_namespaces_root);
-            free_srcsax_attributes(state->root.nb_attributes, srcsax_attributes_root);
+                                                    state->root.nb_namespaces, state->root.srcsax_namespaces, state->root.nb_attributes,
+                                                    state->root.srcsax_attributes);
 
             if(state->context->terminate) return;
 
+            state->position = INPUT_POSITION;
+
             if(state->characters.size() != 0 && state->context->handler->characters_unit)
                 state->context->handler->characters_unit(state->context, state->characters.c_str(), (int)state->characters.size());
 
+            state->position = TAG_POSITION;
+
         }
 
         srcml_element_stack_pop(state->context, state->srcml_element_stack);  
@@ -746,12 +936,18 @@ void end_element_ns(void * ctx, const xmlChar * localname, const xmlChar * prefi
         if(ctxt->sax->startElementNs == &start_unit) {
 
             state->mode = END_ROOT;
+            state->context->element_id = element_id;
             if(state->context->handler->end_root)
                 state->context->handler->end_root(state->context, (const char *)localname, (const char *)prefix, (const char *)URI);
 
         } else {
 
             state->mode = END_UNIT;
+            state->context->element_id = element_id;
+
+            // the end_root of a non-archive is delayed until the end of the document
+            if(state->srcml_element_stack.empty()) state->root_end_position = markup_position(ctxt, true, true);
+
             if(state->context->handler->end_unit)
                 state->context->handler->end_unit(state->context, (const char *)localname, (const char *)prefix, (const char *)URI);
             if(ctxt->sax->startElementNs) ctxt->sax->startElementNs = &start_unit;
@@ -769,41 +965,47 @@ void end_element_ns(void * ctx, const xmlChar * localname, const xmlChar * prefi
 
         srcml_element_stack_pop(state->context, state->srcml_element_stack);  
 
-        if(state->in_function_header && (strcmp((const char *)localname, "function_decl") == 0 || strcmp((const char *)localname, "function") == 0)) {
+        bool subscribed = is_subscribed(state, element_id, prefix, localname);
+        if(state->context->element_filter && subscribed) --state->subscribed_depth;
 
-            //state->context->handler->endFunction();
+        if(state->in_function_header) {
 
-        } else if(!state->in_function_header) {
+            // depth in the function of the ended element, 0 for the function itself
+            function_prototype & function = state->current_function;
+            size_t depth = state->srcml_element_stack.size() + 1 - function.depth;
 
-            if(state->context->terminate) return;
+            if(depth == 0) {
 
-            if(state->context->handler->end_element)
-                state->context->handler->end_element(state->context, (const char *)localname, (const char *)prefix, (const char *)URI);
+                // function without a parameter list
+                function_header_end(ctxt, state, false);
+                function_end(state, element_id);
 
-            if(state->context->terminate) return;
+            } else if(depth == 1) {
 
-        } else {
+                if(function.mode == function_prototype::PARAMETER_LIST && element_id == SRCML_SRC_PARAMETER_LIST)
+                    function_header_end(ctxt, state, true);
+                else
+                    function.mode = function_prototype::HEADER;
 
-            if(state->current_function.mode == function_prototype::RETURN_TYPE && strcmp((const char *)localname, "type") == 0) {
+            } else if(depth == 4 && function.mode == function_prototype::PARAMETER_LIST && !function.parameter_list.empty()) {
 
-                state->current_function.mode = function_prototype::NAME;
+                function.parameter_list.back().mode = declaration::INIT;
 
-            } else if(state->current_function.mode == function_prototype::PARAMETER && state->current_function.parameter_list.back().mode == declaration::TYPE
-                    && strcmp((const char *)localname, "type") == 0) {
+            }
 
-                state->current_function.parameter_list.back().mode = declaration::NAME;
+        } else if(state->parse_function && (element_id == SRCML_SRC_FUNCTION_DECL || element_id == SRCML_SRC_FUNCTION)) {
 
-            } else if(state->current_function.mode == function_prototype::PARAMETER 
-                && (strcmp((const char *)localname, "param") == 0 || strcmp((const char *)localname, "decl") == 0)) {
+            function_end(state, element_id);
 
-                state->current_function.mode = function_prototype::PARAMETER_LIST;
+        } else {
 
-            } else if(state->current_function.mode == function_prototype::PARAMETER_LIST && strcmp((const char *)localname, "parameter_list") == 0) {
+            if(state->context->terminate) return;
 
-                state->in_function_header = false;
-                //state->context->handler->startFunction(state->current_function.name, state->current_function.return_type, state->current_function.parameter_list, state->current_function.is_decl);
+            state->context->element_id = element_id;
+            if(subscribed && state->context->handler->end_element)
+                state->context->handler->end_element(state->context, (const char *)localname, (const char *)prefix, (const char *)URI);
 
-            }
+            if(state->context->terminate) return;
 
         }
 
@@ -815,6 +1017,196 @@ void end_element_ns(void * ctx, const xmlChar * localname, const xmlChar * prefi
 
 }
 
+/**
+ * skip_subtree_begin
+ * @param ctxt the libxml2 parser context
+ * @param state the parse state
+ *
+ * Start skipping the subtree of the element srcsax_skip_subtree was called for.
+ * Until its end tag only the depth is tracked, without any callback dispatch.
+ */
+void skip_subtree_begin(xmlParserCtxtPtr ctxt, sax2_srcsax_handler * state) {
+
+    if(state->context->terminate) return;
+
+    // elements already started after the skipped one, e.g., the first element of a non-archive unit
+    state->skip_depth = (int)(state->srcml_element_stack.size() - state->skip_stack_size) + 1;
+    state->skip_sax = *ctxt->sax;
+
+    ctxt->sax->startElementNs = &skip_start_element_ns;
+    ctxt->sax->endElementNs = &skip_end_element_ns;
+    ctxt->sax->characters = 0;
+    ctxt->sax->ignorableWhitespace = 0;
+    ctxt->sax->comment = 0;
+    ctxt->sax->cdataBlock = 0;
+    ctxt->sax->processingInstruction = 0;
+
+}
+
+/**
+ * input_offset
+ * @param ctxt the libxml2 parser context
+ *
+ * @returns the offset of the current parser position in the input.
+ */
+static size_t input_offset(xmlParserCtxtPtr ctxt) {
+
+    return (size_t)ctxt->input->consumed + (size_t)(ctxt->input->cur - ctxt->input->base);
+
+}
+
+/**
+ * start_tag_offset
+ * @param ctxt the libxml2 parser context
+ * @param context the srcSAX context, with the original input
+ *
+ * Offset in the original input of the start tag the parser is at, i.e.,
+ * from a start element callback.  Attribute values can not contain a <,
+ * so it is the last < before the current position.
+ *
+ * @returns the offset, or the input size if not found.
+ */
+size_t start_tag_offset(xmlParserCtxtPtr ctxt, const srcsax_context * context) {
+
+    size_t offset = input_offset(ctxt);
+    if(offset > context->source_size) return context->source_size;
+
+    while(offset != 0)
+        if(context->source[--offset] == '<') return offset;
+
+    return context->source_size;
+
+}
+
+/**
+ * markup_position
+ * @param ctxt the libxml2 parser context
+ * @param tag if the parser is at a tag, i.e., called from a start/end element callback
+ * @param line_column if the line and column are needed
+ *
+ * Position of the tag the parser is at, or of the parser itself.  The tag is the
+ * last < before the parser's position, which libxml2 keeps in its input buffer.
+ *
+ * @returns the position.
+ */
+input_position markup_position(xmlParserCtxtPtr ctxt, bool tag, bool line_column) {
+
+    input_position position;
+
+    xmlParserInputPtr input = ctxt->input;
+    if(input == 0 || input->base == 0 || input->cur == 0) return position;
+
+    const xmlChar * cur = input->cur;
+    const xmlChar * pos = cur;
+    if(tag) {
+
+        while(pos != input->base && *--pos != '<')
+            ;
+
+        if(*pos != '<') pos = cur;
+
+    }
+
+    // the offset in the original encoding of a converted input is only known for the parser's position
+    input->cur = pos;
+    position.offset = xmlByteConsumed(ctxt);
+    input->cur = cur;
+
+    if(!line_column) return position;
+
+    // libxml2 counts the lines up to its position
+    position.line = input->line;
+    bool same_line = true;
+    for(const xmlChar * pos_line = pos; pos_line != cur; ++pos_line)
+        if(*pos_line == '\n') {
+
+            --position.line;
+            same_line = false;
+
+        }
+
+    const xmlChar * line_start = pos;
+    while(line_start != input->base && line_start[-1] != '\n')
+        --line_start;
+
+    if(line_start != input->base || input->consumed == 0)
+        position.column = (int)(pos - line_start) + 1;
+    else if(same_line && input->col > cur - pos)
+        position.column = input->col - (int)(cur - pos);
+
+    return position;
+
+}
+
+/**
+ * skip_start_element_ns
+ * @param ctx an xmlParserCtxtPtr
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param URI the namespace of tag
+ * @param nb_namespaces number of namespaces definitions
+ * @param namespaces the defined namespaces
+ * @param nb_attributes the number of attributes on the tag
+ * @param nb_defaulted the number of defaulted attributes
+ * @param attributes list of attribute name value pairs (localname/prefix/URI/value/end)
+ *
+ * SAX handler function for start of an element in a skipped subtree.
+ */
+void skip_start_element_ns(void * ctx, const xmlChar * localname, const xmlChar * prefix, const xmlChar * URI,
+                           int nb_namespaces, const xmlChar ** namespaces, int nb_attributes, int nb_defaulted,
+                           const xmlChar ** attributes) {
+
+    if(ctx == NULL) return;
+
+    xmlParserCtxtPtr ctxt = (xmlParserCtxtPtr) ctx;
+    sax2_srcsax_handler * state = (sax2_srcsax_handler *) ctxt->_private;
+
+    ++state->skip_depth;
+
+}
+
+/**
+ * skip_end_element_ns
+ * @param ctx an xmlParserCtxtPtr
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param URI the namespace of tag
+ *
+ * SAX handler function for end of an element in a skipped subtree.
+ * At the end of the skipped element, restores the callbacks and
+ * handles the end tag as usual.
+ */
+void skip_end_element_ns(void * ctx, const xmlChar * localname, const xmlChar * prefix, const xmlChar * URI) {
+
+    if(ctx == NULL) return;
+
+    xmlParserCtxtPtr ctxt = (xmlParserCtxtPtr) ctx;
+    sax2_srcsax_handler * state = (sax2_srcsax_handler *) ctxt->_private;
+
+    if(--state->skip_depth != 0) return;
+
+    // the end tag has been parsed, so the copy is the complete element
+    if(state->copy_writer) {
+
+        size_t offset = input_offset(ctxt);
+        if(offset > state->copy_offset && offset <= state->context->source_size)
+            srcsax_write_element_copy(state->copy_writer, state->context->source + state->copy_offset, offset - state->copy_offset);
+
+        state->copy_writer = 0;
+
+    }
+
+    *ctxt->sax = state->skip_sax;
+
+    while(state->srcml_element_stack.size() > state->skip_stack_size)
+        srcml_element_stack_pop(state->context, state->srcml_element_stack);
+
+    state->skip_stack_size = 0;
+
+    end_element_ns(ctx, localname, prefix, URI);
+
+}
+
 /**
  * characters_first
  * @param ctx an xmlParserCtxtPtr
@@ -828,9 +1220,7 @@ void end_element_ns(void * ctx, const xmlChar * localname, const xmlChar * prefi
 void characters_first(void * ctx, const xmlChar * ch, int len) {
 
 #ifdef SRCSAX_DEBUG
-    std::string chars;
-    chars.append((const char *)ch, len);
-    fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, chars.c_str());
+    fprintf(stderr, "HERE: %s %s %d '%.*s'\n", __FILE__, __FUNCTION__, __LINE__, len, (const char *)ch);
 #endif
 
     if(ctx == NULL) return;
@@ -838,10 +1228,12 @@ void characters_first(void * ctx, const xmlChar * ch, int len) {
     xmlParserCtxtPtr ctxt = (xmlParserCtxtPtr) ctx;
     sax2_srcsax_handler * state = (sax2_srcsax_handler *) ctxt->_private;
 
+    state->position = INPUT_POSITION;
+
     state->characters.append((const char *)ch, len);
 
 #ifdef SRCSAX_DEBUG
-    fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, chars.c_str());
+    fprintf(stderr, "HERE: %s %s %d '%.*s'\n", __FILE__, __FUNCTION__, __LINE__, len, (const char *)ch);
 #endif
 
 }
@@ -858,9 +1250,7 @@ void characters_first(void * ctx, const xmlChar * ch, int len) {
 void characters_root(void * ctx, const xmlChar * ch, int len) {
 
 #ifdef SRCSAX_DEBUG
-    std::string chars;
-    chars.append((const char *)ch, len);
-    fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, chars.c_str());
+    fprintf(stderr, "HERE: %s %s %d '%.*s'\n", __FILE__, __FUNCTION__, __LINE__, len, (const char *)ch);
 #endif
 
     if(ctx == NULL) return;
@@ -868,13 +1258,15 @@ void characters_root(void * ctx, const xmlChar * ch, int len) {
     xmlParserCtxtPtr ctxt = (xmlParserCtxtPtr) ctx;
     sax2_srcsax_handler * state = (sax2_srcsax_handler *) ctxt->_private;
 
+    state->position = INPUT_POSITION;
+
     if(state->context->terminate) return;
 
     if(state->context->handler->characters_root)
         state->context->handler->characters_root(state->context, (const char *)ch, len);
 
 #ifdef SRCSAX_DEBUG
-    fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, chars.c_str());
+    fprintf(stderr, "HERE: %s %s %d '%.*s'\n", __FILE__, __FUNCTION__, __LINE__, len, (const char *)ch);
 #endif
 
 }
@@ -891,9 +1283,7 @@ void characters_root(void * ctx, const xmlChar * ch, int len) {
 void characters_unit(void * ctx, const xmlChar * ch, int len) {
 
 #ifdef SRCSAX_DEBUG
-    std::string chars;
-    chars.append((const char *)ch, len);
-    fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, chars.c_str());
+    fprintf(stderr, "HERE: %s %s %d '%.*s'\n", __FILE__, __FUNCTION__, __LINE__, len, (const char *)ch);
 #endif
 
     if(ctx == NULL) return;
@@ -901,33 +1291,53 @@ void characters_unit(void * ctx, const xmlChar * ch, int len) {
     xmlParserCtxtPtr ctxt = (xmlParserCtxtPtr) ctx;
     sax2_srcsax_handler * state = (sax2_srcsax_handler *) ctxt->_private;
 
+    state->position = INPUT_POSITION;
+
 
     if(!state->in_function_header) {
 
         if(state->context->terminate) return;
 
-        if(state->context->handler->characters_unit)
+        // with subscriptions, only characters inside of a subscribed element
+        if(state->context->element_filter && state->subscribed_depth == 0) return;
+
+        if(state->coalesce_characters && !characters_run_end(ctxt, ch, len)) {
+
+            // more characters of the run may follow
+            state->coalesced_characters.append((const char *)ch, len);
+
+        } else if(!state->coalesced_characters.empty()) {
+
+            state->coalesced_characters.append((const char *)ch, len);
+            characters_flush(state);
+
+        } else if(state->context->handler->characters_unit) {
+
             state->context->handler->characters_unit(state->context, (const char *)ch, len);
 
+        }
+
     } else {
 
-        if(state->current_function.mode == function_prototype::RETURN_TYPE)
-            state->current_function.return_type.append((const char *)ch, len);
-        else if(state->current_function.mode == function_prototype::NAME)
-            state->current_function.name.append((const char *)ch, len);
-        else if(state->current_function.mode == function_prototype::PARAMETER) {
+        function_prototype & function = state->current_function;
+
+        if(function.mode == function_prototype::RETURN_TYPE)
+            function.return_type.append((const char *)ch, len);
+        else if(function.mode == function_prototype::NAME)
+            function.name.append((const char *)ch, len);
+        else if(function.mode == function_prototype::PARAMETER_LIST && !function.parameter_list.empty()) {
 
-            if(state->current_function.parameter_list.back().mode == declaration::TYPE)
-                state->current_function.parameter_list.back().type.append((const char *)ch, len);
-            else if(state->current_function.parameter_list.back().mode == declaration::NAME)
-                state->current_function.parameter_list.back().name.append((const char *)ch, len);
+            if(function.parameter_list.back().mode == declaration::TYPE)
+                function.parameter_list.back().type.append((const char *)ch, len);
+            else if(function.parameter_list.back().mode == declaration::NAME)
+                function.parameter_list.back().name.append((const char *)ch, len);
 
         }
 
     }
 
 #ifdef SRCSAX_DEBUG
-    fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, chars.c_str());
+    fprintf(stderr, "HERE: %s %s %d '%.*s'\n", __FILE__, __FUNCTION__, __LINE__, len, (const char *)ch);
 #endif
 
 }
@@ -951,6 +1361,10 @@ void comment(void * ctx, const xmlChar * value) {
     xmlParserCtxtPtr ctxt = (xmlParserCtxtPtr) ctx;
     sax2_srcsax_handler * state = (sax2_srcsax_handler *) ctxt->_private;
 
+    characters_flush(state);
+
+    state->position = INPUT_POSITION;
+
     if(state->context->terminate) return;
 
     if(state->context->handler->comment)
@@ -982,6 +1396,10 @@ void cdata_block(void * ctx, const xmlChar * value, int len) {
     xmlParserCtxtPtr ctxt = (xmlParserCtxtPtr) ctx;
     sax2_srcsax_handler * state = (sax2_srcsax_handler *) ctxt->_private;
 
+    characters_flush(state);
+
+    state->position = INPUT_POSITION;
+
     if(state->context->terminate) return;
 
     if(state->context->handler->cdata_block)
@@ -1013,6 +1431,10 @@ void processing_instruction(void * ctx, const xmlChar * target, const xmlChar *
     xmlParserCtxtPtr ctxt = (xmlParserCtxtPtr) ctx;
     sax2_srcsax_handler * state = (sax2_srcsax_handler *) ctxt->_private;
 
+    characters_flush(state);
+
+    state->position = INPUT_POSITION;
+
     if(state->context->terminate) return;
 
     if(state->context->handler->processing_instruction)
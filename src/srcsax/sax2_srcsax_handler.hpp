@@ -24,7 +24,12 @@
 #define INCLUDED_SAX2_SRCSAX_HANDLER_HPP
 
 #include <srcml_element.hpp>
+#include <srcml_element_filter.hpp>
+#include <srcml_element_stack.hpp>
+#include <srcml_element_table.hpp>
+#include <srcml_namespace_table.hpp>
 #include <srcsax.h>
+#include <srcsax_writer.h>
 
 #include <libxml/parser.h>
 
@@ -46,6 +51,42 @@ enum srcMLMode {
 
 };
 
+/**
+ * srcMLPosition
+ *
+ * Enum of the input positions reported for the current callback.
+ */
+enum srcMLPosition {
+
+    INPUT_POSITION,
+    TAG_POSITION,
+    ROOT_POSITION,
+    ROOT_END_POSITION,
+    FUNCTION_POSITION
+
+};
+
+/**
+ * input_position
+ *
+ * Data structure to hold the position of markup in the input.
+ */
+struct input_position {
+
+    /** default constructor */
+    input_position() : offset(-1), line(0), column(0) {}
+
+    /** byte offset in the input, -1 if not known */
+    long offset;
+
+    /** line, starting at 1 */
+    int line;
+
+    /** byte column, starting at 1, 0 if not known */
+    int column;
+
+};
+
 /**
  * declaration
  *
@@ -54,7 +95,7 @@ enum srcMLMode {
 struct declaration {
 
     /** default constructor */
-    declaration() : type(), name(), mode(TYPE) {}
+    declaration() : type(), name(), mode(INIT) {}
 
     /** declaration type */
     std::string type;
@@ -62,7 +103,7 @@ struct declaration {
     /** declaration name */
     std::string name;
 
-    /** declaration parsing modes */
+    /** declaration parsing modes, characters are only collected in TYPE and NAME */
     enum { TYPE, NAME, INIT } mode;
 
 };
@@ -75,7 +116,25 @@ struct declaration {
 struct function_prototype {
 
     /**constructor */
-    function_prototype(bool is_decl = false) : name(), return_type(), parameter_list(), mode(RETURN_TYPE), is_decl(is_decl) {}
+    function_prototype(bool is_decl = false) : name(), return_type(), parameter_list(), mode(HEADER), is_decl(is_decl), depth(0) {}
+
+    /**
+     * clear
+     * @param is_decl if function_decl or function
+     * @param depth element stack size of the function element
+     *
+     * Start a function, keeping the storage of the previous one.
+     */
+    void clear(bool is_decl, size_t depth) {
+
+        name.clear();
+        return_type.clear();
+        parameter_list.clear();
+        mode = HEADER;
+        this->is_decl = is_decl;
+        this->depth = depth;
+
+    }
 
     /** function name */
     std::string name;
@@ -86,12 +145,41 @@ struct function_prototype {
     /** function parameter list */
     std::vector<declaration> parameter_list;
 
-    /** function prototype parsing modes */
-    enum { RETURN_TYPE, NAME, PARAMETER_LIST, PARAMETER } mode;
+    /** function prototype parsing modes, i.e., the open child of the function */
+    enum { HEADER, RETURN_TYPE, NAME, PARAMETER_LIST } mode;
 
     /** bool to indicate if function_decl or function */
     bool is_decl;
 
+    /** element stack size of the function element */
+    size_t depth;
+
+};
+
+/**
+ * srcsax_marshal_buffer
+ *
+ * Reusable storage for converting libxml2 namespaces/attributes
+ * into their srcSAX form.  Storage only grows, so once warmed up
+ * converting an element does not allocate.
+ */
+struct srcsax_marshal_buffer {
+
+    /** converted namespaces */
+    std::vector<srcsax_namespace> namespaces;
+
+    /** converted attributes */
+    std::vector<srcsax_attribute> attributes;
+
+    /** null terminated attribute values */
+    std::vector<char> values;
+
+    /** number of times the storage was grown */
+    size_t allocations;
+
+    /** default constructor */
+    srcsax_marshal_buffer() : namespaces(), attributes(), values(), allocations(0) {}
+
 };
 
 /**
@@ -103,7 +191,56 @@ struct function_prototype {
 struct sax2_srcsax_handler {
 
     /** default constructor */
-    sax2_srcsax_handler() : context(0), root(), meta_tags(), characters(), is_archive(false), mode(START), parse_function(false), in_function_header(false), current_function() {}
+    sax2_srcsax_handler() : context(0), root(), meta_tags(), characters(), is_archive(false), mode(START), parse_function(false), in_function_header(false), current_function(), function_parameters(),
+                            coalesce_characters(false), coalesced_characters(),
+                            element_buffer(), element_table(), root_id(SRCML_ELEMENT_UNKNOWN), meta_tag_ids(),
+                            skippable(false), skip_stack_size(0), skip_depth(0), skip_sax(), in_start_function(false), copy_writer(0), copy_offset(0),
+                            position(INPUT_POSITION), root_position(), root_end_position(), function_position(),
+                            document_origin(), input_origin(),
+                            subscribed_depth(0), subscribed_ids(),
+                            namespace_table(), element_copies(0) {}
+
+    /**
+     * reset
+     *
+     * Reset for parsing another document.  Conversion storage, the
+     * element stack arena and the interned element IDs are kept.
+     */
+    void reset() {
+
+        root = srcml_element();
+        meta_tags.clear();
+        meta_tag_ids.clear();
+        characters.clear();
+        coalesced_characters.clear();
+        is_archive = false;
+
+        while(!srcml_element_stack.empty())
+            srcml_element_stack.pop();
+        srcml_element_stack.max_size = 0;
+
+        mode = START;
+        in_function_header = false;
+        current_function.clear(false, 0);
+
+        // libxml2 strings of the previous document may be gone
+        element_table.reset_pointers();
+        root_id = SRCML_ELEMENT_UNKNOWN;
+
+        skippable = false;
+        skip_stack_size = 0;
+        skip_depth = 0;
+        in_start_function = false;
+        copy_writer = 0;
+        copy_offset = 0;
+        position = INPUT_POSITION;
+        root_position = input_position();
+        root_end_position = input_position();
+        function_position = input_position();
+        subscribed_depth = 0;
+        subscribed_ids.clear();
+
+    }
 
     /** hooks for processing */
     srcsax_context * context;
@@ -121,7 +258,7 @@ struct sax2_srcsax_handler {
     bool is_archive;
 
     /** open srcMLElement stack */
-    std::vector<const char *> srcml_element_stack;
+    srcml_element_name_stack srcml_element_stack;
 
     /** the current parsing mode */
     srcMLMode mode;
@@ -135,6 +272,78 @@ struct sax2_srcsax_handler {
     /** store data for special function parsing */
     function_prototype current_function;
 
+    /** the parameters of current_function in their srcSAX form */
+    std::vector<srcsax_declaration> function_parameters;
+
+    /** deliver each text run with one characters_unit callback */
+    bool coalesce_characters;
+
+    /** characters of the current text run, when split by libxml2 */
+    std::string coalesced_characters;
+
+    /** conversion storage for the element currently being started */
+    srcsax_marshal_buffer element_buffer;
+
+    /** interned element IDs */
+    srcml_element_table element_table;
+
+    /** ID of the root element */
+    int root_id;
+
+    /** IDs of the stored meta-tags */
+    std::vector<int> meta_tag_ids;
+
+    /** a start unit/element callback that may skip its element is in progress */
+    bool skippable;
+
+    /** stack size of the element to skip, 0 if none */
+    size_t skip_stack_size;
+
+    /** open elements of the subtree being skipped */
+    int skip_depth;
+
+    /** SAX callbacks to restore after skipping */
+    xmlSAXHandler skip_sax;
+
+    /** a start_function callback is in progress, i.e., the input is not at the start tag */
+    bool in_start_function;
+
+    /** writer of the skipped subtree's original bytes, 0 if not copied */
+    srcsax_writer * copy_writer;
+
+    /** input offset of the start tag of the copied subtree */
+    size_t copy_offset;
+
+    /** where the input position of the current callback is */
+    srcMLPosition position;
+
+    /** position of the root start tag */
+    input_position root_position;
+
+    /** position of the end tag of a non-archive's root, whose end_root is delayed */
+    input_position root_end_position;
+
+    /** position of the start tag of the function of start_function */
+    input_position function_position;
+
+    /** start of the content taken from the input in a document built from parts of it, offset -1 if the document is the input */
+    input_position document_origin;
+
+    /** position of that content in the input */
+    input_position input_origin;
+
+    /** number of open subscribed elements */
+    int subscribed_depth;
+
+    /** subscription of the non-srcML element IDs of this parse */
+    std::vector<char> subscribed_ids;
+
+    /** resolution of prefixes/URIs to the root's namespaces */
+    srcml_namespace_table namespace_table;
+
+    /** number of elements saved (one allocation each) for replay */
+    size_t element_copies;
+
 };
 
 /**
@@ -252,6 +461,73 @@ void start_element_ns(void * ctx, const xmlChar * localname, const xmlChar * pre
  */
 void end_element_ns(void * ctx, const xmlChar * localname, const xmlChar * prefix, const xmlChar * URI);
 
+/**
+ * skip_subtree_begin
+ * @param ctxt the libxml2 parser context
+ * @param state the parse state
+ *
+ * Start skipping the subtree of the element srcsax_skip_subtree was called for.
+ * Until its end tag only the depth is tracked, without any callback dispatch.
+ */
+void skip_subtree_begin(xmlParserCtxtPtr ctxt, sax2_srcsax_handler * state);
+
+/**
+ * start_tag_offset
+ * @param ctxt the libxml2 parser context
+ * @param context the srcSAX context, with the original input
+ *
+ * Offset in the original input of the start tag the parser is at, i.e.,
+ * from a start element callback.  Attribute values can not contain a <,
+ * so it is the last < before the current position.
+ *
+ * @returns the offset, or the input size if not found.
+ */
+size_t start_tag_offset(xmlParserCtxtPtr ctxt, const srcsax_context * context);
+
+/**
+ * markup_position
+ * @param ctxt the libxml2 parser context
+ * @param tag if the parser is at a tag, i.e., called from a start/end element callback
+ * @param line_column if the line and column are needed
+ *
+ * Position of the tag the parser is at, or of the parser itself.  The tag is the
+ * last < before the parser's position, which libxml2 keeps in its input buffer.
+ *
+ * @returns the position.
+ */
+input_position markup_position(xmlParserCtxtPtr ctxt, bool tag, bool line_column);
+
+/**
+ * skip_start_element_ns
+ * @param ctx an xmlParserCtxtPtr
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param URI the namespace of tag
+ * @param nb_namespaces number of namespaces definitions
+ * @param namespaces the defined namespaces
+ * @param nb_attributes the number of attributes on the tag
+ * @param nb_defaulted the number of defaulted attributes
+ * @param attributes list of attribute name value pairs (localname/prefix/URI/value/end)
+ *
+ * SAX handler function for start of an element in a skipped subtree.
+ */
+void skip_start_element_ns(void * ctx, const xmlChar * localname, const xmlChar * prefix, const xmlChar * URI,
+                           int nb_namespaces, const xmlChar ** namespaces, int nb_attributes, int nb_defaulted,
+                           const xmlChar ** attributes);
+
+/**
+ * skip_end_element_ns
+ * @param ctx an xmlParserCtxtPtr
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param URI the namespace of tag
+ *
+ * SAX handler function for end of an element in a skipped subtree.
+ * At the end of the skipped element, restores the callbacks and
+ * handles the end tag as usual.
+ */
+void skip_end_element_ns(void * ctx, const xmlChar * localname, const xmlChar * prefix, const xmlChar * URI);
+
 /**
  * characters_first
  * @param ctx an xmlParserCtxtPtr
@@ -21,28 +21,24 @@
 #ifndef INCLUDED_SRCML_ELEMENT_HPP
 #define INCLUDED_SRCML_ELEMENT_HPP
 
-#ifndef _MSC_BUILD
-/** Macro to define the correct name of strdup on unix/windows */
-#define STRDUP strdup
-#else
-#define STRDUP _strdup
-#endif
-
 #include <srcsax.h>
 
 #include <libxml/parser.h>
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <string>
 
-/** Check if a copy was actually allocated */
-#define CHECK_COPY(ORIGINAL, COPY) if(ORIGINAL && !COPY) { fprintf(stderr, "ERROR allocating memory"); srcsax_stop_parser(context); return; }
-
 /**
  * srcml_element
  *
  * Data structure to hold an element
  * mainly root element
+ *
+ * All the data of the element, its strings, the libxml2 form of its namespaces
+ * and attributes and their srcSAX form, is packed into a single allocation.
+ * The srcSAX form is converted once, so replaying the element does not convert it again.
  */
 struct srcml_element {
 
@@ -50,7 +46,8 @@ struct srcml_element {
     srcml_element() : context(0), localname(0), prefix(0), URI(0),
                      nb_namespaces(0), namespaces(0),
                      nb_attributes(0), nb_defaulted(0),
-                     attributes(0)
+                     attributes(0), srcsax_namespaces(0), srcsax_attributes(0),
+                     block(0)
     {}
 
     /** Constructor to initialize using start element items */
@@ -60,64 +57,10 @@ struct srcml_element {
         : context(context), localname(0), prefix(0), URI(0),
           nb_namespaces(0), namespaces(0),
           nb_attributes(0), nb_defaulted(0),
-          attributes(0) {
-
-        // save all the info in case this is not a srcML archive
-        this->localname = localname ? (xmlChar*) STRDUP((const char*) localname) : 0;
-        CHECK_COPY(localname, this->localname);
-
-        this->prefix = prefix ? (xmlChar*) STRDUP((const char*) prefix) : 0;
-        CHECK_COPY(prefix, this->prefix);
-
-        this->URI = URI ? (xmlChar*) STRDUP((const char*) URI) : 0;
-        CHECK_COPY(URI, this->URI);
-
-        this->nb_namespaces = nb_namespaces;
-        int ns_length = nb_namespaces * 2;
-        this->namespaces = (const xmlChar**) malloc(ns_length * sizeof(namespaces[0]));
-        CHECK_COPY(namespaces, this->namespaces);
-        memset(this->namespaces, 0, ns_length * sizeof(namespaces[0]));
-
-        for (int i = 0; i < ns_length; ++i) {
-
-            if(prefix && namespaces[i] && strcmp((const char *)prefix, (const char *)namespaces[i]) == 0)
-                this->namespaces[i] = this->prefix;
-            else if(URI && namespaces[i] && strcmp((const char *)URI, (const char *)namespaces[i]) == 0)
-                this->namespaces[i] = this->URI;
-            else {
-
-                this->namespaces[i] = namespaces[i] ? (xmlChar*) STRDUP((const char*) namespaces[i]) : 0;
-                CHECK_COPY(namespaces[i], this->namespaces[i]);
-            }
+          attributes(0), srcsax_namespaces(0), srcsax_attributes(0),
+          block(0) {
 
-        }
-
-        this->nb_attributes = nb_attributes;
-        this->nb_defaulted = nb_defaulted;
-
-        int nb_length = nb_attributes * 5;
-        this->attributes = (const xmlChar**) malloc(nb_length * sizeof(attributes[0]));
-        CHECK_COPY(attributes, this->attributes);
-
-        memset(this->attributes, 0, nb_length * sizeof(attributes[0]));
-
-        for (int i = 0, index = 0; i < nb_attributes; ++i, index += 5) {
-            this->attributes[index] = attributes[index] ? (xmlChar*) STRDUP((const char*) attributes[index]) : 0;
-            CHECK_COPY(attributes[index], this->attributes[index]);
-            this->attributes[index + 1] = attributes[index + 1] ? (xmlChar*) STRDUP((const char*) attributes[index + 1]) : 0;
-            CHECK_COPY(attributes[index + 1], this->attributes[index + 1]);
-            this->attributes[index + 2] = attributes[index + 2] ? (xmlChar*) STRDUP((const char*) attributes[index + 2]) : 0;
-            CHECK_COPY(attributes[index + 2], this->attributes[index + 2]);
-
-            int vallength = (int)(attributes[index + 4] - attributes[index + 3]);
-            this->attributes[index + 3] = (const xmlChar*) malloc(vallength + 1);
-            CHECK_COPY(attributes[index + 3], this->attributes[index + 3]);
-
-            strncpy((char *) this->attributes[index + 3], (const char*) attributes[index + 3], vallength);
-            ((char *)this->attributes[index + 3])[vallength] = 0;
-            this->attributes[index + 4] = this->attributes[index + 3] + vallength;
-
-        }
+        pack(localname, prefix, URI, nb_namespaces, namespaces, nb_attributes, nb_defaulted, attributes);
 
     }
 
@@ -126,55 +69,24 @@ struct srcml_element {
         : context(element.context), localname(0), prefix(0), URI(0),
           nb_namespaces(0), namespaces(0),
           nb_attributes(0), nb_defaulted(0),
-          attributes(0) {
+          attributes(0), srcsax_namespaces(0), srcsax_attributes(0),
+          block(0) {
 
-        // save all the info in case this is not a srcML archive
-        this->localname = element.localname ? (xmlChar*) STRDUP((const char*) element.localname) : 0;
-        CHECK_COPY(element.localname, this->localname);
+        if(element.block)
+            pack(element.localname, element.prefix, element.URI, element.nb_namespaces, element.namespaces,
+                 element.nb_attributes, element.nb_defaulted, element.attributes);
 
-        this->prefix = element.prefix ? (xmlChar*) STRDUP((const char*) element.prefix) : 0;
-        CHECK_COPY(element.prefix, this->prefix);
-
-        this->URI = element.URI ? (xmlChar*) STRDUP((const char*) element.URI) : 0;
-        CHECK_COPY(element.URI, this->URI);
-
-        this->nb_namespaces = element.nb_namespaces;
-        int ns_length = element.nb_namespaces * 2;
-        this->namespaces = (const xmlChar**) malloc(ns_length * sizeof(element.namespaces[0]));
-        CHECK_COPY(element.namespaces, this->namespaces);
-        memset(this->namespaces, 0, ns_length * sizeof(element.namespaces[0]));
-
-        for (int i = 0; i < ns_length; ++i) {
-            this->namespaces[i] = element.namespaces[i] ? (xmlChar*) STRDUP((const char*) element.namespaces[i]) : 0;
-            CHECK_COPY(element.namespaces[i], this->namespaces[i]);
-        }
-
-        this->nb_attributes = element.nb_attributes;
-        this->nb_defaulted = element.nb_defaulted;
-
-        int nb_length = element.nb_attributes * 5;
-        this->attributes = (const xmlChar**) malloc(nb_length * sizeof(element.attributes[0]));
-        CHECK_COPY(element.attributes, this->attributes);
-
-        memset(this->attributes, 0, nb_length * sizeof(element.attributes[0]));
-
-        for (int i = 0, index = 0; i < element.nb_attributes; ++i, index += 5) {
-            this->attributes[index] = element.attributes[index] ? (xmlChar*) STRDUP((const char*) element.attributes[index]) : 0;
-            CHECK_COPY(element.attributes[index], this->attributes[index]);
-            this->attributes[index + 1] = element.attributes[index + 1] ? (xmlChar*) STRDUP((const char*) element.attributes[index + 1]) : 0;
-            CHECK_COPY(element.attributes[index + 1], this->attributes[index + 1]);
-            this->attributes[index + 2] = element.attributes[index + 2] ? (xmlChar*) STRDUP((const char*) element.attributes[index + 2]) : 0;
-            CHECK_COPY(element.attributes[index + 2], this->attributes[index + 2]);
-
-            int vallength = (int)(element.attributes[index + 4] - element.attributes[index + 3]);
-            this->attributes[index + 3] = (const xmlChar*) malloc(vallength + 1);
-            CHECK_COPY(element.attributes[index + 3], this->attributes[index + 3]);
+    }
 
-            strncpy((char *) this->attributes[index + 3], (const char*) element.attributes[index + 3], vallength);
-            ((char *)this->attributes[index + 3])[vallength] = 0;
-            this->attributes[index + 4] = this->attributes[index + 3] + vallength;
+    /** Move constructor, takes over the allocation of the element */
+    srcml_element(srcml_element && element) noexcept
+        : context(element.context), localname(0), prefix(0), URI(0),
+          nb_namespaces(0), namespaces(0),
+          nb_attributes(0), nb_defaulted(0),
+          attributes(0), srcsax_namespaces(0), srcsax_attributes(0),
+          block(0) {
 
-        }
+        swap(element);
 
     }
 
@@ -189,6 +101,7 @@ struct srcml_element {
     /** swap operator */
     void swap(srcml_element & element) {
 
+        std::swap(context, element.context);
         std::swap(localname, element.localname);
         std::swap(prefix, element.prefix);
         std::swap(URI, element.URI);
@@ -197,40 +110,16 @@ struct srcml_element {
         std::swap(nb_attributes, element.nb_attributes);
         std::swap(nb_defaulted, element.nb_defaulted);
         std::swap(attributes, element.attributes);
+        std::swap(srcsax_namespaces, element.srcsax_namespaces);
+        std::swap(srcsax_attributes, element.srcsax_attributes);
+        std::swap(block, element.block);
 
     }
 
     /** destructor */
     ~srcml_element() {
 
-        if(namespaces) {
-
-            for(int i = 0; i < nb_namespaces * 2; ++i)
-                if(namespaces[i] && namespaces[i] != prefix && namespaces[i] != URI)
-                    free((void *)namespaces[i]);
-
-            free((void *)namespaces);
-        }
-
-        if(localname) free((void *)localname);
-        if(prefix) free((void *)prefix);
-        if(URI) free((void *)URI);
-
-        if(attributes) {
-
-            for (int i = 0, index = 0; i < nb_attributes; ++i, index += 5) {
-                if(attributes[index])
-                    free((void *)attributes[index]);
-                if(attributes[index + 1])
-                    free((void *)attributes[index + 1]);
-                if(attributes[index + 2])
-                    free((void *)attributes[index + 2]);
-                free((void *)attributes[index + 3]);
-            }
-
-            free((void *)attributes);
-
-        }
+        free(block);
 
     }
 
@@ -261,6 +150,134 @@ struct srcml_element {
     /** attributes of an element*/
     const xmlChar** attributes;
 
+    /** namespaces on an element in their srcSAX form */
+    srcsax_namespace * srcsax_namespaces;
+
+    /** attributes of an element in their srcSAX form, values null terminated */
+    srcsax_attribute * srcsax_attributes;
+
+private :
+
+    /**
+     * string_size
+     * @param begin start of a string
+     * @param end end of the string, or 0 if null terminated
+     *
+     * @returns the size of the string with its null terminator, 0 for no string.
+     */
+    static size_t string_size(const xmlChar * begin, const xmlChar * end = 0) {
+
+        if(begin == 0) return 0;
+
+        return (end ? (size_t)(end - begin) : strlen((const char *)begin)) + 1;
+
+    }
+
+    /**
+     * copy_string
+     * @param pos position in the allocation to copy to, advanced past the copy
+     * @param begin start of a string
+     * @param end end of the string, or 0 if null terminated
+     *
+     * @returns the null terminated copy of the string, 0 for no string.
+     */
+    static const xmlChar * copy_string(char *& pos, const xmlChar * begin, const xmlChar * end = 0) {
+
+        size_t size = string_size(begin, end);
+        if(size == 0) return 0;
+
+        char * copy = pos;
+        memcpy(copy, begin, size - 1);
+        copy[size - 1] = 0;
+        pos += size;
+
+        return (const xmlChar *)copy;
+
+    }
+
+    /**
+     * pack
+     *
+     * Copy the start element items into a single allocation.  On an
+     * allocation failure the parser is stopped and the element left empty.
+     */
+    void pack(const xmlChar * localname, const xmlChar * prefix, const xmlChar * URI,
+              int nb_namespaces, const xmlChar ** namespaces, int nb_attributes, int nb_defaulted,
+              const xmlChar ** attributes) {
+
+        // pointer arrays first, so they are aligned, then the strings
+        size_t size = nb_namespaces * (sizeof(srcsax_namespace) + 2 * sizeof(const xmlChar *))
+                    + nb_attributes * (sizeof(srcsax_attribute) + 5 * sizeof(const xmlChar *));
+
+        size += string_size(localname) + string_size(prefix) + string_size(URI);
+
+        for(int i = 0; i < nb_namespaces * 2; ++i)
+            size += string_size(namespaces[i]);
+
+        for(int i = 0, index = 0; i < nb_attributes; ++i, index += 5)
+            size += string_size(attributes[index]) + string_size(attributes[index + 1]) + string_size(attributes[index + 2])
+                  + string_size(attributes[index + 3], attributes[index + 4]);
+
+        block = (char *)malloc(size ? size : 1);
+        if(block == 0) {
+
+            fprintf(stderr, "ERROR allocating memory");
+            if(context) srcsax_stop_parser(context);
+            return;
+
+        }
+
+        char * pos = block;
+
+        this->srcsax_namespaces = (srcsax_namespace *)pos;
+        pos += nb_namespaces * sizeof(srcsax_namespace);
+
+        this->srcsax_attributes = (srcsax_attribute *)pos;
+        pos += nb_attributes * sizeof(srcsax_attribute);
+
+        this->namespaces = (const xmlChar **)pos;
+        pos += nb_namespaces * 2 * sizeof(const xmlChar *);
+
+        this->attributes = (const xmlChar **)pos;
+        pos += nb_attributes * 5 * sizeof(const xmlChar *);
+
+        this->localname = copy_string(pos, localname);
+        this->prefix = copy_string(pos, prefix);
+        this->URI = copy_string(pos, URI);
+
+        this->nb_namespaces = nb_namespaces;
+        for(int i = 0, index = 0; i < nb_namespaces; ++i, index += 2) {
+
+            this->namespaces[index] = copy_string(pos, namespaces[index]);
+            this->namespaces[index + 1] = copy_string(pos, namespaces[index + 1]);
+
+            this->srcsax_namespaces[i].prefix = (const char *)this->namespaces[index];
+            this->srcsax_namespaces[i].uri = (const char *)this->namespaces[index + 1];
+
+        }
+
+        this->nb_attributes = nb_attributes;
+        this->nb_defaulted = nb_defaulted;
+        for(int i = 0, index = 0; i < nb_attributes; ++i, index += 5) {
+
+            this->attributes[index] = copy_string(pos, attributes[index]);
+            this->attributes[index + 1] = copy_string(pos, attributes[index + 1]);
+            this->attributes[index + 2] = copy_string(pos, attributes[index + 2]);
+            this->attributes[index + 3] = copy_string(pos, attributes[index + 3], attributes[index + 4]);
+            this->attributes[index + 4] = this->attributes[index + 3] ? this->attributes[index + 3] + (attributes[index + 4] - attributes[index + 3]) : 0;
+
+            this->srcsax_attributes[i].localname = (const char *)this->attributes[index];
+            this->srcsax_attributes[i].prefix = (const char *)this->attributes[index + 1];
+            this->srcsax_attributes[i].uri = (const char *)this->attributes[index + 2];
+            this->srcsax_attributes[i].value = (const char *)this->attributes[index + 3];
+
+        }
+
+    }
+
+    /** the single allocation holding all the data of the element */
+    char * block;
+
 };
 
 #endif
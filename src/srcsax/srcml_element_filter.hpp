@@ -0,0 +1,127 @@
+/**
+ * @file srcml_element_filter.hpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcML SAX2 Framework.
+ *
+ * The srcML SAX2 Framework is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML SAX2 Framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML SAX2 Framework; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INCLUDED_SRCML_ELEMENT_FILTER_HPP
+#define INCLUDED_SRCML_ELEMENT_FILTER_HPP
+
+#include <srcml_element_table.hpp>
+
+#include <string.h>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * srcml_element_filter
+ *
+ * The set of elements a handler subscribed to.  Known srcML elements are
+ * kept by ID, any other element by qualified name.
+ */
+struct srcml_element_filter {
+
+    /** default constructor */
+    srcml_element_filter() : known(SRCML_ELEMENT_ID_COUNT, false), qnames() {}
+
+    /**
+     * subscribe
+     * @param qname the qualified name of an element, srcML elements without the src prefix
+     *
+     * Add an element to the subscription set.
+     */
+    void subscribe(const char * qname) {
+
+        const char * colon = strchr(qname, ':');
+        const char * localname = colon ? colon + 1 : qname;
+
+        int ns = SRCML_NAMESPACE_OTHER;
+        if(colon == 0 || (colon - qname == 3 && strncmp(qname, "src", 3) == 0))
+            ns = SRCML_NAMESPACE_SRC;
+        else if(colon - qname == 3 && strncmp(qname, "cpp", 3) == 0)
+            ns = SRCML_NAMESPACE_CPP;
+
+        int id = ns == SRCML_NAMESPACE_OTHER ? (int)SRCML_ELEMENT_UNKNOWN : srcml_element_id_known(ns, localname);
+        if(id != SRCML_ELEMENT_UNKNOWN)
+            known[id] = true;
+        else
+            qnames.insert(qname);
+
+    }
+
+    /**
+     * subscribe
+     * @param element_id the ID of a known srcML element
+     *
+     * Add an element to the subscription set.
+     */
+    void subscribe(int element_id) {
+
+        known[element_id] = true;
+
+    }
+
+    /**
+     * is_subscribed
+     * @param element_id the ID of the element in the current parse
+     * @param prefix the element prefix
+     * @param localname the name of the element
+     * @param cache subscription of the non-srcML element IDs of the current parse
+     *
+     * Test if an element is in the subscription set.  Non-srcML elements are
+     * only looked up by name the first time their ID is seen in a parse.
+     *
+     * @returns if the element is subscribed.
+     */
+    bool is_subscribed(int element_id, const char * prefix, const char * localname, std::vector<char> & cache) const {
+
+        if(element_id < SRCML_ELEMENT_ID_COUNT) return known[element_id];
+
+        size_t pos = element_id - SRCML_ELEMENT_ID_COUNT;
+        if(pos >= cache.size()) cache.resize(pos + 1, -1);
+
+        if(cache[pos] == -1) {
+
+            std::string qname;
+            if(prefix) {
+
+                qname += prefix;
+                qname += ':';
+
+            }
+            qname += localname;
+
+            cache[pos] = qnames.find(qname) != qnames.end();
+
+        }
+
+        return cache[pos] != 0;
+
+    }
+
+    /** subscription of the known srcML elements by ID */
+    std::vector<bool> known;
+
+    /** qualified names of subscribed non-srcML elements */
+    std::set<std::string> qnames;
+
+};
+
+#endif
@@ -0,0 +1,267 @@
+/**
+ * @file srcml_element_id.cpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcML SAX2 Framework.
+ *
+ * The srcML SAX2 Framework is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML SAX2 Framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML SAX2 Framework; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Generated by tools/srcml_element_id_gen.py, do not edit.
+ */
+
+#include <srcml_element_table.hpp>
+
+#include <cstring>
+
+/** number of perfect hash buckets */
+static const unsigned int BUCKET_COUNT = 34;
+
+/** number of perfect hash slots (power of 2) */
+static const unsigned int SLOT_COUNT = 512;
+
+/** perfect hash bucket displacements */
+static const unsigned int displacements[BUCKET_COUNT] = {
+    2, 1, 1, 1, 1, 1, 3, 2, 1, 2, 4, 2, 2, 1, 1, 1,
+    2, 1, 1, 1, 1, 1, 1, 2, 1, 3, 2, 1, 1, 1, 1, 3,
+    2, 1,
+};
+
+/** perfect hash slot element IDs */
+static const unsigned char slots[SLOT_COUNT] = {
+    0, 0, 0, 0, 0, 13, 30, 0, 63, 0, 27, 0, 102, 97, 126, 0,
+    0, 0, 0, 0, 0, 0, 20, 0, 0, 0, 7, 0, 0, 17, 0, 0,
+    0, 0, 0, 91, 0, 0, 0, 0, 0, 0, 0, 0, 109, 32, 0, 66,
+    0, 0, 0, 0, 93, 0, 0, 53, 0, 118, 103, 0, 0, 55, 0, 0,
+    38, 0, 101, 0, 0, 0, 0, 83, 86, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 106, 47, 0, 0, 0,
+    0, 123, 14, 42, 82, 0, 0, 94, 0, 0, 107, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 54, 0, 65, 0, 0, 0, 128, 48, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    70, 108, 0, 0, 0, 0, 43, 0, 0, 8, 0, 0, 0, 71, 45, 0,
+    0, 0, 117, 0, 24, 0, 0, 104, 0, 0, 0, 0, 0, 0, 0, 11,
+    0, 0, 0, 0, 44, 0, 0, 98, 60, 0, 0, 0, 0, 0, 131, 0,
+    0, 99, 0, 0, 5, 0, 0, 0, 0, 4, 129, 0, 0, 0, 0, 69,
+    113, 0, 0, 0, 0, 0, 0, 0, 62, 0, 0, 0, 9, 0, 0, 3,
+    81, 0, 0, 35, 0, 0, 22, 0, 0, 87, 133, 0, 0, 52, 49, 0,
+    57, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 36, 0, 41, 0, 0,
+    0, 0, 0, 0, 73, 51, 75, 25, 120, 0, 0, 76, 0, 0, 29, 0,
+    0, 127, 0, 0, 0, 78, 0, 0, 0, 68, 0, 0, 0, 90, 121, 0,
+    105, 64, 0, 0, 0, 39, 100, 0, 72, 34, 0, 0, 132, 77, 0, 0,
+    0, 0, 0, 0, 95, 124, 80, 0, 0, 0, 0, 84, 0, 12, 0, 0,
+    0, 46, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 134,
+    1, 0, 0, 0, 0, 0, 114, 0, 28, 0, 96, 0, 0, 59, 0, 0,
+    74, 0, 0, 0, 0, 0, 85, 92, 2, 10, 0, 0, 0, 0, 23, 0,
+    0, 0, 0, 0, 0, 0, 111, 0, 0, 0, 89, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 37, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 125, 19, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 112, 0,
+    0, 0, 88, 67, 0, 0, 58, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 21, 26, 0, 0, 130, 0, 0, 16, 119, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 122, 79, 40, 0, 0, 0, 0, 0, 115, 0,
+    0, 0, 0, 0, 18, 0, 0, 0, 0, 0, 0, 61, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 50, 33, 116, 0, 6, 0, 31, 56, 15, 110, 0,
+};
+
+/** element namespace and localname by ID */
+static const struct { int ns; const char * localname; } elements[SRCML_ELEMENT_ID_COUNT] = {
+
+    { SRCML_NAMESPACE_OTHER, 0 },
+    { SRCML_NAMESPACE_SRC, "unit" },
+    { SRCML_NAMESPACE_SRC, "macro-list" },
+    { SRCML_NAMESPACE_SRC, "escape" },
+    { SRCML_NAMESPACE_SRC, "comment" },
+    { SRCML_NAMESPACE_SRC, "literal" },
+    { SRCML_NAMESPACE_SRC, "operator" },
+    { SRCML_NAMESPACE_SRC, "modifier" },
+    { SRCML_NAMESPACE_SRC, "name" },
+    { SRCML_NAMESPACE_SRC, "type" },
+    { SRCML_NAMESPACE_SRC, "condition" },
+    { SRCML_NAMESPACE_SRC, "block" },
+    { SRCML_NAMESPACE_SRC, "index" },
+    { SRCML_NAMESPACE_SRC, "decl" },
+    { SRCML_NAMESPACE_SRC, "decl_stmt" },
+    { SRCML_NAMESPACE_SRC, "init" },
+    { SRCML_NAMESPACE_SRC, "range" },
+    { SRCML_NAMESPACE_SRC, "argument_list" },
+    { SRCML_NAMESPACE_SRC, "argument" },
+    { SRCML_NAMESPACE_SRC, "parameter_list" },
+    { SRCML_NAMESPACE_SRC, "param" },
+    { SRCML_NAMESPACE_SRC, "parameter" },
+    { SRCML_NAMESPACE_SRC, "krparameter_list" },
+    { SRCML_NAMESPACE_SRC, "krparameter" },
+    { SRCML_NAMESPACE_SRC, "member_list" },
+    { SRCML_NAMESPACE_SRC, "expr" },
+    { SRCML_NAMESPACE_SRC, "expr_stmt" },
+    { SRCML_NAMESPACE_SRC, "empty_stmt" },
+    { SRCML_NAMESPACE_SRC, "if" },
+    { SRCML_NAMESPACE_SRC, "then" },
+    { SRCML_NAMESPACE_SRC, "else" },
+    { SRCML_NAMESPACE_SRC, "elseif" },
+    { SRCML_NAMESPACE_SRC, "while" },
+    { SRCML_NAMESPACE_SRC, "do" },
+    { SRCML_NAMESPACE_SRC, "for" },
+    { SRCML_NAMESPACE_SRC, "foreach" },
+    { SRCML_NAMESPACE_SRC, "control" },
+    { SRCML_NAMESPACE_SRC, "incr" },
+    { SRCML_NAMESPACE_SRC, "switch" },
+    { SRCML_NAMESPACE_SRC, "case" },
+    { SRCML_NAMESPACE_SRC, "default" },
+    { SRCML_NAMESPACE_SRC, "break" },
+    { SRCML_NAMESPACE_SRC, "continue" },
+    { SRCML_NAMESPACE_SRC, "return" },
+    { SRCML_NAMESPACE_SRC, "goto" },
+    { SRCML_NAMESPACE_SRC, "label" },
+    { SRCML_NAMESPACE_SRC, "typedef" },
+    { SRCML_NAMESPACE_SRC, "asm" },
+    { SRCML_NAMESPACE_SRC, "macro" },
+    { SRCML_NAMESPACE_SRC, "enum" },
+    { SRCML_NAMESPACE_SRC, "function" },
+    { SRCML_NAMESPACE_SRC, "function_decl" },
+    { SRCML_NAMESPACE_SRC, "specifier" },
+    { SRCML_NAMESPACE_SRC, "struct" },
+    { SRCML_NAMESPACE_SRC, "struct_decl" },
+    { SRCML_NAMESPACE_SRC, "union" },
+    { SRCML_NAMESPACE_SRC, "union_decl" },
+    { SRCML_NAMESPACE_SRC, "class" },
+    { SRCML_NAMESPACE_SRC, "class_decl" },
+    { SRCML_NAMESPACE_SRC, "public" },
+    { SRCML_NAMESPACE_SRC, "private" },
+    { SRCML_NAMESPACE_SRC, "protected" },
+    { SRCML_NAMESPACE_SRC, "signal" },
+    { SRCML_NAMESPACE_SRC, "forever" },
+    { SRCML_NAMESPACE_SRC, "emit" },
+    { SRCML_NAMESPACE_SRC, "constructor" },
+    { SRCML_NAMESPACE_SRC, "constructor_decl" },
+    { SRCML_NAMESPACE_SRC, "destructor" },
+    { SRCML_NAMESPACE_SRC, "destructor_decl" },
+    { SRCML_NAMESPACE_SRC, "member_init_list" },
+    { SRCML_NAMESPACE_SRC, "super" },
+    { SRCML_NAMESPACE_SRC, "call" },
+    { SRCML_NAMESPACE_SRC, "template" },
+    { SRCML_NAMESPACE_SRC, "try" },
+    { SRCML_NAMESPACE_SRC, "catch" },
+    { SRCML_NAMESPACE_SRC, "throw" },
+    { SRCML_NAMESPACE_SRC, "throws" },
+    { SRCML_NAMESPACE_SRC, "finally" },
+    { SRCML_NAMESPACE_SRC, "extern" },
+    { SRCML_NAMESPACE_SRC, "namespace" },
+    { SRCML_NAMESPACE_SRC, "using" },
+    { SRCML_NAMESPACE_SRC, "lambda" },
+    { SRCML_NAMESPACE_SRC, "sizeof" },
+    { SRCML_NAMESPACE_SRC, "typeid" },
+    { SRCML_NAMESPACE_SRC, "noexcept" },
+    { SRCML_NAMESPACE_SRC, "decltype" },
+    { SRCML_NAMESPACE_SRC, "alignof" },
+    { SRCML_NAMESPACE_SRC, "alignas" },
+    { SRCML_NAMESPACE_SRC, "typename" },
+    { SRCML_NAMESPACE_SRC, "attribute" },
+    { SRCML_NAMESPACE_SRC, "annotation" },
+    { SRCML_NAMESPACE_SRC, "package" },
+    { SRCML_NAMESPACE_SRC, "import" },
+    { SRCML_NAMESPACE_SRC, "interface" },
+    { SRCML_NAMESPACE_SRC, "interface_decl" },
+    { SRCML_NAMESPACE_SRC, "static" },
+    { SRCML_NAMESPACE_SRC, "synchronized" },
+    { SRCML_NAMESPACE_SRC, "assert" },
+    { SRCML_NAMESPACE_SRC, "lock" },
+    { SRCML_NAMESPACE_SRC, "fixed" },
+    { SRCML_NAMESPACE_SRC, "checked" },
+    { SRCML_NAMESPACE_SRC, "unchecked" },
+    { SRCML_NAMESPACE_SRC, "unsafe" },
+    { SRCML_NAMESPACE_SRC, "event" },
+    { SRCML_NAMESPACE_SRC, "property" },
+    { SRCML_NAMESPACE_SRC, "delegate" },
+    { SRCML_NAMESPACE_SRC, "using_stmt" },
+    { SRCML_NAMESPACE_SRC, "friend" },
+    { SRCML_NAMESPACE_SRC, "ternary" },
+    { SRCML_NAMESPACE_SRC, "position" },
+    { SRCML_NAMESPACE_CPP, "directive" },
+    { SRCML_NAMESPACE_CPP, "file" },
+    { SRCML_NAMESPACE_CPP, "include" },
+    { SRCML_NAMESPACE_CPP, "define" },
+    { SRCML_NAMESPACE_CPP, "undef" },
+    { SRCML_NAMESPACE_CPP, "line" },
+    { SRCML_NAMESPACE_CPP, "if" },
+    { SRCML_NAMESPACE_CPP, "ifdef" },
+    { SRCML_NAMESPACE_CPP, "ifndef" },
+    { SRCML_NAMESPACE_CPP, "else" },
+    { SRCML_NAMESPACE_CPP, "elif" },
+    { SRCML_NAMESPACE_CPP, "endif" },
+    { SRCML_NAMESPACE_CPP, "then" },
+    { SRCML_NAMESPACE_CPP, "pragma" },
+    { SRCML_NAMESPACE_CPP, "error" },
+    { SRCML_NAMESPACE_CPP, "warning" },
+    { SRCML_NAMESPACE_CPP, "value" },
+    { SRCML_NAMESPACE_CPP, "number" },
+    { SRCML_NAMESPACE_CPP, "literal" },
+    { SRCML_NAMESPACE_CPP, "macro" },
+    { SRCML_NAMESPACE_CPP, "empty" },
+    { SRCML_NAMESPACE_CPP, "region" },
+    { SRCML_NAMESPACE_CPP, "endregion" },
+    { SRCML_NAMESPACE_CPP, "import" },
+    { SRCML_NAMESPACE_CPP, "mark" },
+
+};
+
+/**
+ * srcml_element_id_known
+ * @param ns the srcml_element_namespace of the element
+ * @param localname the name of the element
+ *
+ * Perfect hash lookup of a known srcML element.
+ *
+ * @returns the element's ID or SRCML_ELEMENT_UNKNOWN if not a known srcML element.
+ */
+int srcml_element_id_known(int ns, const char * localname) {
+
+    if(ns == SRCML_NAMESPACE_OTHER || localname == 0) return SRCML_ELEMENT_UNKNOWN;
+
+    unsigned int hash = 2166136261u ^ ((unsigned int)ns * 0x9e3779b9u);
+    for(const unsigned char * pos = (const unsigned char *)localname; *pos; ++pos) {
+
+        hash ^= *pos;
+        hash *= 16777619u;
+
+    }
+
+    unsigned int slot = hash ^ displacements[hash % BUCKET_COUNT];
+    slot ^= slot >> 16;
+    slot *= 0x85ebca6bu;
+    slot ^= slot >> 13;
+    slot *= 0xc2b2ae35u;
+    slot ^= slot >> 16;
+
+    int id = slots[slot & (SLOT_COUNT - 1)];
+    if(id == SRCML_ELEMENT_UNKNOWN || elements[id].ns != ns || strcmp(elements[id].localname, localname) != 0)
+        return SRCML_ELEMENT_UNKNOWN;
+
+    return id;
+
+}
+
+/**
+ * srcml_element_id_known_name
+ * @param id a known srcML element ID
+ *
+ * @returns the localname of the known element or 0 if not a known ID.
+ */
+const char * srcml_element_id_known_name(int id) {
+
+    if(id <= SRCML_ELEMENT_UNKNOWN || id >= SRCML_ELEMENT_ID_COUNT) return 0;
+
+    return elements[id].localname;
+
+}
@@ -0,0 +1,178 @@
+/**
+ * @file srcml_element_id.h
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcML SAX2 Framework.
+ *
+ * The srcML SAX2 Framework is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML SAX2 Framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML SAX2 Framework; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Generated by tools/srcml_element_id_gen.py, do not edit.
+ */
+
+#ifndef INCLUDED_SRCML_ELEMENT_ID_H
+#define INCLUDED_SRCML_ELEMENT_ID_H
+
+/**
+ * srcml_element_id
+ *
+ * IDs of the known srcML (src and cpp namespace) elements.
+ * Elements outside of this vocabulary are given IDs of SRCML_ELEMENT_ID_COUNT and up
+ * as they are encountered.
+ */
+enum srcml_element_id {
+
+    SRCML_ELEMENT_UNKNOWN = 0,
+
+    SRCML_SRC_UNIT,
+    SRCML_SRC_MACRO_LIST,
+    SRCML_SRC_ESCAPE,
+    SRCML_SRC_COMMENT,
+    SRCML_SRC_LITERAL,
+    SRCML_SRC_OPERATOR,
+    SRCML_SRC_MODIFIER,
+    SRCML_SRC_NAME,
+    SRCML_SRC_TYPE,
+    SRCML_SRC_CONDITION,
+    SRCML_SRC_BLOCK,
+    SRCML_SRC_INDEX,
+    SRCML_SRC_DECL,
+    SRCML_SRC_DECL_STMT,
+    SRCML_SRC_INIT,
+    SRCML_SRC_RANGE,
+    SRCML_SRC_ARGUMENT_LIST,
+    SRCML_SRC_ARGUMENT,
+    SRCML_SRC_PARAMETER_LIST,
+    SRCML_SRC_PARAM,
+    SRCML_SRC_PARAMETER,
+    SRCML_SRC_KRPARAMETER_LIST,
+    SRCML_SRC_KRPARAMETER,
+    SRCML_SRC_MEMBER_LIST,
+    SRCML_SRC_EXPR,
+    SRCML_SRC_EXPR_STMT,
+    SRCML_SRC_EMPTY_STMT,
+    SRCML_SRC_IF,
+    SRCML_SRC_THEN,
+    SRCML_SRC_ELSE,
+    SRCML_SRC_ELSEIF,
+    SRCML_SRC_WHILE,
+    SRCML_SRC_DO,
+    SRCML_SRC_FOR,
+    SRCML_SRC_FOREACH,
+    SRCML_SRC_CONTROL,
+    SRCML_SRC_INCR,
+    SRCML_SRC_SWITCH,
+    SRCML_SRC_CASE,
+    SRCML_SRC_DEFAULT,
+    SRCML_SRC_BREAK,
+    SRCML_SRC_CONTINUE,
+    SRCML_SRC_RETURN,
+    SRCML_SRC_GOTO,
+    SRCML_SRC_LABEL,
+    SRCML_SRC_TYPEDEF,
+    SRCML_SRC_ASM,
+    SRCML_SRC_MACRO,
+    SRCML_SRC_ENUM,
+    SRCML_SRC_FUNCTION,
+    SRCML_SRC_FUNCTION_DECL,
+    SRCML_SRC_SPECIFIER,
+    SRCML_SRC_STRUCT,
+    SRCML_SRC_STRUCT_DECL,
+    SRCML_SRC_UNION,
+    SRCML_SRC_UNION_DECL,
+    SRCML_SRC_CLASS,
+    SRCML_SRC_CLASS_DECL,
+    SRCML_SRC_PUBLIC,
+    SRCML_SRC_PRIVATE,
+    SRCML_SRC_PROTECTED,
+    SRCML_SRC_SIGNAL,
+    SRCML_SRC_FOREVER,
+    SRCML_SRC_EMIT,
+    SRCML_SRC_CONSTRUCTOR,
+    SRCML_SRC_CONSTRUCTOR_DECL,
+    SRCML_SRC_DESTRUCTOR,
+    SRCML_SRC_DESTRUCTOR_DECL,
+    SRCML_SRC_MEMBER_INIT_LIST,
+    SRCML_SRC_SUPER,
+    SRCML_SRC_CALL,
+    SRCML_SRC_TEMPLATE,
+    SRCML_SRC_TRY,
+    SRCML_SRC_CATCH,
+    SRCML_SRC_THROW,
+    SRCML_SRC_THROWS,
+    SRCML_SRC_FINALLY,
+    SRCML_SRC_EXTERN,
+    SRCML_SRC_NAMESPACE,
+    SRCML_SRC_USING,
+    SRCML_SRC_LAMBDA,
+    SRCML_SRC_SIZEOF,
+    SRCML_SRC_TYPEID,
+    SRCML_SRC_NOEXCEPT,
+    SRCML_SRC_DECLTYPE,
+    SRCML_SRC_ALIGNOF,
+    SRCML_SRC_ALIGNAS,
+    SRCML_SRC_TYPENAME,
+    SRCML_SRC_ATTRIBUTE,
+    SRCML_SRC_ANNOTATION,
+    SRCML_SRC_PACKAGE,
+    SRCML_SRC_IMPORT,
+    SRCML_SRC_INTERFACE,
+    SRCML_SRC_INTERFACE_DECL,
+    SRCML_SRC_STATIC,
+    SRCML_SRC_SYNCHRONIZED,
+    SRCML_SRC_ASSERT,
+    SRCML_SRC_LOCK,
+    SRCML_SRC_FIXED,
+    SRCML_SRC_CHECKED,
+    SRCML_SRC_UNCHECKED,
+    SRCML_SRC_UNSAFE,
+    SRCML_SRC_EVENT,
+    SRCML_SRC_PROPERTY,
+    SRCML_SRC_DELEGATE,
+    SRCML_SRC_USING_STMT,
+    SRCML_SRC_FRIEND,
+    SRCML_SRC_TERNARY,
+    SRCML_SRC_POSITION,
+    SRCML_CPP_DIRECTIVE,
+    SRCML_CPP_FILE,
+    SRCML_CPP_INCLUDE,
+    SRCML_CPP_DEFINE,
+    SRCML_CPP_UNDEF,
+    SRCML_CPP_LINE,
+    SRCML_CPP_IF,
+    SRCML_CPP_IFDEF,
+    SRCML_CPP_IFNDEF,
+    SRCML_CPP_ELSE,
+    SRCML_CPP_ELIF,
+    SRCML_CPP_ENDIF,
+    SRCML_CPP_THEN,
+    SRCML_CPP_PRAGMA,
+    SRCML_CPP_ERROR,
+    SRCML_CPP_WARNING,
+    SRCML_CPP_VALUE,
+    SRCML_CPP_NUMBER,
+    SRCML_CPP_LITERAL,
+    SRCML_CPP_MACRO,
+    SRCML_CPP_EMPTY,
+    SRCML_CPP_REGION,
+    SRCML_CPP_ENDREGION,
+    SRCML_CPP_IMPORT,
+    SRCML_CPP_MARK,
+
+    SRCML_ELEMENT_ID_COUNT
+
+};
+
+#endif
@@ -0,0 +1,205 @@
+/**
+ * @file srcml_element_stack.hpp
+ *
+ * @copyright Copyright (C) 2013-2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INCLUDED_SRCML_ELEMENT_STACK_HPP
+#define INCLUDED_SRCML_ELEMENT_STACK_HPP
+
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+/**
+ * srcml_element_name_stack
+ *
+ * Stack of open element qualified names (prefix:localname).
+ * Names are built in a bump arena of fixed blocks that is rewound on pop,
+ * so once the arena has grown to the document's depth push and pop do not allocate.
+ * Blocks never move, so pointers to names stay valid while the name is on the stack.
+ */
+struct srcml_element_name_stack {
+
+    /** minimum size of an arena block */
+    static const size_t BLOCK_SIZE = 4096;
+
+    /** default constructor */
+    srcml_element_name_stack() : names(), name_blocks(), blocks(), current_block(0), offset(0), max_size(0) {}
+
+    /** copy constructor, rebuild names in own arena */
+    srcml_element_name_stack(const srcml_element_name_stack & stack)
+        : names(), name_blocks(), blocks(), current_block(0), offset(0), max_size(0) {
+
+        for(std::vector<const char *>::const_iterator citr = stack.names.begin(); citr != stack.names.end(); ++citr)
+            push(0, 0, *citr, strlen(*citr));
+
+    }
+
+    /** Overloaded assignment operator */
+    srcml_element_name_stack & operator=(srcml_element_name_stack stack) {
+
+        names.swap(stack.names);
+        name_blocks.swap(stack.name_blocks);
+        blocks.swap(stack.blocks);
+        std::swap(current_block, stack.current_block);
+        std::swap(offset, stack.offset);
+        std::swap(max_size, stack.max_size);
+
+        return *this;
+
+    }
+
+    /**
+     * push
+     * @param prefix the prefix of the element to push
+     * @param localname the name of the element to push
+     *
+     * Push the element's qualified name on to the stack.
+     *
+     * @returns the qualified name.
+     */
+    const char * push(const char * prefix, const char * localname) {
+
+        return push(prefix, prefix ? strlen(prefix) : 0, localname, strlen(localname));
+
+    }
+
+    /**
+     * push
+     * @param prefix the prefix of the element to push
+     * @param prefix_length the length of the prefix
+     * @param localname the name of the element to push
+     * @param name_length the length of the name
+     *
+     * Push the element's qualified name on to the stack.
+     *
+     * @returns the qualified name.
+     */
+    const char * push(const char * prefix, size_t prefix_length, const char * localname, size_t name_length) {
+
+        size_t length = (prefix ? prefix_length + 1 : 0) + name_length + 1;
+
+        if(blocks.empty() || offset + length > blocks[current_block].size()) {
+
+            if(!blocks.empty()) ++current_block;
+            offset = 0;
+
+            // blocks above the current one hold no live names so can be reused/resized
+            if(current_block == blocks.size())
+                blocks.push_back(std::vector<char>(std::max(length, (size_t)BLOCK_SIZE)));
+            else if(blocks[current_block].size() < length)
+                blocks[current_block].resize(length);
+
+        }
+
+        char * name = &blocks[current_block][offset];
+
+        char * pos = name;
+        if(prefix) {
+
+            memcpy(pos, prefix, prefix_length);
+            pos += prefix_length;
+            *pos++ = ':';
+
+        }
+
+        memcpy(pos, localname, name_length);
+        pos[name_length] = '\0';
+
+        offset += length;
+
+        names.push_back(name);
+        name_blocks.push_back(current_block);
+
+        if(names.size() > max_size) max_size = names.size();
+
+        return name;
+
+    }
+
+    /**
+     * pop
+     *
+     * Pop an element off the stack rewinding the arena.
+     */
+    void pop() {
+
+        if(names.empty()) return;
+
+        current_block = name_blocks.back();
+        offset = names.back() - &blocks[current_block].front();
+
+        names.pop_back();
+        name_blocks.pop_back();
+
+    }
+
+    /**
+     * size
+     *
+     * @returns the number of open elements.
+     */
+    size_t size() const {
+
+        return names.size();
+
+    }
+
+    /**
+     * empty
+     *
+     * @returns if there are no open elements.
+     */
+    bool empty() const {
+
+        return names.empty();
+
+    }
+
+    /**
+     * data
+     *
+     * @returns the array of open element names (bottom first), 0 if empty.
+     */
+    const char ** data() {
+
+        return names.empty() ? 0 : &names.front();
+
+    }
+
+    /** open element names */
+    std::vector<const char *> names;
+
+    /** arena block of each open element name */
+    std::vector<size_t> name_blocks;
+
+    /** arena blocks */
+    std::vector<std::vector<char> > blocks;
+
+    /** block currently being filled */
+    size_t current_block;
+
+    /** next free position in the current block */
+    size_t offset;
+
+    /** largest number of open elements */
+    size_t max_size;
+
+};
+
+#endif
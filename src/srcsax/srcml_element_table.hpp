@@ -0,0 +1,262 @@
+/**
+ * @file srcml_element_table.hpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcML SAX2 Framework.
+ *
+ * The srcML SAX2 Framework is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML SAX2 Framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML SAX2 Framework; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INCLUDED_SRCML_ELEMENT_TABLE_HPP
+#define INCLUDED_SRCML_ELEMENT_TABLE_HPP
+
+#include <srcml_element_id.h>
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+
+/**
+ * srcml_element_namespace
+ *
+ * Namespaces of the known srcML elements.
+ */
+enum srcml_element_namespace {
+
+    SRCML_NAMESPACE_SRC,
+    SRCML_NAMESPACE_CPP,
+    SRCML_NAMESPACE_OTHER
+
+};
+
+/**
+ * srcml_element_kind
+ *
+ * Structural kinds of elements.  Units and macro lists are recognized by
+ * name in any namespace, as before elements were interned.
+ */
+enum srcml_element_kind {
+
+    SRCML_KIND_ELEMENT,
+    SRCML_KIND_UNIT,
+    SRCML_KIND_MACRO_LIST
+
+};
+
+/**
+ * srcml_element_id_known
+ * @param ns the srcml_element_namespace of the element
+ * @param localname the name of the element
+ *
+ * Perfect hash lookup of a known srcML element.
+ *
+ * @returns the element's ID or SRCML_ELEMENT_UNKNOWN if not a known srcML element.
+ */
+int srcml_element_id_known(int ns, const char * localname);
+
+/**
+ * srcml_element_id_known_name
+ * @param id a known srcML element ID
+ *
+ * @returns the localname of the known element or 0 if not a known ID.
+ */
+const char * srcml_element_id_known_name(int id);
+
+/**
+ * srcml_element_table
+ *
+ * Interns element names to small integer IDs.  Known srcML elements use
+ * their fixed srcml_element_id, any other element is given the next free
+ * ID the first time it is seen.  libxml2 names and URIs are dictionary strings,
+ * so lookups of already seen elements are by pointer.
+ */
+struct srcml_element_table {
+
+    /** default constructor */
+    srcml_element_table() : src_uri(0), cpp_uri(0), other_uri(0), pointer_ids(), name_ids(), names(), kinds() {}
+
+    /**
+     * uri_namespace
+     * @param URI the namespace URI of an element
+     *
+     * Classify a namespace URI, remembering the last URI of each kind.
+     *
+     * @returns the srcml_element_namespace of the URI.
+     */
+    int uri_namespace(const char * URI) {
+
+        if(URI == 0 || URI == src_uri) return SRCML_NAMESPACE_SRC;
+        if(URI == cpp_uri) return SRCML_NAMESPACE_CPP;
+        if(URI == other_uri) return SRCML_NAMESPACE_OTHER;
+
+        static const char SRC_SUFFIX[] = "/srcML/src";
+        static const char CPP_SUFFIX[] = "/srcML/cpp";
+        static const size_t SUFFIX_LENGTH = sizeof(SRC_SUFFIX) - 1;
+
+        size_t length = strlen(URI);
+        if(length >= SUFFIX_LENGTH && memcmp(URI + length - SUFFIX_LENGTH, SRC_SUFFIX, SUFFIX_LENGTH) == 0) {
+
+            src_uri = URI;
+            return SRCML_NAMESPACE_SRC;
+
+        }
+
+        if(length >= SUFFIX_LENGTH && memcmp(URI + length - SUFFIX_LENGTH, CPP_SUFFIX, SUFFIX_LENGTH) == 0) {
+
+            cpp_uri = URI;
+            return SRCML_NAMESPACE_CPP;
+
+        }
+
+        other_uri = URI;
+        return SRCML_NAMESPACE_OTHER;
+
+    }
+
+    /**
+     * intern
+     * @param localname the name of the element
+     * @param URI the namespace of the element
+     *
+     * Get the ID of an element, assigning a new one for
+     * elements outside of the srcML vocabulary.
+     *
+     * @returns the ID of the element.
+     */
+    int intern(const char * localname, const char * URI) {
+
+        if(localname == 0) return SRCML_ELEMENT_UNKNOWN;
+
+        int id = srcml_element_id_known(uri_namespace(URI), localname);
+        if(id != SRCML_ELEMENT_UNKNOWN) return id;
+
+        std::pair<const char *, const char *> key(localname, URI);
+        std::map<std::pair<const char *, const char *>, int>::const_iterator citr = pointer_ids.find(key);
+        if(citr != pointer_ids.end()) return citr->second;
+
+        std::string name;
+        if(URI) {
+
+            name += '{';
+            name += URI;
+            name += '}';
+
+        }
+        name += localname;
+
+        std::map<std::string, int>::const_iterator name_itr = name_ids.find(name);
+        if(name_itr != name_ids.end()) {
+
+            id = name_itr->second;
+
+        } else {
+
+            id = SRCML_ELEMENT_ID_COUNT + (int)names.size();
+            name_ids.insert(std::make_pair(name, id));
+            names.push_back(localname);
+
+            if(strcmp(localname, "unit") == 0)
+                kinds.push_back(SRCML_KIND_UNIT);
+            else if(strcmp(localname, "macro-list") == 0)
+                kinds.push_back(SRCML_KIND_MACRO_LIST);
+            else
+                kinds.push_back(SRCML_KIND_ELEMENT);
+
+        }
+
+        pointer_ids.insert(std::make_pair(key, id));
+
+        return id;
+
+    }
+
+    /**
+     * reset_pointers
+     *
+     * Forget the lookups by libxml2 string pointer, e.g., before parsing another
+     * document whose strings may reuse the addresses.  Assigned IDs are kept.
+     */
+    void reset_pointers() {
+
+        src_uri = 0;
+        cpp_uri = 0;
+        other_uri = 0;
+        pointer_ids.clear();
+
+    }
+
+    /**
+     * name
+     * @param id an element ID
+     *
+     * @returns the localname of the element with the ID or 0 if not assigned.
+     */
+    const char * name(int id) const {
+
+        if(id < SRCML_ELEMENT_ID_COUNT) return srcml_element_id_known_name(id);
+
+        size_t pos = id - SRCML_ELEMENT_ID_COUNT;
+        if(pos >= names.size()) return 0;
+
+        return names[pos].c_str();
+
+    }
+
+    /**
+     * kind
+     * @param id an element ID
+     *
+     * @returns the srcml_element_kind of the element with the ID.
+     */
+    int kind(int id) const {
+
+        if(id == SRCML_SRC_UNIT) return SRCML_KIND_UNIT;
+        if(id == SRCML_SRC_MACRO_LIST) return SRCML_KIND_MACRO_LIST;
+        if(id < SRCML_ELEMENT_ID_COUNT) return SRCML_KIND_ELEMENT;
+
+        size_t pos = id - SRCML_ELEMENT_ID_COUNT;
+        if(pos >= kinds.size()) return SRCML_KIND_ELEMENT;
+
+        return kinds[pos];
+
+    }
+
+    /** last seen srcML src namespace URI */
+    const char * src_uri;
+
+    /** last seen srcML cpp namespace URI */
+    const char * cpp_uri;
+
+    /** last seen non-srcML namespace URI */
+    const char * other_uri;
+
+    /** IDs of non-srcML elements by (localname, URI) pointer */
+    std::map<std::pair<const char *, const char *>, int> pointer_ids;
+
+    /** IDs of non-srcML elements by {URI}localname */
+    std::map<std::string, int> name_ids;
+
+    /** localnames of non-srcML elements by ID - SRCML_ELEMENT_ID_COUNT */
+    std::vector<std::string> names;
+
+    /** srcml_element_kind of non-srcML elements by ID - SRCML_ELEMENT_ID_COUNT */
+    std::vector<char> kinds;
+
+};
+
+#endif
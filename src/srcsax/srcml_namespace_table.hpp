@@ -0,0 +1,104 @@
+/**
+ * @file srcml_namespace_table.hpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcML SAX2 Framework.
+ *
+ * The srcML SAX2 Framework is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML SAX2 Framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML SAX2 Framework; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INCLUDED_SRCML_NAMESPACE_TABLE_HPP
+#define INCLUDED_SRCML_NAMESPACE_TABLE_HPP
+
+#include <libxml/parser.h>
+
+#include <utility>
+#include <vector>
+
+/**
+ * srcml_namespace_table
+ *
+ * Resolves element prefixes and URIs to the root element's copies.  libxml2
+ * provides prefixes and URIs as dictionary strings, so equal strings share
+ * a pointer within a parse and are resolved by pointer identity alone.  The
+ * resolved pointers are stable for the whole parse, so handlers can compare
+ * namespaces by pointer.
+ */
+struct srcml_namespace_table {
+
+    /** default constructor */
+    srcml_namespace_table() : prefixes(), uris() {}
+
+    /**
+     * build
+     * @param nb_namespaces number of namespaces definitions of the root
+     * @param namespaces the root's namespaces as provided by libxml2 (prefix/URI pairs)
+     * @param root_namespaces the root's owned copies of the namespaces
+     *
+     * Build the table from the namespaces defined on the root element.
+     */
+    void build(int nb_namespaces, const xmlChar ** namespaces, const xmlChar ** root_namespaces) {
+
+        prefixes.clear();
+        uris.clear();
+
+        for(int i = 0; i < nb_namespaces * 2; i += 2) {
+
+            if(namespaces[i]) prefixes.push_back(std::make_pair(namespaces[i], root_namespaces[i]));
+            if(namespaces[i + 1]) uris.push_back(std::make_pair(namespaces[i + 1], root_namespaces[i + 1]));
+
+        }
+
+    }
+
+    /**
+     * resolve
+     * @param prefix the element prefix, replaced by the root's copy if a root namespace
+     * @param URI the element URI, replaced by the root's copy if a root namespace
+     *
+     * Resolve an element's prefix and URI.
+     */
+    void resolve(const xmlChar *& prefix, const xmlChar *& URI) const {
+
+        if(prefix)
+            for(std::vector<std::pair<const xmlChar *, const xmlChar *> >::const_iterator citr = prefixes.begin(); citr != prefixes.end(); ++citr)
+                if(citr->first == prefix) {
+
+                    prefix = citr->second;
+                    break;
+
+                }
+
+        if(URI)
+            for(std::vector<std::pair<const xmlChar *, const xmlChar *> >::const_iterator citr = uris.begin(); citr != uris.end(); ++citr)
+                if(citr->first == URI) {
+
+                    URI = citr->second;
+                    break;
+
+                }
+
+    }
+
+    /** root prefixes by libxml2 dictionary pointer */
+    std::vector<std::pair<const xmlChar *, const xmlChar *> > prefixes;
+
+    /** root URIs by libxml2 dictionary pointer */
+    std::vector<std::pair<const xmlChar *, const xmlChar *> > uris;
+
+};
+
+#endif
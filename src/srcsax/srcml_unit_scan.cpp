@@ -0,0 +1,457 @@
+/**
+ * @file srcml_unit_scan.cpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcML SAX2 Framework.
+ *
+ * The srcML SAX2 Framework is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML SAX2 Framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML SAX2 Framework; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <srcml_unit_scan.hpp>
+
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * starts_with
+ * @param pos current position
+ * @param end end of the document
+ * @param prefix string to match
+ *
+ * @returns if the document at pos starts with prefix.
+ */
+static inline bool starts_with(const char * pos, const char * end, const char * prefix) {
+
+    size_t length = strlen(prefix);
+
+    return (size_t)(end - pos) >= length && memcmp(pos, prefix, length) == 0;
+
+}
+
+/**
+ * find
+ * @param pos current position
+ * @param end end of the document
+ * @param pattern string to find
+ *
+ * @returns the position of the first occurence of pattern or 0 if not found.
+ */
+static const char * find(const char * pos, const char * end, const char * pattern) {
+
+    while(pos < end) {
+
+        pos = (const char *)memchr(pos, pattern[0], end - pos);
+        if(pos == 0) return 0;
+
+        if(starts_with(pos, end, pattern)) return pos;
+
+        ++pos;
+
+    }
+
+    return 0;
+
+}
+
+/**
+ * tag_end
+ * @param pos the start of a tag ('<')
+ * @param end end of the document
+ *
+ * Find the end of a start tag skipping quoted attribute values.
+ *
+ * @returns the position of the closing '>' or 0 if not found.
+ */
+static const char * tag_end(const char * pos, const char * end) {
+
+    for(++pos; pos < end; ++pos) {
+
+        if(*pos == '>') return pos;
+
+        if(*pos == '"' || *pos == '\'') {
+
+            pos = (const char *)memchr(pos + 1, *pos, end - pos - 1);
+            if(pos == 0) return 0;
+
+        }
+
+    }
+
+    return 0;
+
+}
+
+/**
+ * tag_name
+ * @param pos the start of a tag ('<')
+ * @param end end of the tag
+ *
+ * @returns the qualified name of the tag.
+ */
+static std::string tag_name(const char * pos, const char * end) {
+
+    const char * name = pos + 1;
+    const char * name_end = name;
+    while(name_end < end && *name_end != ' ' && *name_end != '\t' && *name_end != '\n' && *name_end != '\r'
+          && *name_end != '/' && *name_end != '>')
+        ++name_end;
+
+    return std::string(name, name_end - name);
+
+}
+
+/**
+ * tag_is
+ * @param pos the start of a tag ('<')
+ * @param end end of the tag
+ * @param qname a qualified name
+ *
+ * @returns if the tag has the qualified name.
+ */
+static inline bool tag_is(const char * pos, const char * end, const std::string & qname) {
+
+    const char * name_end = pos + 1 + qname.size();
+    if(name_end > end || memcmp(pos + 1, qname.data(), qname.size()) != 0) return false;
+
+    return *name_end == ' ' || *name_end == '\t' || *name_end == '\n' || *name_end == '\r' || *name_end == '/' || *name_end == '>';
+
+}
+
+/**
+ * srcml_scan_document
+ * @param buffer the srcML document
+ * @param size the size of the document in bytes
+ * @param scan the scan result
+ *
+ * Scan the markup of a srcML archive, without full XML parsing, for the root start tag
+ * and the boundaries of its unit children.  Only ASCII compatible encodings without
+ * a DOCTYPE are scanned, and only meta tags may precede the units.
+ *
+ * @returns true if the document is an archive with at least one unit and could be scanned.
+ */
+bool srcml_scan_document(const char * buffer, size_t size, srcml_document_scan & scan) {
+
+    scan = srcml_document_scan();
+
+    const char * pos = buffer;
+    const char * end = buffer + size;
+
+    if(starts_with(pos, end, "\xEF\xBB\xBF")) pos += 3;
+
+    // UTF-16/UCS-4 and EBCDIC documents are left to libxml2
+    if(end - pos < 4 || pos[0] == '\0' || pos[1] == '\0' || (unsigned char)pos[0] >= 0x80) return false;
+
+    // prolog
+    while(true) {
+
+        pos = (const char *)memchr(pos, '<', end - pos);
+        if(pos == 0 || end - pos < 2) return false;
+
+        if(starts_with(pos, end, "<?")) {
+
+            const char * pi_end = find(pos, end, "?>");
+            if(pi_end == 0) return false;
+
+            if(starts_with(pos, end, "<?xml ")) {
+
+                scan.declaration_offset = pos - buffer;
+                scan.declaration_length = pi_end + 2 - pos;
+
+            }
+
+            pos = pi_end + 2;
+
+        } else if(starts_with(pos, end, "<!--")) {
+
+            const char * comment_end = find(pos, end, "-->");
+            if(comment_end == 0) return false;
+
+            pos = comment_end + 3;
+
+        } else if(pos[1] == '!') {
+
+            // DOCTYPE may declare entities needed by every unit
+            return false;
+
+        } else
+            break;
+
+    }
+
+    // root start tag
+    const char * root_end = tag_end(pos, end);
+    if(root_end == 0 || root_end[-1] == '/') return false;
+
+    scan.root_offset = pos - buffer;
+    scan.root_length = root_end + 1 - pos;
+    scan.root_qname = tag_name(pos, root_end);
+
+    pos = root_end + 1;
+
+    size_t gap_offset = pos - buffer;
+    int depth = 0;
+    bool in_unit = false;
+    srcml_unit_range unit = srcml_unit_range();
+
+    while(true) {
+
+        pos = (const char *)memchr(pos, '<', end - pos);
+        if(pos == 0 || end - pos < 2) return false;
+
+        if(starts_with(pos, end, "<!--")) {
+
+            const char * comment_end = find(pos, end, "-->");
+            if(comment_end == 0) return false;
+
+            pos = comment_end + 3;
+            continue;
+
+        }
+
+        if(starts_with(pos, end, "<![CDATA[")) {
+
+            const char * cdata_end = find(pos, end, "]]>");
+            if(cdata_end == 0) return false;
+
+            pos = cdata_end + 3;
+            continue;
+
+        }
+
+        if(starts_with(pos, end, "<?")) {
+
+            const char * pi_end = find(pos, end, "?>");
+            if(pi_end == 0) return false;
+
+            pos = pi_end + 2;
+            continue;
+
+        }
+
+        if(pos[1] == '!') return false;
+
+        if(pos[1] == '/') {
+
+            const char * element_end = (const char *)memchr(pos, '>', end - pos);
+            if(element_end == 0) return false;
+
+            if(depth == 0) {
+
+                scan.root_end_offset = pos - buffer;
+                break;
+
+            }
+
+            --depth;
+            if(depth == 0 && in_unit) {
+
+                unit.length = (element_end + 1 - buffer) - unit.offset;
+                scan.units.push_back(unit);
+                in_unit = false;
+                gap_offset = element_end + 1 - buffer;
+
+            }
+
+            pos = element_end + 1;
+            continue;
+
+        }
+
+        const char * element_end = tag_end(pos, end);
+        if(element_end == 0) return false;
+
+        bool is_empty = element_end[-1] == '/';
+
+        if(depth == 0) {
+
+            if(tag_is(pos, element_end, scan.root_qname)) {
+
+                unit.offset = pos - buffer;
+                unit.start_tag_length = element_end + 1 - pos;
+                unit.gap_offset = gap_offset;
+
+                if(is_empty) {
+
+                    unit.length = unit.start_tag_length;
+                    scan.units.push_back(unit);
+                    gap_offset = element_end + 1 - buffer;
+
+                } else
+                    in_unit = true;
+
+            } else if(!scan.units.empty()) {
+
+                // only meta tags preceding the units are supported
+                return false;
+
+            }
+
+        }
+
+        if(!is_empty) ++depth;
+
+        pos = element_end + 1;
+
+    }
+
+    return !scan.units.empty();
+
+}
+
+/**
+ * is_space
+ * @param c a character
+ *
+ * @returns if the character is XML whitespace.
+ */
+static inline bool is_space(char c) {
+
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+
+}
+
+/**
+ * append_utf8
+ * @param value the string to append to
+ * @param code_point a unicode code point
+ *
+ * Append the UTF-8 encoding of a code point.
+ */
+static void append_utf8(std::string & value, unsigned long code_point) {
+
+    if(code_point < 0x80) {
+
+        value += (char)code_point;
+
+    } else if(code_point < 0x800) {
+
+        value += (char)(0xC0 | (code_point >> 6));
+        value += (char)(0x80 | (code_point & 0x3F));
+
+    } else if(code_point < 0x10000) {
+
+        value += (char)(0xE0 | (code_point >> 12));
+        value += (char)(0x80 | ((code_point >> 6) & 0x3F));
+        value += (char)(0x80 | (code_point & 0x3F));
+
+    } else {
+
+        value += (char)(0xF0 | (code_point >> 18));
+        value += (char)(0x80 | ((code_point >> 12) & 0x3F));
+        value += (char)(0x80 | ((code_point >> 6) & 0x3F));
+        value += (char)(0x80 | (code_point & 0x3F));
+
+    }
+
+}
+
+/**
+ * unescape
+ * @param pos start of an attribute value
+ * @param end end of the attribute value
+ *
+ * @returns the attribute value with character and predefined entity references replaced.
+ */
+static std::string unescape(const char * pos, const char * end) {
+
+    std::string value;
+    value.reserve(end - pos);
+
+    while(pos < end) {
+
+        const char * reference = (const char *)memchr(pos, '&', end - pos);
+        if(reference == 0) reference = end;
+
+        value.append(pos, reference - pos);
+        if(reference == end) break;
+
+        const char * reference_end = (const char *)memchr(reference, ';', end - reference);
+        if(reference_end == 0) {
+
+            value.append(reference, end - reference);
+            break;
+
+        }
+
+        std::string name(reference + 1, reference_end - reference - 1);
+        if(name == "lt") value += '<';
+        else if(name == "gt") value += '>';
+        else if(name == "amp") value += '&';
+        else if(name == "quot") value += '"';
+        else if(name == "apos") value += '\'';
+        else if(name.size() > 2 && name[0] == '#' && name[1] == 'x') append_utf8(value, strtoul(name.c_str() + 2, 0, 16));
+        else if(name.size() > 1 && name[0] == '#') append_utf8(value, strtoul(name.c_str() + 1, 0, 10));
+        else value.append(reference, reference_end + 1 - reference);
+
+        pos = reference_end + 1;
+
+    }
+
+    return value;
+
+}
+
+/**
+ * srcml_tag_attribute
+ * @param tag the start of a start tag ('<')
+ * @param length the length of the start tag
+ * @param qname the qualified name of the attribute
+ * @param value the attribute value with character and predefined entity references replaced
+ *
+ * @returns if the start tag has the attribute.
+ */
+bool srcml_tag_attribute(const char * tag, size_t length, const char * qname, std::string & value) {
+
+    const char * end = tag + length;
+    size_t qname_length = strlen(qname);
+
+    // skip the element name
+    const char * pos = tag + 1;
+    while(pos < end && !is_space(*pos) && *pos != '/' && *pos != '>')
+        ++pos;
+
+    while(true) {
+
+        while(pos < end && is_space(*pos))
+            ++pos;
+
+        if(pos >= end || *pos == '/' || *pos == '>') return false;
+
+        const char * name = pos;
+        while(pos < end && !is_space(*pos) && *pos != '=')
+            ++pos;
+        const char * name_end = pos;
+
+        while(pos < end && (is_space(*pos) || *pos == '='))
+            ++pos;
+
+        if(pos >= end || (*pos != '"' && *pos != '\'')) return false;
+
+        const char * value_end = (const char *)memchr(pos + 1, *pos, end - pos - 1);
+        if(value_end == 0) return false;
+
+        if((size_t)(name_end - name) == qname_length && memcmp(name, qname, qname_length) == 0) {
+
+            value = unescape(pos + 1, value_end);
+            return true;
+
+        }
+
+        pos = value_end + 1;
+
+    }
+
+}
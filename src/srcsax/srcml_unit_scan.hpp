@@ -0,0 +1,111 @@
+/**
+ * @file srcml_unit_scan.hpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcML SAX2 Framework.
+ *
+ * The srcML SAX2 Framework is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML SAX2 Framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML SAX2 Framework; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INCLUDED_SRCML_UNIT_SCAN_HPP
+#define INCLUDED_SRCML_UNIT_SCAN_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/**
+ * srcml_unit_range
+ *
+ * Location of a top-level unit in a srcML archive.
+ * All offsets are byte offsets into the scanned document.
+ */
+struct srcml_unit_range {
+
+    /** offset of the unit start tag */
+    size_t offset;
+
+    /** length of the unit from its start tag to the end of its end tag */
+    size_t length;
+
+    /** length of the unit start tag */
+    size_t start_tag_length;
+
+    /** offset of the root level content preceding the unit (end of previous unit or root start tag) */
+    size_t gap_offset;
+
+};
+
+/**
+ * srcml_document_scan
+ *
+ * Result of scanning a srcML archive for its top-level units.
+ */
+struct srcml_document_scan {
+
+    /** default constructor */
+    srcml_document_scan() : declaration_offset(0), declaration_length(0), root_offset(0), root_length(0),
+                            root_end_offset(0), root_qname(), units() {}
+
+    /** offset of the XML declaration */
+    size_t declaration_offset;
+
+    /** length of the XML declaration, 0 if none */
+    size_t declaration_length;
+
+    /** offset of the root start tag */
+    size_t root_offset;
+
+    /** length of the root start tag */
+    size_t root_length;
+
+    /** offset of the root end tag */
+    size_t root_end_offset;
+
+    /** qualified name of the root (and unit) element */
+    std::string root_qname;
+
+    /** the top-level units in document order */
+    std::vector<srcml_unit_range> units;
+
+};
+
+/**
+ * srcml_scan_document
+ * @param buffer the srcML document
+ * @param size the size of the document in bytes
+ * @param scan the scan result
+ *
+ * Scan the markup of a srcML archive, without full XML parsing, for the root start tag
+ * and the boundaries of its unit children.  Only ASCII compatible encodings without
+ * a DOCTYPE are scanned, and only meta tags may precede the units.
+ *
+ * @returns true if the document is an archive with at least one unit and could be scanned.
+ */
+bool srcml_scan_document(const char * buffer, size_t size, srcml_document_scan & scan);
+
+/**
+ * srcml_tag_attribute
+ * @param tag the start of a start tag ('<')
+ * @param length the length of the start tag
+ * @param qname the qualified name of the attribute
+ * @param value the attribute value with character and predefined entity references replaced
+ *
+ * @returns if the start tag has the attribute.
+ */
+bool srcml_tag_attribute(const char * tag, size_t length, const char * qname, std::string & value);
+
+#endif
@@ -21,6 +21,7 @@
 #define INCLUDED_SRCSAX_H
 
 #include <srcsax_handler.h>
+#include <srcml_element_id.h>
 
 #include <libxml/parser.h>
 
@@ -59,6 +60,9 @@ struct srcsax_context {
     /** the xml documents encoding */
     const char * encoding;
 
+    /** interned ID (srcml_element_id) of the element of the current element callback */
+    int element_id;
+
     /* Internal context handling NOT FOR PUBLIC USE */
 
     /** xml parser input buffer */
@@ -73,15 +77,207 @@ struct srcsax_context {
     /** indicate stop parser */
     int terminate;
 
+    /** element ID table of the current parse */
+    void * element_table;
+
+    /** memory mapping of the input file, 0 if not mapped */
+    void * mapping;
+
+    /** size of the memory mapping */
+    size_t mapping_size;
+
+    /** original bytes of a memory or memory mapped input, 0 if not available */
+    const char * source;
+
+    /** size of the original input */
+    size_t source_size;
+
+    /** parse state of a push context kept between chunks, 0 if not a push context */
+    void * push_state;
+
+    /** subscribed elements, 0 to receive all elements */
+    void * element_filter;
+
+    /** statistics collection, 0 if not enabled */
+    void * stats;
+
+    /** parse state of srcsax_parse kept for reuse by a reset context */
+    void * parse_state;
+
+    /** deliver function headers with start_function/end_function */
+    int parse_function;
+
+    /** deliver each text run in a unit with one characters_unit callback */
+    int coalesce_characters;
+
+};
+
+/**
+ * srcsax_context_pool
+ *
+ * Thread-safe pool of reusable srcSAX contexts (opaque).
+ */
+struct srcsax_context_pool;
+
+/**
+ * srcsax_stats
+ *
+ * Statistics of the parses of a context, collected once enabled
+ * with srcsax_enable_stats.
+ */
+struct srcsax_stats {
+
+    /** number of start_document callbacks */
+    size_t start_document;
+
+    /** number of end_document callbacks */
+    size_t end_document;
+
+    /** number of start_root callbacks */
+    size_t start_root;
+
+    /** number of start_unit callbacks */
+    size_t start_unit;
+
+    /** number of start_element callbacks */
+    size_t start_element;
+
+    /** number of end_root callbacks */
+    size_t end_root;
+
+    /** number of end_unit callbacks */
+    size_t end_unit;
+
+    /** number of end_element callbacks */
+    size_t end_element;
+
+    /** number of characters_root callbacks */
+    size_t characters_root;
+
+    /** number of characters_unit callbacks */
+    size_t characters_unit;
+
+    /** number of meta_tag callbacks */
+    size_t meta_tag;
+
+    /** number of comment callbacks */
+    size_t comment;
+
+    /** number of cdata_block callbacks */
+    size_t cdata_block;
+
+    /** number of processing_instruction callbacks */
+    size_t processing_instruction;
+
+    /** number of start_function callbacks */
+    size_t start_function;
+
+    /** number of end_function callbacks */
+    size_t end_function;
+
+    /** bytes of input consumed by the parser */
+    size_t bytes_consumed;
+
+    /** maximum size of the srcML element stack */
+    size_t max_stack_depth;
+
+    /** allocations of the marshalling layer (conversion buffer growth and saved element copies) */
+    size_t marshal_allocations;
+
+    /** seconds spent in the handler callbacks, 0 if not timed */
+    double callback_time;
+
+    /** seconds spent parsing outside of the handler callbacks, 0 if not timed */
+    double parser_time;
+
+    /** units parsed per second, 0 if not timed */
+    double units_per_second;
+
+};
+
+/**
+ * srcsax_unit_index_entry
+ *
+ * Location and key attributes of a unit in a srcML archive.
+ */
+struct srcsax_unit_index_entry {
+
+    /** byte offset of the unit start tag */
+    size_t offset;
+
+    /** byte length of the unit */
+    size_t length;
+
+    /** the unit filename attribute, 0 if none */
+    char * filename;
+
+    /** the unit hash attribute, 0 if none */
+    char * hash;
+
+    /** the unit language attribute, 0 if none */
+    char * language;
+
+};
+
+/**
+ * srcsax_unit_index
+ *
+ * Index of the units of a srcML archive for random access.
+ */
+struct srcsax_unit_index {
+
+    /** size in bytes of the indexed archive */
+    size_t archive_size;
+
+    /** byte offset of the XML declaration */
+    size_t declaration_offset;
+
+    /** byte length of the XML declaration, 0 if none */
+    size_t declaration_length;
+
+    /** byte offset of the root start tag */
+    size_t root_offset;
+
+    /** byte length of the root start tag */
+    size_t root_length;
+
+    /** byte length of the root level content (meta tags) between the root start tag and the first unit */
+    size_t header_length;
+
+    /** qualified name of the root element */
+    char * root_qname;
+
+    /** number of units */
+    size_t unit_count;
+
+    /** the units in document order */
+    struct srcsax_unit_index_entry * units;
+
 };
 
 /* srcSAX context creation/open functions */
 struct srcsax_context * srcsax_create_context_filename(const char * filename, const char * encoding);
 struct srcsax_context * srcsax_create_context_memory(const char * buffer, size_t buffer_size, const char * encoding);
+struct srcsax_context * srcsax_create_context_mmap(const char * filename, const char * encoding);
 struct srcsax_context * srcsax_create_context_FILE(FILE * srcml_file, const char * encoding);
 struct srcsax_context * srcsax_create_context_fd(int srcml_fd, const char * encoding);
 struct srcsax_context * srcsax_create_context_io(void * srcml_context, int (*read_callback)(void * context, char * buffer, int len), int (*close_callback)(void * context), const char * encoding);
 struct srcsax_context * srcsax_create_context_parser_input_buffer(xmlParserInputBufferPtr input);
+struct srcsax_context * srcsax_create_push_context(const char * encoding);
+struct srcsax_context * srcsax_create_context_unit(const char * filename, const struct srcsax_unit_index * index, size_t first, size_t last, const char * encoding);
+
+/* srcSAX context reuse functions */
+int srcsax_reset_context(struct srcsax_context * context, xmlParserInputBufferPtr input);
+int srcsax_reset_context_memory(struct srcsax_context * context, const char * buffer, size_t buffer_size, const char * encoding);
+int srcsax_reset_context_filename(struct srcsax_context * context, const char * filename, const char * encoding);
+
+/* srcSAX context pool functions */
+struct srcsax_context_pool * srcsax_create_context_pool(size_t max_idle);
+void srcsax_free_context_pool(struct srcsax_context_pool * pool);
+struct srcsax_context * srcsax_context_pool_acquire_memory(struct srcsax_context_pool * pool, const char * buffer, size_t buffer_size, const char * encoding);
+struct srcsax_context * srcsax_context_pool_acquire_filename(struct srcsax_context_pool * pool, const char * filename, const char * encoding);
+void srcsax_context_pool_release(struct srcsax_context_pool * pool, struct srcsax_context * context);
+size_t srcsax_context_pool_idle(struct srcsax_context_pool * pool);
 
 /* srcSAX free function */
 void srcsax_free_context(struct srcsax_context * context);
@@ -89,10 +285,50 @@ void srcsax_free_context(struct srcsax_context * context);
 /* srcSAX parse function */
 int srcsax_parse(struct srcsax_context * context);
 int srcsax_parse_handler(struct srcsax_context * context, struct srcsax_handler * handler);
+int srcsax_parse_parallel(struct srcsax_context * context, int thread_count, void ** thread_data, int ordered);
+int srcsax_parse_chunk(struct srcsax_context * context, const char * chunk, size_t size, int is_last);
 
 /* srcSAX terminate parse function */
 void srcsax_stop_parser(struct srcsax_context * context);
 
+/* srcSAX skip subtree function */
+int srcsax_skip_subtree(struct srcsax_context * context);
+
+/* srcSAX input position functions */
+long srcsax_current_offset(struct srcsax_context * context);
+int srcsax_current_position(struct srcsax_context * context, int * line, int * column);
+
+/* srcSAX root element functions */
+const struct srcsax_namespace * srcsax_get_root_namespaces(struct srcsax_context * context, int * num_namespaces);
+const struct srcsax_attribute * srcsax_get_root_attributes(struct srcsax_context * context, int * num_attributes);
+
+/* srcSAX function header functions */
+int srcsax_enable_function(struct srcsax_context * context, int enable);
+
+/* srcSAX text coalescing function */
+int srcsax_enable_coalescing(struct srcsax_context * context, int enable);
+
+/* srcSAX element subscription functions */
+int srcsax_subscribe_element(struct srcsax_context * context, const char * qname);
+int srcsax_subscribe_element_id(struct srcsax_context * context, int element_id);
+void srcsax_clear_subscriptions(struct srcsax_context * context);
+
+/* srcSAX statistics functions */
+int srcsax_enable_stats(struct srcsax_context * context, int timing);
+void srcsax_disable_stats(struct srcsax_context * context);
+int srcsax_get_stats(const struct srcsax_context * context, struct srcsax_stats * stats);
+
+/* srcSAX unit index functions */
+struct srcsax_unit_index * srcsax_create_unit_index(const char * filename);
+struct srcsax_unit_index * srcsax_create_unit_index_memory(const char * buffer, size_t buffer_size);
+int srcsax_write_unit_index(const struct srcsax_unit_index * index, const char * index_filename);
+struct srcsax_unit_index * srcsax_read_unit_index(const char * index_filename);
+long srcsax_find_unit(const struct srcsax_unit_index * index, const char * filename);
+void srcsax_free_unit_index(struct srcsax_unit_index * index);
+
+/* srcSAX element ID lookup function */
+const char * srcsax_element_name(struct srcsax_context * context, int element_id);
+
 #ifdef __cplusplus
 }
 #endif
@@ -18,11 +18,27 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 #include <srcsax.h>
+#include <srcsax_writer.h>
 #include <sax2_srcsax_handler.hpp>
+#include <srcsax_parallel.hpp>
+#include <srcml_unit_scan.hpp>
+#include <srcsax_stats.hpp>
 
 #include <libxml/parserInternals.h>
 
+#include <climits>
+#include <cstdio>
 #include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#ifndef _MSC_BUILD
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 /** 
  * libxml_error
@@ -99,17 +115,22 @@ _xmlBufResetInput(xmlBuffer * buf, xmlParserInputPtr input) {
 /**
  * srcsax_controller_init
  *
- * Internal method to initialize the controller module.
+ * Internal method to initialize the controller module.  libxml2 is initialized once
+ * per process, and its errors are silenced once per thread.
  */
 static void srcsax_controller_init() {
 
-    static bool initialized = false;
+    static std::once_flag initialized;
+    std::call_once(initialized, xmlInitParser);
+
+    // the generic error handler is per thread in libxml2
+    static thread_local bool thread_initialized = false;
 
-    if(initialized) return;
+    if(thread_initialized) return;
 
     xmlGenericErrorFunc error_handler = (xmlGenericErrorFunc) libxml_error;
     initGenericErrorDefaultFunc(&error_handler);
-    initialized = true;
+    thread_initialized = true;
 
 }
 
@@ -201,7 +222,148 @@ struct srcsax_context * srcsax_create_context_memory(const char * buffer, size_t
     xmlParserInputBufferPtr input =
         xmlParserInputBufferCreateMem(buffer, (int)buffer_size, encoding ? xmlParseCharEncoding(encoding) : XML_CHAR_ENCODING_NONE);
 
-    return srcsax_create_context_inner(input, 1);
+    struct srcsax_context * context = srcsax_create_context_inner(input, 1);
+    if(context == 0) return 0;
+
+    context->source = buffer;
+    context->source_size = buffer_size;
+
+    return context;
+
+}
+
+#ifndef _MSC_BUILD
+/**
+ * is_utf8_document
+ * @param buffer an XML document
+ * @param size the size of the document
+ *
+ * @returns if the document is UTF-8 according to its byte order mark and XML declaration.
+ */
+static bool is_utf8_document(const char * buffer, size_t size) {
+
+    if(size >= 3 && memcmp(buffer, "\xEF\xBB\xBF", 3) == 0) {
+
+        buffer += 3;
+        size -= 3;
+
+    }
+
+    if(size < 2 || buffer[0] == '\0' || buffer[1] == '\0' || (unsigned char)buffer[0] >= 0x80) return false;
+
+    if(size < 6 || memcmp(buffer, "<?xml ", 6) != 0) return true;
+
+    const char * declaration_end = (const char *)memchr(buffer, '>', size);
+    if(declaration_end == 0) return false;
+
+    std::string encoding;
+    if(!srcml_tag_attribute(buffer, declaration_end + 1 - buffer, "encoding", encoding)) return true;
+
+    return xmlParseCharEncoding(encoding.c_str()) == XML_CHAR_ENCODING_UTF8;
+
+}
+#endif
+
+/**
+ * srcsax_create_context_mmap
+ * @param filename a filename
+ * @param encoding the files character encoding
+ *
+ * Map the file read-only into memory and return a srcSAX context that parses the
+ * mapping in place, without read calls or a copy into libxml2's input buffer.
+ * Files in another encoding than UTF-8, files over INT_MAX bytes, or without mmap support,
+ * are opened as in srcsax_create_context_filename.
+ *
+ * @returns srcsax_context context to be used for srcML parsing.
+ */
+struct srcsax_context * srcsax_create_context_mmap(const char * filename, const char * encoding) {
+
+    if(filename == 0) return 0;
+
+#ifdef _MSC_BUILD
+
+    return srcsax_create_context_filename(filename, encoding);
+
+#else
+
+    srcsax_controller_init();
+
+    int fd = open(filename, O_RDONLY);
+    if(fd < 0) return 0;
+
+    struct stat status;
+    if(fstat(fd, &status) != 0 || status.st_size == 0) {
+
+        close(fd);
+        return 0;
+
+    }
+
+    // libxml2 memory input is limited to INT_MAX bytes
+    size_t size = (size_t)status.st_size;
+    if(size > INT_MAX - STATIC_INPUT_PADDING) {
+
+        close(fd);
+        return srcsax_create_context_filename(filename, encoding);
+
+    }
+
+    // libxml2 expects a static buffer to be null terminated, so a zero byte follows the file and its padding
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    size_t mapping_size = ((size + STATIC_INPUT_PADDING) / page_size + 1) * page_size;
+
+    void * mapping = mmap(0, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(mapping == MAP_FAILED) {
+
+        close(fd);
+        return 0;
+
+    }
+
+    // private, so the padding written into the last page of the file is not written to the file
+    if(mmap(mapping, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+
+        munmap(mapping, mapping_size);
+        close(fd);
+        return 0;
+
+    }
+
+    close(fd);
+
+    memset((char *)mapping + size, ' ', STATIC_INPUT_PADDING);
+    mprotect(mapping, mapping_size, PROT_READ);
+
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    // libxml2 can not convert a static buffer, so other encodings are read and converted as usual
+    xmlCharEncoding xml_encoding = encoding ? xmlParseCharEncoding(encoding) : XML_CHAR_ENCODING_NONE;
+    if((xml_encoding != XML_CHAR_ENCODING_NONE && xml_encoding != XML_CHAR_ENCODING_UTF8)
+       || !is_utf8_document((const char *)mapping, size)) {
+
+        munmap(mapping, mapping_size);
+        return srcsax_create_context_filename(filename, encoding);
+
+    }
+
+    xmlParserInputBufferPtr input = xmlParserInputBufferCreateStatic((const char *)mapping, (int)(size + STATIC_INPUT_PADDING), XML_CHAR_ENCODING_NONE);
+
+    struct srcsax_context * context = srcsax_create_context_inner(input, 1);
+    if(context == 0) {
+
+        munmap(mapping, mapping_size);
+        return 0;
+
+    }
+
+    context->mapping = mapping;
+    context->mapping_size = mapping_size;
+    context->source = (const char *)mapping;
+    context->source_size = size;
+
+    return context;
+
+#endif
 
 }
 
@@ -295,159 +457,1293 @@ struct srcsax_context * srcsax_create_context_parser_input_buffer(xmlParserInput
 }
 
 /**
- * srcsax_free_context
- * @param context a srcSAX context
+ * srcsax_create_push_context
+ * @param encoding the documents character encoding
  *
- * Free the resources associated with a srcsax_context as created
- * by a previous srcsax_create_context_*.
+ * Create a srcSAX context without input for incremental parsing, where the document
+ * is fed in chunks of any size with srcsax_parse_chunk.  The parse state is kept
+ * in the context between chunks.
+ *
+ * @returns srcsax_context context to be used for srcML parsing.
  */
-void srcsax_free_context(struct srcsax_context * context) {
+struct srcsax_context * srcsax_create_push_context(const char * encoding) {
 
-    if(context == 0) return;
+    srcsax_controller_init();
 
-    xmlParserInputPtr stream = inputPop(context->libxml2_context);
-    stream->buf = 0;
-    xmlFreeInputStream(stream);
-    if(context->libxml2_context) xmlFreeParserCtxt(context->libxml2_context);
-    if(context->free_input) xmlFreeParserInputBuffer(context->input);
+    struct srcsax_context * context = (struct srcsax_context *)malloc(sizeof(struct srcsax_context));
+    if(context == 0) return 0;
 
-    free(context);
+    memset(context, 0, sizeof(struct srcsax_context));
+
+    xmlSAXHandler sax = srcsax_sax2_factory();
+    xmlParserCtxtPtr libxml2_context = xmlCreatePushParserCtxt(&sax, 0, 0, 0, 0);
+
+    if(libxml2_context == NULL) {
+
+        free(context);
+        return 0;
+
+    }
+
+    xmlCtxtUseOptions(libxml2_context, XML_PARSE_COMPACT | XML_PARSE_HUGE | XML_PARSE_NODICT);
+    if(encoding) xmlSwitchEncoding(libxml2_context, xmlParseCharEncoding(encoding));
+
+    sax2_srcsax_handler * state = new sax2_srcsax_handler;
+    state->context = context;
+    libxml2_context->_private = state;
+
+    context->libxml2_context = libxml2_context;
+    context->input = libxml2_context->input->buf;
+    context->free_input = 1;
+    context->push_state = state;
+    context->element_table = &state->element_table;
+
+    return context;
 
 }
 
 /**
- * srcsax_parse
- * @param context srcSAX context
+ * seek_archive
+ * @param file an opened srcML archive
+ * @param offset a byte offset
  *
- * Parse the context using the provide sax handlers.
- * On error calls the error callback function before returning.
+ * Seek to an offset that may be beyond 2 GB.
  *
- * @returns 0 on success -1 on error.
+ * @returns 0 on success.
  */
-int srcsax_parse(struct srcsax_context * context) {
+static int seek_archive(FILE * file, size_t offset) {
 
-    if(context == 0 || context->handler == 0) return -1;
+#ifdef _MSC_BUILD
+    return _fseeki64(file, (__int64)offset, SEEK_SET);
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET);
+#endif
 
-    xmlSAXHandlerPtr save_sax = context->libxml2_context->sax;
-    xmlSAXHandler sax = srcsax_sax2_factory();
-    context->libxml2_context->sax = &sax;
+}
 
-    sax2_srcsax_handler state;
-    state.context = context;
-    context->libxml2_context->_private = &state;
+/**
+ * read_archive
+ * @param file an opened srcML archive
+ * @param offset byte offset of the data
+ * @param size size of the data
+ * @param buffer the buffer to read into
+ *
+ * @returns if all the data was read.
+ */
+static bool read_archive(FILE * file, size_t offset, size_t size, char * buffer) {
 
-    int status = 0;
-    try {
+    return seek_archive(file, offset) == 0 && fread(buffer, 1, size, file) == size;
 
-        status = xmlParseDocument(context->libxml2_context);
+}
 
-    } catch(...) {
+/**
+ * srcsax_create_context_unit
+ * @param filename the srcML archive file
+ * @param index the unit index of the archive
+ * @param first the position of the first unit to parse
+ * @param last the position after the last unit to parse
+ * @param encoding the files character encoding
+ *
+ * Create a srcSAX context for the units [first, last) of an indexed archive.  Only
+ * the XML declaration, the root start tag with the meta tags following it, and the units
+ * are read from the file, and are parsed as an archive of those units.
+ *
+ * @returns srcsax_context context to be used for srcML parsing.
+ */
+struct srcsax_context * srcsax_create_context_unit(const char * filename, const struct srcsax_unit_index * index, size_t first, size_t last, const char * encoding) {
 
-        return -1;
+    if(filename == 0 || index == 0 || first >= last || last > index->unit_count) return 0;
+
+    srcsax_controller_init();
+
+    FILE * file = fopen(filename, "rb");
+    if(file == 0) return 0;
+
+    // an index of a different version of the archive can not be used
+    if(fseek(file, 0, SEEK_END) != 0) {
+
+        fclose(file);
+        return 0;
 
     }
 
-    context->libxml2_context->sax = save_sax;
+#ifdef _MSC_BUILD
+    size_t archive_size = (size_t)_ftelli64(file);
+#else
+    size_t archive_size = (size_t)ftello(file);
+#endif
 
-    if(status != 0) {
+    if(archive_size != index->archive_size) {
 
-        xmlErrorPtr ep = xmlCtxtGetLastError(context->libxml2_context);
+        fclose(file);
+        return 0;
 
-        size_t str_length = strlen(ep->message);
-        ep->message[str_length - 1] = '\0';
+    }
 
-        if(context->srcsax_error)
-            context->srcsax_error((const char *)ep->message, ep->code);
+    size_t units_offset = index->units[first].offset;
+    size_t units_length = index->units[last - 1].offset + index->units[last - 1].length - units_offset;
+    size_t qname_length = strlen(index->root_qname);
+    size_t size = index->declaration_length + index->root_length + index->header_length + units_length + qname_length + 3;
+    // libxml2 memory input is limited to INT_MAX bytes
+    if(size > INT_MAX) {
+
+        fclose(file);
+        return 0;
 
     }
 
-    return status;
+    char * buffer = (char *)malloc(size);
+    if(buffer == 0) {
+
+        fclose(file);
+        return 0;
+
+    }
+
+    char * pos = buffer;
+    bool read = read_archive(file, index->declaration_offset, index->declaration_length, pos);
+    pos += index->declaration_length;
+
+    // the meta tags directly follow the root start tag
+    read = read && read_archive(file, index->root_offset, index->root_length + index->header_length, pos);
+    pos += index->root_length + index->header_length;
+
+    read = read && read_archive(file, units_offset, units_length, pos);
+    pos += units_length;
+
+    fclose(file);
+
+    if(!read) {
+
+        free(buffer);
+        return 0;
+
+    }
+
+    *pos++ = '<';
+    *pos++ = '/';
+    memcpy(pos, index->root_qname, qname_length);
+    pos += qname_length;
+    *pos++ = '>';
+
+    xmlParserInputBufferPtr input =
+        xmlParserInputBufferCreateMem(buffer, (int)size, encoding ? xmlParseCharEncoding(encoding) : XML_CHAR_ENCODING_NONE);
+
+    free(buffer);
+
+    return srcsax_create_context_inner(input, 1);
 
 }
 
 /**
- * srcsax_parse
- * @param context srcSAX context
- * @param handler sax callback handlers
- *
- * Parse the context using the provide sax handlers.
- * On error calls the error callback function before returning.
+ * srcsax_free_context
+ * @param context a srcSAX context
  *
- * @returns 0 on success -1 on error.
+ * Free the resources associated with a srcsax_context as created
+ * by a previous srcsax_create_context_*.
  */
-int srcsax_parse_handler(struct srcsax_context * context, struct srcsax_handler * handler) {
+void srcsax_free_context(struct srcsax_context * context) {
 
-    if(context == 0) return -1;
+    if(context == 0) return;
 
-    context->handler = handler;
+    xmlParserInputPtr stream = inputPop(context->libxml2_context);
+    if(stream) {
 
-    return srcsax_parse(context);
+        stream->buf = 0;
+        xmlFreeInputStream(stream);
+
+    }
+    if(context->libxml2_context) xmlFreeParserCtxt(context->libxml2_context);
+    if(context->free_input) xmlFreeParserInputBuffer(context->input);
+
+#ifndef _MSC_BUILD
+    if(context->mapping) munmap(context->mapping, context->mapping_size);
+#endif
+
+    delete (sax2_srcsax_handler *)context->push_state;
+    delete (sax2_srcsax_handler *)context->parse_state;
+    delete (srcml_element_filter *)context->element_filter;
+    delete (srcsax_stats_state *)context->stats;
+
+    free(context);
 
 }
 
 /**
- * srcsax_create_parser_context
- * @param buffer_input a parser input buffer
- *
- * Create a ctxt from a parser input buffer.
- * Modeled after function in libxml2.
+ * srcsax_free_input
+ * @param context a srcSAX context
  *
- * @returns xml parser ctxt
+ * Free the input of a (non-push) context, leaving the parser without an input.
  */
-xmlParserCtxtPtr
-srcsax_create_parser_context(xmlParserInputBufferPtr buffer_input) {
-    xmlParserCtxtPtr ctxt;
-    xmlParserInputPtr input;
-    xmlParserInputBufferPtr buf;
+static void srcsax_free_input(struct srcsax_context * context) {
 
-    ctxt = xmlNewParserCtxt();
-    if (ctxt == NULL)
-        return(NULL);
+    xmlParserInputPtr stream = inputPop(context->libxml2_context);
+    if(stream) {
 
-    xmlCtxtUseOptions(ctxt, XML_PARSE_COMPACT | XML_PARSE_HUGE | XML_PARSE_NODICT);
+        stream->buf = 0;
+        xmlFreeInputStream(stream);
 
-    buf = buffer_input;
-    if (buf == NULL) {
-        xmlFreeParserCtxt(ctxt);
-        return(NULL);
     }
+    if(context->free_input) xmlFreeParserInputBuffer(context->input);
+    context->input = 0;
+    context->free_input = 0;
 
-    input = xmlNewInputStream(ctxt);
-    if (input == NULL) {
-        xmlFreeParserCtxt(ctxt);
-        return(NULL);
-    }
+#ifndef _MSC_BUILD
+    if(context->mapping) munmap(context->mapping, context->mapping_size);
+#endif
+    context->mapping = 0;
+    context->mapping_size = 0;
+    context->source = 0;
+    context->source_size = 0;
 
-    input->filename = NULL;
-    input->buf = buf;
-    _xmlBufResetInput(input->buf->buffer, input);
+}
 
-    inputPush(ctxt, input);
+/**
+ * srcsax_reset_document
+ * @param context a srcSAX context
+ *
+ * Clear the per document fields of a context.  The user data, handler,
+ * error callback, subscriptions and statistics are kept.
+ */
+static void srcsax_reset_document(struct srcsax_context * context) {
+
+    context->is_archive = 0;
+    context->unit_count = 0;
+    context->stack_size = 0;
+    context->srcml_element_stack = 0;
+    context->encoding = 0;
+    context->element_id = 0;
+    context->terminate = 0;
 
-    return(ctxt);
 }
 
 /**
- * srcsax_stop_parser
+ * srcsax_reset_context
  * @param context a srcSAX context
+ * @param input a parser input buffer for the next document, 0 for a push context
  *
- * Stop srcSAX parser.
+ * Reuse a context for another document instead of freeing it and creating a new one.
+ * The libxml2 parser context (reset with xmlCtxtReset) and the parse state with its
+ * storage are kept, as are the user data, handler, error callback, subscriptions and
+ * statistics.  The input is not freed with the context, as in
+ * srcsax_create_context_parser_input_buffer.  A push context (no input) is reset to
+ * start a new document with srcsax_parse_chunk.  Not to be called during a parse.
+ *
+ * @returns 0 on success -1 on error.
  */
-void srcsax_stop_parser(struct srcsax_context * context) {
+int srcsax_reset_context(struct srcsax_context * context, xmlParserInputBufferPtr input) {
 
-    context->terminate = 1;
+    if(context == 0 || context->libxml2_context == 0) return -1;
+
+    // the context may be reused on another thread
+    srcsax_controller_init();
 
     xmlParserCtxtPtr ctxt = context->libxml2_context;
 
-    ctxt->sax->startDocument = 0;
-    ctxt->sax->endDocument = 0;
-    ctxt->sax->startElementNs = 0;
-    ctxt->sax->endElementNs = 0;
-    ctxt->sax->characters = 0;
-    ctxt->sax->cdataBlock = 0;
+    if(context->push_state) {
+
+        if(input) return -1;
+
+        // the input buffer of a push context is owned by the context
+        xmlParserInputPtr stream = inputPop(ctxt);
+        if(stream) {
+
+            stream->buf = 0;
+            xmlFreeInputStream(stream);
+
+        }
+        if(context->free_input) xmlFreeParserInputBuffer(context->input);
+        context->input = 0;
+        context->free_input = 0;
+
+        // the SAX callbacks are changed while parsing, and when stopped
+        *ctxt->sax = srcsax_sax2_factory();
+
+        if(xmlCtxtResetPush(ctxt, 0, 0, 0, 0) != 0 || ctxt->input == 0) return -1;
+        xmlCtxtUseOptions(ctxt, XML_PARSE_COMPACT | XML_PARSE_HUGE | XML_PARSE_NODICT);
+
+        sax2_srcsax_handler * state = (sax2_srcsax_handler *)context->push_state;
+        state->reset();
+        ctxt->_private = state;
+
+        context->input = ctxt->input->buf;
+        context->free_input = 1;
+        srcsax_reset_document(context);
+
+        return 0;
+
+    }
+
+    // the parse state is only available while parsing
+    if(input == 0 || context->element_table) return -1;
+
+    srcsax_free_input(context);
+
+    xmlCtxtReset(ctxt);
+    xmlCtxtUseOptions(ctxt, XML_PARSE_COMPACT | XML_PARSE_HUGE | XML_PARSE_NODICT);
+
+    xmlParserInputPtr stream = xmlNewInputStream(ctxt);
+    if(stream == 0) return -1;
+
+    stream->filename = 0;
+    stream->buf = input;
+    _xmlBufResetInput(input->buffer, stream);
+    inputPush(ctxt, stream);
+
+    context->input = input;
+    srcsax_reset_document(context);
+
+    return 0;
+
+}
+
+/**
+ * srcsax_reset_context_memory
+ * @param context a srcSAX context
+ * @param buffer a buffer of memory
+ * @param buffer_size the size of the buffer/amount of buffer to use
+ * @param encoding the buffers character encoding
+ *
+ * Reuse a (non-push) context for the document in the buffer, see srcsax_reset_context.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_reset_context_memory(struct srcsax_context * context, const char * buffer, size_t buffer_size, const char * encoding) {
+
+    if(context == 0 || context->push_state || context->element_table || buffer == 0 || buffer_size == 0) return -1;
+
+    xmlParserInputBufferPtr input =
+        xmlParserInputBufferCreateMem(buffer, (int)buffer_size, encoding ? xmlParseCharEncoding(encoding) : XML_CHAR_ENCODING_NONE);
+    if(input == 0) return -1;
+
+    if(srcsax_reset_context(context, input) != 0) {
+
+        xmlFreeParserInputBuffer(input);
+        return -1;
+
+    }
+
+    context->free_input = 1;
+    context->source = buffer;
+    context->source_size = buffer_size;
+
+    return 0;
+
+}
+
+/**
+ * srcsax_reset_context_filename
+ * @param context a srcSAX context
+ * @param filename a filename
+ * @param encoding the files character encoding
+ *
+ * Reuse a (non-push) context for the document in the file, see srcsax_reset_context.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_reset_context_filename(struct srcsax_context * context, const char * filename, const char * encoding) {
+
+    if(context == 0 || context->push_state || context->element_table || filename == 0) return -1;
+
+    xmlParserInputBufferPtr input =
+        xmlParserInputBufferCreateFilename(filename, encoding ? xmlParseCharEncoding(encoding) : XML_CHAR_ENCODING_NONE);
+    if(input == 0) return -1;
+
+    if(srcsax_reset_context(context, input) != 0) {
+
+        xmlFreeParserInputBuffer(input);
+        return -1;
+
+    }
+
+    context->free_input = 1;
+
+    return 0;
+
+}
+
+/**
+ * srcsax_parse
+ * @param context srcSAX context
+ *
+ * Parse the context using the provide sax handlers.
+ * On error calls the error callback function before returning.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_parse(struct srcsax_context * context) {
+
+    if(context == 0 || context->handler == 0 || context->push_state) return -1;
+
+    // the parse state, and its storage, is kept for the parse of a reset context
+    sax2_srcsax_handler * state = (sax2_srcsax_handler *)context->parse_state;
+    if(state == 0) {
+
+        state = new(std::nothrow) sax2_srcsax_handler;
+        if(state == 0) return -1;
+
+        context->parse_state = state;
+
+    } else {
+
+        state->reset();
+
+    }
+
+    xmlSAXHandlerPtr save_sax = context->libxml2_context->sax;
+    xmlSAXHandler sax = srcsax_sax2_factory();
+    context->libxml2_context->sax = &sax;
+
+    state->context = context;
+    context->libxml2_context->_private = state;
+    context->element_table = &state->element_table;
+
+    srcsax_stats_begin(context);
+
+    int status = 0;
+    try {
+
+        status = xmlParseDocument(context->libxml2_context);
+
+    } catch(...) {
+
+        srcsax_stats_end(context, state, 0);
+        context->element_table = 0;
+        context->libxml2_context->sax = save_sax;
+        return -1;
+
+    }
+
+    long consumed = xmlByteConsumed(context->libxml2_context);
+
+    // the padding of a memory mapped input is not part of the document
+    xmlParserInputPtr input = context->libxml2_context->input;
+    if(context->mapping && input) {
+
+        long size = (long)input->consumed + (long)(input->end - input->base) - (long)STATIC_INPUT_PADDING;
+        if(consumed > size) consumed = size;
+
+    }
+
+    srcsax_stats_end(context, state, consumed > 0 ? (size_t)consumed : 0);
+
+    context->element_table = 0;
+    context->libxml2_context->sax = save_sax;
+
+    if(status != 0) {
+
+        xmlErrorPtr ep = xmlCtxtGetLastError(context->libxml2_context);
+
+        size_t str_length = strlen(ep->message);
+        ep->message[str_length - 1] = '\0';
+
+        if(context->srcsax_error)
+            context->srcsax_error((const char *)ep->message, ep->code);
+
+    }
+
+    return status;
+
+}
+
+/**
+ * srcsax_parse
+ * @param context srcSAX context
+ * @param handler sax callback handlers
+ *
+ * Parse the context using the provide sax handlers.
+ * On error calls the error callback function before returning.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_parse_handler(struct srcsax_context * context, struct srcsax_handler * handler) {
+
+    if(context == 0) return -1;
+
+    context->handler = handler;
+
+    return srcsax_parse(context);
+
+}
+
+/**
+ * srcsax_parse_chunk
+ * @param context srcSAX push context
+ * @param chunk the next chunk of the document
+ * @param size the size of the chunk
+ * @param is_last the chunk is the end of the document
+ *
+ * Parse the next chunk of a document using the context's handler.  The callbacks for
+ * the complete markup in the chunk are made before returning.  Once the parser is
+ * stopped further chunks are ignored.
+ * On error calls the error callback function before returning.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_parse_chunk(struct srcsax_context * context, const char * chunk, size_t size, int is_last) {
+
+    if(context == 0 || context->handler == 0 || context->push_state == 0) return -1;
+
+    // libxml2 takes an int size
+    const size_t max_size = 1 << 30;
+
+    sax2_srcsax_handler * state = (sax2_srcsax_handler *)context->push_state;
+    size_t chunk_size = size;
+
+    srcsax_stats_begin(context);
+
+    int status = 0;
+    try {
+
+        for(; size > max_size && status == 0 && !context->terminate; chunk += max_size, size -= max_size)
+            status = xmlParseChunk(context->libxml2_context, chunk, (int)max_size, 0);
+
+        if(status == 0 && !context->terminate)
+            status = xmlParseChunk(context->libxml2_context, chunk, (int)size, is_last);
+
+    } catch(...) {
+
+        srcsax_stats_end(context, state, 0);
+        return -1;
+
+    }
+
+    srcsax_stats_end(context, state, chunk_size);
+
+    if(context->terminate) return 0;
+
+    if(status != 0) {
+
+        xmlErrorPtr ep = xmlCtxtGetLastError(context->libxml2_context);
+
+        // the last error remains for later chunks
+        size_t str_length = strlen(ep->message);
+        if(str_length && ep->message[str_length - 1] == '\n') ep->message[str_length - 1] = '\0';
+
+        if(context->srcsax_error)
+            context->srcsax_error((const char *)ep->message, ep->code);
+
+        return -1;
+
+    }
+
+    return 0;
+
+}
+
+/**
+ * srcsax_parse_parallel
+ * @param context srcSAX context
+ * @param thread_count the number of threads to use (0 for one per hardware thread)
+ * @param thread_data user data for each of thread_count threads (thread_count must then be positive)
+ * or 0 to use the context's data for all
+ * @param ordered deliver the start_unit calls, and the end_unit calls, each in document order
+ *
+ * Parse the units of a srcML archive in parallel using the context's handler.
+ * The document, root and meta tag callbacks, and end_root/end_document, are made on the calling thread
+ * with the context's data.  The callbacks of each unit are made on one of the threads with that thread's data
+ * and a srcSAX context of its own, so callbacks of different units may be concurrent and in any order.
+ * Ordered, the start_unit of a unit comes after those of the preceding units, and its end_unit after
+ * their end_units, but the start_unit of a unit may come before the end_unit of a preceding one.
+ * Documents that are not archives, or can not be split into units, are parsed sequentially.
+ * The complete input is read into memory before parsing.
+ * On error calls the error callback function before returning.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_parse_parallel(struct srcsax_context * context, int thread_count, void ** thread_data, int ordered) {
+
+    if(context == 0 || context->handler == 0 || context->push_state) return -1;
+
+    // thread_data has one entry per thread, so the thread count must be given
+    if(thread_data && thread_count <= 0) return -1;
+
+    // read the complete input into the input buffer (UTF-8 if converted)
+    if(context->input->readcallback) {
+
+        int status;
+        while((status = xmlParserInputBufferGrow(context->input, 1 << 20)) > 0)
+            ;
+
+        if(status < 0) return -1;
+
+    }
+
+    xmlParserInputPtr input = context->libxml2_context->input;
+    _xmlBufResetInput(context->input->buffer, input);
+
+    int status = srcsax_parse_units(context, (const char *)input->base, input->end - input->base, context->input->encoder != 0,
+                                    thread_count, thread_data, ordered);
+
+    if(status == 1) return srcsax_parse(context);
+
+    if(status != 0) {
+
+        xmlErrorPtr ep = xmlCtxtGetLastError(context->libxml2_context);
+
+        if(ep && ep->message) {
+
+            // the last error remains for later parses
+            size_t str_length = strlen(ep->message);
+            if(str_length && ep->message[str_length - 1] == '\n') ep->message[str_length - 1] = '\0';
+
+            if(context->srcsax_error)
+                context->srcsax_error((const char *)ep->message, ep->code);
+
+        }
+
+    }
+
+    return status;
+
+}
+
+/**
+ * srcsax_create_parser_context
+ * @param buffer_input a parser input buffer
+ *
+ * Create a ctxt from a parser input buffer.
+ * Modeled after function in libxml2.
+ *
+ * @returns xml parser ctxt
+ */
+xmlParserCtxtPtr
+srcsax_create_parser_context(xmlParserInputBufferPtr buffer_input) {
+    xmlParserCtxtPtr ctxt;
+    xmlParserInputPtr input;
+    xmlParserInputBufferPtr buf;
+
+    ctxt = xmlNewParserCtxt();
+    if (ctxt == NULL)
+        return(NULL);
+
+    xmlCtxtUseOptions(ctxt, XML_PARSE_COMPACT | XML_PARSE_HUGE | XML_PARSE_NODICT);
+
+    buf = buffer_input;
+    if (buf == NULL) {
+        xmlFreeParserCtxt(ctxt);
+        return(NULL);
+    }
+
+    input = xmlNewInputStream(ctxt);
+    if (input == NULL) {
+        xmlFreeParserCtxt(ctxt);
+        return(NULL);
+    }
+
+    input->filename = NULL;
+    input->buf = buf;
+    _xmlBufResetInput(input->buf->buffer, input);
+
+    inputPush(ctxt, input);
+
+    return(ctxt);
+}
+
+/**
+ * srcsax_stop_parser
+ * @param context a srcSAX context
+ *
+ * Stop srcSAX parser.
+ */
+void srcsax_stop_parser(struct srcsax_context * context) {
+
+    context->terminate = 1;
+
+    xmlParserCtxtPtr ctxt = context->libxml2_context;
+
+    ctxt->sax->startDocument = 0;
+    ctxt->sax->endDocument = 0;
+    ctxt->sax->startElementNs = 0;
+    ctxt->sax->endElementNs = 0;
+    ctxt->sax->characters = 0;
+    ctxt->sax->cdataBlock = 0;
     ctxt->sax->comment = 0;
     ctxt->sax->ignorableWhitespace = 0;
 
-    xmlStopParser(ctxt);
-    
+    // the input buffer is owned by the srcSAX context, do not let libxml2 free it when halting
+    if(ctxt->input) ctxt->input->buf = 0;
+
+    xmlStopParser(ctxt);
+    
+}
+
+/**
+ * srcsax_skip_subtree
+ * @param context a srcSAX context
+ *
+ * Skip the rest of the element of the current start_unit or start_element
+ * callback.  No callbacks are made for its contents, only for its end tag,
+ * so handlers see balanced start/end calls.
+ *
+ * @returns 0 on success -1 if not called from a start_unit or start_element callback.
+ */
+int srcsax_skip_subtree(struct srcsax_context * context) {
+
+    // the parse state is only available while parsing
+    if(context == 0 || context->libxml2_context == 0 || context->element_table == 0) return -1;
+
+    sax2_srcsax_handler * state = (sax2_srcsax_handler *)context->libxml2_context->_private;
+    if(state == 0 || !state->skippable) return -1;
+
+    state->skip_stack_size = context->stack_size;
+
+    return 0;
+
+}
+
+/**
+ * input_origin_position
+ * @param state the parse state
+ * @param position a position in the parsed document
+ *
+ * Translate a position in a document built from parts of the input, e.g., the
+ * document of a unit in srcsax_parse_parallel, to the position in the input.
+ *
+ * @returns the position in the input.
+ */
+static input_position input_origin_position(const sax2_srcsax_handler * state, input_position position) {
+
+    const input_position & document = state->document_origin;
+    const input_position & input = state->input_origin;
+    if(document.offset == -1 || position.offset < document.offset) return position;
+
+    position.offset += input.offset - document.offset;
+    if(position.line == 0) return position;
+
+    // only the first line of the content does not start a line in both
+    if(position.line == document.line && position.column != 0)
+        position.column += input.column - document.column;
+    position.line += input.line - document.line;
+
+    return position;
+
+}
+
+/**
+ * srcsax_position_of
+ * @param context a srcSAX context
+ * @param line_column if the line and column are needed
+ * @param position location for the position of the current callback
+ *
+ * @returns 0 on success -1 if not parsing.
+ */
+static int srcsax_position_of(struct srcsax_context * context, bool line_column, input_position & position) {
+
+    // the parse state is only available while parsing
+    if(context == 0 || context->libxml2_context == 0 || context->element_table == 0) return -1;
+
+    sax2_srcsax_handler * state = (sax2_srcsax_handler *)context->libxml2_context->_private;
+    if(state == 0) return -1;
+
+    if(state->position == ROOT_POSITION)
+        position = state->root_position;
+    else if(state->position == ROOT_END_POSITION)
+        position = state->root_end_position;
+    else if(state->position == FUNCTION_POSITION)
+        position = state->function_position;
+    else if(state->position == TAG_POSITION)
+        position = markup_position(context->libxml2_context, true, line_column);
+    else
+        position = markup_position(context->libxml2_context, false, false);
+
+    position = input_origin_position(state, position);
+
+    return 0;
+
+}
+
+/**
+ * srcsax_current_offset
+ * @param context a srcSAX context
+ *
+ * Get the byte offset in the input of the current callback's event: the start tag of
+ * start_root, start_unit, start_element, meta_tag and start_function, the end tag of
+ * end_root, end_unit, end_element and end_function, and the parser's position, i.e.,
+ * at or after the text, for the other callbacks.  Meta tags are reported at the root's
+ * start tag.  The offset is in the original encoding of the input, except for
+ * srcsax_parse_parallel of a converted input, where it is in its UTF-8 conversion.
+ *
+ * @returns the offset, or -1 if not called from a callback or not known.
+ */
+long srcsax_current_offset(struct srcsax_context * context) {
+
+    input_position position;
+    if(srcsax_position_of(context, false, position) == -1) return -1;
+
+    return position.offset;
+
+}
+
+/**
+ * srcsax_current_position
+ * @param context a srcSAX context
+ * @param line location for the line, starting at 1, may be 0
+ * @param column location for the byte column, starting at 1, may be 0
+ *
+ * Get the line and column of the current callback's start or end tag, as with
+ * srcsax_current_offset.  The column is 0 if it is not known, i.e., the start of
+ * the line is no longer in libxml2's input buffer.  libxml2 counts the lines of
+ * text ahead of the parser's position, so text, comment, CDATA and processing
+ * instruction callbacks have no position.
+ *
+ * @returns 0 on success -1 if not called from a start or end callback.
+ */
+int srcsax_current_position(struct srcsax_context * context, int * line, int * column) {
+
+    input_position position;
+    if(srcsax_position_of(context, true, position) == -1 || position.line == 0) return -1;
+
+    if(line) *line = position.line;
+    if(column) *column = position.column;
+
+    return 0;
+
+}
+
+/**
+ * srcsax_copy_subtree
+ * @param context a srcSAX context
+ * @param writer the writer of the transform
+ *
+ * Copy the element of the current start_unit or start_element callback unchanged:
+ * once its end tag is parsed, its original bytes are written to the writer with
+ * srcsax_write_element_copy.  As with srcsax_skip_subtree, no callbacks are made for
+ * its contents, only for its end tag, whose srcsax_write_end_element writes nothing.
+ * Nothing is to be written for the element before.  The original bytes are those of
+ * a memory context, whose buffer has to stay valid while parsing, or a memory mapped
+ * context, without an encoding conversion.
+ *
+ * @returns 0 on success -1 if not called from a start_unit or start_element callback,
+ * or the original input is not available.  The element is then parsed as usual.
+ */
+int srcsax_copy_subtree(struct srcsax_context * context, struct srcsax_writer * writer) {
+
+    // the parse state is only available while parsing
+    if(context == 0 || writer == 0 || context->libxml2_context == 0 || context->element_table == 0 || context->source == 0) return -1;
+
+    sax2_srcsax_handler * state = (sax2_srcsax_handler *)context->libxml2_context->_private;
+    if(state == 0 || !state->skippable || state->in_start_function) return -1;
+
+    // offsets are into the converted input when the document is not UTF-8
+    xmlParserInputPtr input = context->libxml2_context->input;
+    if(input == 0 || input->buf == 0 || input->buf->encoder) return -1;
+
+    // the unit of a non-archive is the root, whose start tag is already behind
+    size_t offset = context->stack_size == 1 ? (size_t)state->root_position.offset : start_tag_offset(context->libxml2_context, context);
+    if(offset >= context->source_size) return -1;
+
+    state->copy_writer = writer;
+    state->copy_offset = offset;
+    state->skip_stack_size = context->stack_size;
+
+    return 0;
+
+}
+
+/**
+ * srcsax_root
+ * @param context a srcSAX context
+ *
+ * @returns the root element of the document being parsed, or 0 if not parsing or the root is not started.
+ */
+static const srcml_element * srcsax_root(struct srcsax_context * context) {
+
+    // the parse state is only available while parsing
+    if(context == 0 || context->libxml2_context == 0 || context->element_table == 0) return 0;
+
+    sax2_srcsax_handler * state = (sax2_srcsax_handler *)context->libxml2_context->_private;
+    if(state == 0 || state->mode == START || state->root.localname == 0) return 0;
+
+    return &state->root;
+
+}
+
+/**
+ * srcsax_get_root_namespaces
+ * @param context a srcSAX context
+ * @param num_namespaces location for the number of namespaces, may be 0
+ *
+ * Get the namespaces of the root element, as passed to start_root, from any callback
+ * after start_root.  The namespaces are converted once for the document and stay valid
+ * until the end of its parse.
+ *
+ * @returns the root namespaces or 0 if there is no root element.
+ */
+const struct srcsax_namespace * srcsax_get_root_namespaces(struct srcsax_context * context, int * num_namespaces) {
+
+    const srcml_element * root = srcsax_root(context);
+
+    if(num_namespaces) *num_namespaces = root ? root->nb_namespaces : 0;
+
+    return root ? root->srcsax_namespaces : 0;
+
+}
+
+/**
+ * srcsax_get_root_attributes
+ * @param context a srcSAX context
+ * @param num_attributes location for the number of attributes, may be 0
+ *
+ * Get the attributes of the root element, as passed to start_root, from any callback
+ * after start_root.  The attributes are converted once for the document and stay valid
+ * until the end of its parse.
+ *
+ * @returns the root attributes or 0 if there is no root element.
+ */
+const struct srcsax_attribute * srcsax_get_root_attributes(struct srcsax_context * context, int * num_attributes) {
+
+    const srcml_element * root = srcsax_root(context);
+
+    if(num_attributes) *num_attributes = root ? root->nb_attributes : 0;
+
+    return root ? root->srcsax_attributes : 0;
+
+}
+
+/**
+ * srcsax_enable_function
+ * @param context a srcSAX context
+ * @param enable non-zero to deliver function headers, 0 for elements
+ *
+ * Deliver each function/function_decl with start_function, with the name, return type and
+ * parameters of its header, and end_function.  Neither the start_element/end_element callbacks
+ * of the function nor the element and characters callbacks of its header (type, name and
+ * parameter_list) are made.  The rest of the function, e.g., its block, is delivered as usual,
+ * or can be skipped with srcsax_skip_subtree from start_function.  Takes effect at the start
+ * of the next document.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_enable_function(struct srcsax_context * context, int enable) {
+
+    if(context == 0) return -1;
+
+    context->parse_function = enable != 0;
+
+    return 0;
+
+}
+
+/**
+ * srcsax_enable_coalescing
+ * @param context a srcSAX context
+ * @param enable non-zero to coalesce characters, 0 to deliver them as parsed
+ *
+ * Deliver each text run in a unit with a single characters_unit callback.  libxml2 splits
+ * text, e.g., at entity references and input buffer boundaries.  A run that is parsed in
+ * one piece is delivered from the input without copying; a split run is collected in a
+ * reused buffer and delivered at its end.  Takes effect at the start of the next document.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_enable_coalescing(struct srcsax_context * context, int enable) {
+
+    if(context == 0) return -1;
+
+    context->coalesce_characters = enable != 0;
+
+    return 0;
+
+}
+
+/**
+ * element_filter
+ * @param context a srcSAX context
+ *
+ * @returns the subscription set of the context, created if needed, or 0 on error.
+ */
+static srcml_element_filter * element_filter(struct srcsax_context * context) {
+
+    if(context->element_filter == 0)
+        context->element_filter = new(std::nothrow) srcml_element_filter;
+
+    return (srcml_element_filter *)context->element_filter;
+
+}
+
+/**
+ * srcsax_subscribe_element
+ * @param context a srcSAX context
+ * @param qname qualified name of an element, e.g., function or cpp:include
+ *
+ * Subscribe to an element before parsing.  Once any element is subscribed,
+ * start_element/end_element are only called for subscribed elements, and
+ * characters_unit only inside of them.  Other elements are not converted
+ * nor dispatched.  Document, root, unit and meta tag callbacks are unaffected.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_subscribe_element(struct srcsax_context * context, const char * qname) {
+
+    if(context == 0 || qname == 0 || qname[0] == '\0') return -1;
+
+    srcml_element_filter * filter = element_filter(context);
+    if(filter == 0) return -1;
+
+    try {
+
+        filter->subscribe(qname);
+
+    } catch(...) {
+
+        return -1;
+
+    }
+
+    return 0;
+
+}
+
+/**
+ * srcsax_subscribe_element_id
+ * @param context a srcSAX context
+ * @param element_id the srcml_element_id of a known srcML element
+ *
+ * Subscribe to an element by ID before parsing, see srcsax_subscribe_element.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_subscribe_element_id(struct srcsax_context * context, int element_id) {
+
+    if(context == 0 || element_id <= SRCML_ELEMENT_UNKNOWN || element_id >= SRCML_ELEMENT_ID_COUNT) return -1;
+
+    srcml_element_filter * filter = element_filter(context);
+    if(filter == 0) return -1;
+
+    filter->subscribe(element_id);
+
+    return 0;
+
+}
+
+/**
+ * srcsax_clear_subscriptions
+ * @param context a srcSAX context
+ *
+ * Remove all subscriptions, so all elements are received again.
+ */
+void srcsax_clear_subscriptions(struct srcsax_context * context) {
+
+    if(context == 0) return;
+
+    delete (srcml_element_filter *)context->element_filter;
+    context->element_filter = 0;
+
+}
+
+/**
+ * srcsax_element_name
+ * @param context a srcSAX context
+ * @param element_id an element ID as provided in srcsax_context element_id
+ *
+ * Lookup the localname of an element ID.  IDs of known srcML elements (srcml_element_id)
+ * can always be looked up, IDs assigned to other elements only while parsing.
+ *
+ * @returns the localname of the element or 0 if the ID is not known.
+ */
+const char * srcsax_element_name(struct srcsax_context * context, int element_id) {
+
+    if(element_id < SRCML_ELEMENT_ID_COUNT) return srcml_element_id_known_name(element_id);
+
+    if(context == 0 || context->element_table == 0) return 0;
+
+    return ((const srcml_element_table *)context->element_table)->name(element_id);
+
+}
+
+/**
+ * srcsax_context_pool
+ *
+ * Idle (non-push) contexts kept for reuse, shared by threads.
+ */
+struct srcsax_context_pool {
+
+    /** constructor */
+    srcsax_context_pool(size_t max_idle) : mutex(), idle(), max_idle(max_idle) {}
+
+    /** guards the idle contexts */
+    std::mutex mutex;
+
+    /** contexts available for reuse */
+    std::vector<srcsax_context *> idle;
+
+    /** maximum number of idle contexts kept, 0 for no limit */
+    size_t max_idle;
+
+    /**
+     * pop
+     *
+     * @returns an idle context, or 0 if there are none.
+     */
+    srcsax_context * pop() {
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if(idle.empty()) return 0;
+
+        srcsax_context * context = idle.back();
+        idle.pop_back();
+
+        return context;
+
+    }
+
+};
+
+/**
+ * srcsax_create_context_pool
+ * @param max_idle the maximum number of idle contexts to keep, 0 for no limit
+ *
+ * Create a pool of srcSAX contexts.  Contexts are acquired from the pool for a document,
+ * by any thread, and released back to it after parsing, so that later documents reuse
+ * the libxml2 parser and parse state instead of allocating new ones.
+ *
+ * @returns the pool, 0 on error.
+ */
+struct srcsax_context_pool * srcsax_create_context_pool(size_t max_idle) {
+
+    srcsax_controller_init();
+
+    return new(std::nothrow) srcsax_context_pool(max_idle);
+
+}
+
+/**
+ * srcsax_free_context_pool
+ * @param pool a srcSAX context pool
+ *
+ * Free the pool and its idle contexts.  Acquired contexts must be released first.
+ */
+void srcsax_free_context_pool(struct srcsax_context_pool * pool) {
+
+    if(pool == 0) return;
+
+    for(std::vector<srcsax_context *>::iterator itr = pool->idle.begin(); itr != pool->idle.end(); ++itr)
+        srcsax_free_context(*itr);
+
+    delete pool;
+
+}
+
+/**
+ * srcsax_context_pool_acquire_memory
+ * @param pool a srcSAX context pool
+ * @param buffer a buffer of memory
+ * @param buffer_size the size of the buffer/amount of buffer to use
+ * @param encoding the buffers character encoding
+ *
+ * Acquire a context for the document in the buffer, reusing an idle context if there is one.
+ *
+ * @returns srcsax_context context to be used for srcML parsing, 0 on error.
+ */
+struct srcsax_context * srcsax_context_pool_acquire_memory(struct srcsax_context_pool * pool, const char * buffer, size_t buffer_size, const char * encoding) {
+
+    if(pool == 0 || buffer == 0 || buffer_size == 0) return 0;
+
+    srcsax_context * context = pool->pop();
+    if(context == 0) return srcsax_create_context_memory(buffer, buffer_size, encoding);
+
+    if(srcsax_reset_context_memory(context, buffer, buffer_size, encoding) != 0) {
+
+        srcsax_free_context(context);
+        return 0;
+
+    }
+
+    return context;
+
+}
+
+/**
+ * srcsax_context_pool_acquire_filename
+ * @param pool a srcSAX context pool
+ * @param filename a filename
+ * @param encoding the files character encoding
+ *
+ * Acquire a context for the document in the file, reusing an idle context if there is one.
+ *
+ * @returns srcsax_context context to be used for srcML parsing, 0 on error.
+ */
+struct srcsax_context * srcsax_context_pool_acquire_filename(struct srcsax_context_pool * pool, const char * filename, const char * encoding) {
+
+    if(pool == 0 || filename == 0) return 0;
+
+    srcsax_context * context = pool->pop();
+    if(context == 0) return srcsax_create_context_filename(filename, encoding);
+
+    if(srcsax_reset_context_filename(context, filename, encoding) != 0) {
+
+        srcsax_free_context(context);
+        return 0;
+
+    }
+
+    return context;
+
+}
+
+/**
+ * srcsax_context_pool_release
+ * @param pool a srcSAX context pool
+ * @param context a context acquired from the pool
+ *
+ * Release a context back to the pool after parsing.  The input of the context is freed,
+ * and its user data, handler, error callback, function parsing, coalescing, subscriptions and
+ * statistics are cleared.
+ * The context is freed instead if the pool has max_idle idle contexts.  Not to be called
+ * during a parse.
+ */
+void srcsax_context_pool_release(struct srcsax_context_pool * pool, struct srcsax_context * context) {
+
+    if(context == 0) return;
+
+    if(pool == 0 || context->push_state || context->element_table) {
+
+        srcsax_free_context(context);
+        return;
+
+    }
+
+    srcsax_free_input(context);
+    srcsax_reset_document(context);
+    context->data = 0;
+    context->handler = 0;
+    context->srcsax_error = 0;
+    context->parse_function = 0;
+    context->coalesce_characters = 0;
+    srcsax_clear_subscriptions(context);
+    srcsax_disable_stats(context);
+
+    {
+
+        std::lock_guard<std::mutex> lock(pool->mutex);
+
+        if(pool->max_idle == 0 || pool->idle.size() < pool->max_idle) {
+
+            pool->idle.push_back(context);
+            return;
+
+        }
+
+    }
+
+    srcsax_free_context(context);
+
+}
+
+/**
+ * srcsax_context_pool_idle
+ * @param pool a srcSAX context pool
+ *
+ * @returns the number of idle contexts in the pool.
+ */
+size_t srcsax_context_pool_idle(struct srcsax_context_pool * pool) {
+
+    if(pool == 0) return 0;
+
+    std::lock_guard<std::mutex> lock(pool->mutex);
+
+    return pool->idle.size();
+
 }
@@ -65,6 +65,21 @@ struct srcsax_namespace {
 
 };
 
+/**
+ * srcsax_declaration
+ *
+ * Data structure for a declaration, e.g., a function parameter
+ */
+struct srcsax_declaration {
+
+    /** declaration type */
+    const char * type;
+
+    /** declaration name */
+    const char * name;
+
+};
+
 /**
  * srcsax_handler
  *
@@ -127,12 +142,16 @@ void (*start_unit)(struct srcsax_context * context, const char * localname, cons
  * @param context a srcSAX context
  * @param name the function's name
  * @param return_type the function return type
+ * @param num_parameters the number of parameters
  * @param parameter_list a list of the function parameters in struct containing (declaration.type/declaration.name)
- * @param is_decl indicates if the call is a function declaration (true) or definition (false)
+ * @param is_decl indicates if the call is a function declaration (1) or definition (0)
  *
  * Signature for srcSAX handler function for start of function with prototype.
+ * Only called after srcsax_enable_function, instead of the start_element
+ * callbacks of the function and its header.
  */
-//void (*start_function(struct srcsax_context * context, const char * name, const char * return_type, const struct declaration * parameter_list, _Bool is_decl);
+void (*start_function)(struct srcsax_context * context, const char * name, const char * return_type,
+                       int num_parameters, const struct srcsax_declaration * parameter_list, int is_decl);
 
 /**
  * start_element
@@ -178,8 +197,9 @@ void (*end_unit)(struct srcsax_context * context, const char * localname, const
  * @param context a srcSAX context
  *
  * Signature for srcSAX handler function for end of a function.
+ * Only called after srcsax_enable_function, instead of end_element.
  */
-//void (*end_function(struct srcsax_context * context);
+void (*end_function)(struct srcsax_context * context);
 
 /**
  * end_element
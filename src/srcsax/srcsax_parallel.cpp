@@ -0,0 +1,630 @@
+/**
+ * @file srcsax_parallel.cpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcML SAX2 Framework.
+ *
+ * The srcML SAX2 Framework is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML SAX2 Framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML SAX2 Framework; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <srcsax_parallel.hpp>
+#include <sax2_srcsax_handler.hpp>
+#include <srcml_unit_scan.hpp>
+
+#include <libxml/parserInternals.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+/**
+ * libxml_error
+ *
+ * Silence/catch/default libxml2 errors (per thread in libxml2).
+ */
+static void libxml_error(void * /*ctx*/, const char * /*msg*/, ...) {}
+
+/**
+ * srcsax_unit_order
+ *
+ * Tickets to deliver the start_unit calls in document order, and the end_unit calls in
+ * document order.  The two are not ordered with each other.
+ */
+struct srcsax_unit_order {
+
+    /** constructor */
+    srcsax_unit_order(size_t unit_count) : mutex(), turn(), next_start(0), next_end(0), started(unit_count, 0), ended(unit_count, 0) {}
+
+    /**
+     * wait
+     * @param next the next unit allowed
+     * @param unit the unit waiting for its turn
+     *
+     * Wait until it is the unit's turn.
+     */
+    void wait(const size_t & next, size_t unit) {
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while(next < unit)
+            turn.wait(lock);
+
+    }
+
+    /**
+     * done
+     * @param next the next unit allowed
+     * @param done_units units already done
+     * @param unit the unit that is done
+     *
+     * Mark the unit done and pass the turn on.
+     */
+    void done(size_t & next, std::vector<char> & done_units, size_t unit) {
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        done_units[unit] = 1;
+        while(next < done_units.size() && done_units[next])
+            ++next;
+
+        turn.notify_all();
+
+    }
+
+    /** guard of the tickets */
+    std::mutex mutex;
+
+    /** signaled on a change of turn */
+    std::condition_variable turn;
+
+    /** next unit to start */
+    size_t next_start;
+
+    /** next unit to end */
+    size_t next_end;
+
+    /** units that started */
+    std::vector<char> started;
+
+    /** units that ended */
+    std::vector<char> ended;
+
+};
+
+/**
+ * srcsax_parallel_parse
+ *
+ * Shared data of a parallel parse.
+ */
+struct srcsax_parallel_parse {
+
+    /** constructor */
+    srcsax_parallel_parse(struct srcsax_context * context, const char * buffer, const srcml_document_scan & scan, int options)
+        : context(context), buffer(buffer), scan(scan), options(options), unit_origin(), input_origins(),
+          unit_handler(), order(0), next_unit(0), stop(false),
+          status_mutex(), status(0), root_localname(), root_prefix(), root_URI(), has_root_prefix(false), has_root_URI(false) {}
+
+    /** the srcSAX context being parsed */
+    struct srcsax_context * context;
+
+    /** the complete document */
+    const char * buffer;
+
+    /** the document's units */
+    const srcml_document_scan & scan;
+
+    /** libxml2 options for unit contexts */
+    int options;
+
+    /** start of the unit's content in a unit document */
+    input_position unit_origin;
+
+    /** position of each unit's content in the document */
+    std::vector<input_position> input_origins;
+
+    /** handler of the units */
+    srcsax_handler unit_handler;
+
+    /** ordering of start/end unit, 0 if unordered */
+    srcsax_unit_order * order;
+
+    /** next unit to parse */
+    std::atomic<size_t> next_unit;
+
+    /** stop parsing */
+    std::atomic<bool> stop;
+
+    /** guard of status */
+    std::mutex status_mutex;
+
+    /** parse status */
+    int status;
+
+    /** root end tag localname */
+    std::string root_localname;
+
+    /** root end tag prefix */
+    std::string root_prefix;
+
+    /** root end tag URI */
+    std::string root_URI;
+
+    /** root end tag has a prefix */
+    bool has_root_prefix;
+
+    /** root end tag has a URI */
+    bool has_root_URI;
+
+};
+
+/**
+ * srcsax_parallel_handler
+ *
+ * Handler of a parallel parse document.  The srcsax_handler is first, so
+ * the callbacks can get from the context's handler to the parallel parse.
+ */
+struct srcsax_parallel_handler {
+
+    /** the callbacks */
+    srcsax_handler handler;
+
+    /** the parallel parse */
+    srcsax_parallel_parse * parse;
+
+};
+
+/**
+ * ordered_start_unit
+ * @param context a unit's srcSAX context
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param URI the namespace of tag
+ * @param num_namespaces number of namespaces definitions
+ * @param namespaces the defined namespaces
+ * @param num_attributes the number of attributes on the tag
+ * @param attributes list of attributes
+ *
+ * Deliver start_unit after that of all preceding units.
+ */
+static void ordered_start_unit(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                               int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                               const struct srcsax_attribute * attributes) {
+
+    srcsax_parallel_parse * parse = ((srcsax_parallel_handler *)context->handler)->parse;
+    size_t unit = context->unit_count - 1;
+
+    parse->order->wait(parse->order->next_start, unit);
+
+    parse->context->handler->start_unit(context, localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+    parse->order->done(parse->order->next_start, parse->order->started, unit);
+
+}
+
+/**
+ * ordered_end_unit
+ * @param context a unit's srcSAX context
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param URI the namespace of tag
+ *
+ * Deliver end_unit after that of all preceding units.
+ */
+static void ordered_end_unit(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI) {
+
+    srcsax_parallel_parse * parse = ((srcsax_parallel_handler *)context->handler)->parse;
+    size_t unit = context->unit_count - 1;
+
+    parse->order->wait(parse->order->next_end, unit);
+
+    parse->context->handler->end_unit(context, localname, prefix, URI);
+
+    parse->order->done(parse->order->next_end, parse->order->ended, unit);
+
+}
+
+/**
+ * capture_end_root
+ * @param context the header's srcSAX context
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param URI the namespace of tag
+ *
+ * Save the root for delivering end_root once all units are parsed.
+ */
+static void capture_end_root(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI) {
+
+    srcsax_parallel_parse * parse = ((srcsax_parallel_handler *)context->handler)->parse;
+
+    parse->root_localname = localname;
+    parse->has_root_prefix = prefix != 0;
+    if(prefix) parse->root_prefix = prefix;
+    parse->has_root_URI = URI != 0;
+    if(URI) parse->root_URI = URI;
+
+}
+
+/**
+ * parse_document
+ * @param parse the parallel parse
+ * @param document the document to parse (null terminated)
+ * @param handler the callbacks
+ * @param data the user data for the callbacks
+ * @param unit_count the number of units preceding the document's
+ * @param document_origin start of the content of the complete document, offset -1 if the document is its prefix
+ * @param input_origin position of that content in the complete document
+ *
+ * Parse a header or unit document with its own srcSAX context.  The document is used
+ * in place, and libxml2 expects a static buffer to be null terminated (see append_padding).
+ * On error, the error is saved as the last error of the parallel parse's context.
+ */
+static void parse_document(srcsax_parallel_parse * parse, const std::vector<char> & document, srcsax_handler * handler, void * data, int unit_count,
+                           const input_position & document_origin, const input_position & input_origin) {
+
+    xmlParserInputBufferPtr input = xmlParserInputBufferCreateStatic(&document.front(), (int)document.size() - 1, XML_CHAR_ENCODING_NONE);
+    struct srcsax_context * context = srcsax_create_context_parser_input_buffer(input);
+
+    if(context == 0) {
+
+        std::lock_guard<std::mutex> lock(parse->status_mutex);
+        parse->status = -1;
+        parse->stop = true;
+        return;
+
+    }
+
+    context->free_input = 1;
+    context->data = data;
+    context->handler = handler;
+    context->unit_count = unit_count;
+    context->element_filter = parse->context->element_filter;
+    context->parse_function = parse->context->parse_function;
+    context->coalesce_characters = parse->context->coalesce_characters;
+    xmlCtxtUseOptions(context->libxml2_context, parse->options);
+
+    xmlSAXHandlerPtr save_sax = context->libxml2_context->sax;
+    xmlSAXHandler sax = srcsax_sax2_factory();
+    context->libxml2_context->sax = &sax;
+
+    sax2_srcsax_handler state;
+    state.context = context;
+    state.document_origin = document_origin;
+    state.input_origin = input_origin;
+    context->libxml2_context->_private = &state;
+    context->element_table = &state.element_table;
+
+    int status = 0;
+    try {
+
+        status = xmlParseDocument(context->libxml2_context);
+
+    } catch(...) {
+
+        status = -1;
+
+    }
+
+    context->element_table = 0;
+    context->libxml2_context->sax = save_sax;
+
+    if(context->terminate) {
+
+        parse->stop = true;
+
+    } else if(status != 0) {
+
+        std::lock_guard<std::mutex> lock(parse->status_mutex);
+        if(parse->status == 0) {
+
+            parse->status = -1;
+            xmlErrorPtr ep = xmlCtxtGetLastError(context->libxml2_context);
+            if(ep) xmlCopyError(ep, &parse->context->libxml2_context->lastError);
+
+        }
+
+        parse->stop = true;
+
+    }
+
+    // the subscriptions belong to the parallel parse's context
+    context->element_filter = 0;
+    srcsax_free_context(context);
+
+}
+
+/**
+ * append
+ * @param document the document being built
+ * @param begin the start of the data to append
+ * @param size the size of the data to append
+ *
+ * Append data to a document.
+ */
+static inline void append(std::vector<char> & document, const char * begin, size_t size) {
+
+    document.insert(document.end(), begin, begin + size);
+
+}
+
+/**
+ * append_end_tag
+ * @param document the document being built
+ * @param qname the qualified name of the element
+ *
+ * Append an end tag to a document.
+ */
+static inline void append_end_tag(std::vector<char> & document, const std::string & qname) {
+
+    document.push_back('<');
+    document.push_back('/');
+    append(document, qname.data(), qname.size());
+    document.push_back('>');
+
+}
+
+/**
+ * append_padding
+ * @param document the document being built
+ *
+ * End a document with the padding and null terminator of a static input buffer.
+ */
+static inline void append_padding(std::vector<char> & document) {
+
+    document.insert(document.end(), STATIC_INPUT_PADDING, ' ');
+    document.push_back('\0');
+
+}
+
+/**
+ * advance_lines
+ * @param pos the start of the data, updated to its end
+ * @param end the end of the data
+ * @param line the line at pos, updated to that at end
+ * @param line_start the start of the line at pos, updated to that at end
+ *
+ * Count the lines of data.
+ */
+static inline void advance_lines(const char *& pos, const char * end, int & line, const char *& line_start) {
+
+    const char * newline;
+    while((newline = (const char *)memchr(pos, '\n', end - pos)) != 0) {
+
+        ++line;
+        pos = line_start = newline + 1;
+
+    }
+
+    pos = end;
+
+}
+
+/**
+ * locate_units
+ * @param parse the parallel parse
+ *
+ * Find where the content of each unit document starts, in the unit document and in the
+ * complete document, so positions in the unit documents can be reported in the complete one.
+ */
+static void locate_units(srcsax_parallel_parse * parse) {
+
+    const srcml_document_scan & scan = parse->scan;
+
+    // the content follows the declaration and root start tag in a unit document
+    std::vector<char> prefix;
+    append(prefix, parse->buffer + scan.declaration_offset, scan.declaration_length);
+    append(prefix, parse->buffer + scan.root_offset, scan.root_length);
+
+    const char * pos = &prefix.front();
+    const char * line_start = pos;
+    parse->unit_origin.offset = (long)prefix.size();
+    parse->unit_origin.line = 1;
+    advance_lines(pos, pos + prefix.size(), parse->unit_origin.line, line_start);
+    parse->unit_origin.column = (int)(pos - line_start) + 1;
+
+    pos = line_start = parse->buffer;
+    int line = 1;
+    parse->input_origins.resize(scan.units.size());
+    for(size_t unit = 0; unit < scan.units.size(); ++unit) {
+
+        const srcml_unit_range & range = scan.units[unit];
+        const char * begin = parse->buffer + (unit == 0 ? range.offset : range.gap_offset);
+        advance_lines(pos, begin, line, line_start);
+
+        input_position & origin = parse->input_origins[unit];
+        origin.offset = (long)(begin - parse->buffer);
+        origin.line = line;
+        origin.column = (int)(begin - line_start) + 1;
+
+    }
+
+}
+
+/**
+ * parse_header
+ * @param parse the parallel parse
+ *
+ * Parse the prolog, root and meta tags on the calling thread, delivering the document
+ * and root events with the context's user data.  The first unit's start tag is
+ * included so that the archive is detected as in a sequential parse.
+ */
+static void parse_header(srcsax_parallel_parse * parse) {
+
+    const srcml_unit_range & first = parse->scan.units.front();
+
+    std::vector<char> document;
+    append(document, parse->buffer, first.offset + first.start_tag_length);
+    if(parse->buffer[first.offset + first.start_tag_length - 2] != '/')
+        append_end_tag(document, parse->scan.root_qname);
+    append_end_tag(document, parse->scan.root_qname);
+    append_padding(document);
+
+    srcsax_parallel_handler header = { *parse->context->handler, parse };
+    header.handler.start_unit = 0;
+    header.handler.start_element = 0;
+    header.handler.end_unit = 0;
+    header.handler.end_element = 0;
+    header.handler.characters_unit = 0;
+    header.handler.end_root = capture_end_root;
+    header.handler.end_document = 0;
+
+    parse_document(parse, document, &header.handler, parse->context->data, 0, input_position(), input_position());
+
+}
+
+/**
+ * parse_units
+ * @param parse the parallel parse
+ * @param data user data for the callbacks
+ *
+ * Worker parsing units until none are left.
+ */
+static void parse_units(srcsax_parallel_parse * parse, void * data) {
+
+    xmlGenericErrorFunc error_handler = (xmlGenericErrorFunc) libxml_error;
+    initGenericErrorDefaultFunc(&error_handler);
+
+    srcsax_parallel_handler handler = { parse->unit_handler, parse };
+
+    const srcml_document_scan & scan = parse->scan;
+    const size_t unit_count = scan.units.size();
+
+    std::vector<char> document;
+    while(!parse->stop) {
+
+        size_t unit = parse->next_unit++;
+        if(unit >= unit_count) break;
+
+        // root level content before a unit is parsed with it, the content before the first with the header
+        const srcml_unit_range & range = scan.units[unit];
+        size_t begin = unit == 0 ? range.offset : range.gap_offset;
+        size_t end = unit == unit_count - 1 ? scan.root_end_offset : range.offset + range.length;
+
+        document.clear();
+        append(document, parse->buffer + scan.declaration_offset, scan.declaration_length);
+        append(document, parse->buffer + scan.root_offset, scan.root_length);
+        append(document, parse->buffer + begin, end - begin);
+        append_end_tag(document, scan.root_qname);
+        append_padding(document);
+
+        parse_document(parse, document, &handler.handler, data, (int)unit, parse->unit_origin, parse->input_origins[unit]);
+
+        if(parse->order) {
+
+            parse->order->done(parse->order->next_start, parse->order->started, unit);
+            parse->order->done(parse->order->next_end, parse->order->ended, unit);
+
+        }
+
+    }
+
+}
+
+/**
+ * srcsax_parse_units
+ * @param context srcSAX context
+ * @param buffer the complete srcML document
+ * @param size the size of the document
+ * @param ignore_encoding the document is already UTF-8, ignore its declared encoding
+ * @param thread_count number of worker threads
+ * @param thread_data user data for each worker thread (0 to use the context's)
+ * @param ordered deliver the start_unit calls, and the end_unit calls, each in document order
+ *
+ * Parse the units of a srcML archive in parallel.  The document prolog, root and meta tags
+ * are parsed on the calling thread, each unit is parsed on a worker with a document made
+ * of the XML declaration, the root start tag and the unit.
+ *
+ * @returns 0 on success, -1 on error, and 1 if the document can not be split into units.
+ */
+int srcsax_parse_units(struct srcsax_context * context, const char * buffer, size_t size, int ignore_encoding,
+                       int thread_count, void ** thread_data, int ordered) {
+
+    srcml_document_scan scan;
+    if(!srcml_scan_document(buffer, size, scan)) return 1;
+
+    int options = XML_PARSE_COMPACT | XML_PARSE_HUGE | XML_PARSE_NODICT;
+    if(ignore_encoding) options |= XML_PARSE_IGNORE_ENC;
+
+    srcsax_parallel_parse parse(context, buffer, scan, options);
+
+    parse_header(&parse);
+    if(parse.status != 0) return -1;
+    if(parse.stop) return 0;
+
+    locate_units(&parse);
+
+    // units are parsed without the document and root events
+    parse.unit_handler = *context->handler;
+    parse.unit_handler.start_document = 0;
+    parse.unit_handler.end_document = 0;
+    parse.unit_handler.start_root = 0;
+    parse.unit_handler.end_root = 0;
+    parse.unit_handler.meta_tag = 0;
+
+    srcsax_unit_order order(scan.units.size());
+    if(ordered) {
+
+        parse.order = &order;
+        if(context->handler->start_unit) parse.unit_handler.start_unit = ordered_start_unit;
+        if(context->handler->end_unit) parse.unit_handler.end_unit = ordered_end_unit;
+
+    }
+
+    size_t threads = thread_count > 0 ? (size_t)thread_count : std::thread::hardware_concurrency();
+    if(threads == 0) threads = 1;
+    if(threads > scan.units.size()) threads = scan.units.size();
+
+    std::vector<std::thread> workers;
+    for(size_t thread = 1; thread < threads; ++thread) {
+
+        try {
+
+            workers.push_back(std::thread(parse_units, &parse, thread_data ? thread_data[thread] : context->data));
+
+        } catch(const std::system_error &) {
+
+            break;
+
+        }
+
+    }
+
+    parse_units(&parse, thread_data ? thread_data[0] : context->data);
+
+    for(std::vector<std::thread>::iterator itr = workers.begin(); itr != workers.end(); ++itr)
+        itr->join();
+
+    context->is_archive = 1;
+    context->unit_count = (int)scan.units.size();
+
+    if(parse.status != 0) return -1;
+    if(parse.stop) return 0;
+
+    if(context->handler->end_root)
+        context->handler->end_root(context, parse.root_localname.c_str(), parse.has_root_prefix ? parse.root_prefix.c_str() : 0,
+                                   parse.has_root_URI ? parse.root_URI.c_str() : 0);
+
+    if(context->terminate) return 0;
+
+    if(context->handler->end_document)
+        context->handler->end_document(context);
+
+    return 0;
+
+}
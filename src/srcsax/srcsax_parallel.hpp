@@ -0,0 +1,59 @@
+/**
+ * @file srcsax_parallel.hpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcML SAX2 Framework.
+ *
+ * The srcML SAX2 Framework is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML SAX2 Framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML SAX2 Framework; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INCLUDED_SRCSAX_PARALLEL_HPP
+#define INCLUDED_SRCSAX_PARALLEL_HPP
+
+#include <srcsax.h>
+
+#include <libxml/parserInternals.h>
+
+/**
+ * STATIC_INPUT_PADDING
+ *
+ * Whitespace following a document in a static libxml2 input buffer.  libxml2 shrinks
+ * a static buffer by moving its start, but then moves the parse position as if the
+ * content had moved, so the shrinking, done within 2 * INPUT_CHUNK of the end of the
+ * input, is kept to the whitespace after the root element.
+ */
+static const size_t STATIC_INPUT_PADDING = 2 * INPUT_CHUNK;
+
+/**
+ * srcsax_parse_units
+ * @param context srcSAX context
+ * @param buffer the complete srcML document
+ * @param size the size of the document
+ * @param ignore_encoding the document is already UTF-8, ignore its declared encoding
+ * @param thread_count number of worker threads
+ * @param thread_data user data for each worker thread (0 to use the context's)
+ * @param ordered deliver the start_unit calls, and the end_unit calls, each in document order
+ *
+ * Parse the units of a srcML archive in parallel.  The document prolog, root and meta tags
+ * are parsed on the calling thread, each unit is parsed on a worker with a document made
+ * of the XML declaration, the root start tag and the unit.
+ *
+ * @returns 0 on success, -1 on error, and 1 if the document can not be split into units.
+ */
+int srcsax_parse_units(struct srcsax_context * context, const char * buffer, size_t size, int ignore_encoding,
+                       int thread_count, void ** thread_data, int ordered);
+
+#endif
@@ -0,0 +1,556 @@
+/**
+ * @file srcsax_reader.cpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <srcsax_reader.h>
+
+#include <cstring>
+#include <new>
+#include <vector>
+
+/** size of the input chunks parsed for each batch of events */
+static const size_t READER_CHUNK_SIZE = 1 << 14;
+
+/**
+ * srcsax_event_arena
+ *
+ * Storage for the data of a batch of events.  Rewound, without freeing
+ * its blocks, when the next batch is parsed.
+ */
+struct srcsax_event_arena {
+
+    /** minimum size of a block */
+    static const size_t BLOCK_SIZE = 1 << 14;
+
+    /** the blocks of storage */
+    std::vector<std::vector<char> > blocks;
+
+    /** the block currently allocated from */
+    size_t current_block;
+
+    /** the next free byte in the current block */
+    size_t offset;
+
+    /** default constructor */
+    srcsax_event_arena() : blocks(), current_block(0), offset(0) {}
+
+    /**
+     * allocate
+     * @param size number of bytes
+     *
+     * @returns pointer aligned storage for size bytes.
+     */
+    void * allocate(size_t size) {
+
+        const size_t alignment = sizeof(void *);
+        offset = (offset + alignment - 1) & ~(alignment - 1);
+
+        while(current_block < blocks.size() && offset + size > blocks[current_block].size()) {
+
+            ++current_block;
+            offset = 0;
+
+        }
+
+        if(current_block == blocks.size()) {
+
+            blocks.push_back(std::vector<char>(size > BLOCK_SIZE ? size : BLOCK_SIZE));
+            offset = 0;
+
+        }
+
+        void * storage = &blocks[current_block][offset];
+        offset += size;
+
+        return storage;
+
+    }
+
+    /**
+     * copy
+     * @param value characters to copy
+     * @param length the number of characters
+     *
+     * @returns a null terminated copy of the characters.
+     */
+    const char * copy(const char * value, size_t length) {
+
+        char * storage = (char *)allocate(length + 1);
+        memcpy(storage, value, length);
+        storage[length] = '\0';
+
+        return storage;
+
+    }
+
+    /**
+     * rewind
+     *
+     * Reuse all the storage.
+     */
+    void rewind() {
+
+        current_block = 0;
+        offset = 0;
+
+    }
+
+};
+
+/**
+ * srcsax_reader
+ *
+ * A pull reader parsing the input of a srcSAX context in chunks with a push
+ * context, and queuing the events of each chunk.
+ */
+struct srcsax_reader {
+
+    /** the context providing the input */
+    struct srcsax_context * source;
+
+    /** push context parsing the input */
+    struct srcsax_context * push;
+
+    /** the callbacks queuing the events */
+    struct srcsax_handler handler;
+
+    /** the events of the current chunk */
+    std::vector<srcsax_event> events;
+
+    /** the next event to return */
+    size_t next_event;
+
+    /** data of the events of the current chunk */
+    srcsax_event_arena arena;
+
+    /** number of bytes of the source's input buffer parsed */
+    size_t consumed;
+
+    /** the end of the input was parsed */
+    bool done;
+
+    /** 0 or -1 after an error */
+    int status;
+
+};
+
+/**
+ * queue_event
+ * @param context the push context
+ * @param type the kind of event
+ *
+ * Queue an event of the current chunk.
+ *
+ * @returns the queued event.
+ */
+static srcsax_event & queue_event(struct srcsax_context * context, enum srcsax_event_type type) {
+
+    srcsax_reader * reader = (srcsax_reader *)context->data;
+
+    srcsax_event event;
+    memset(&event, 0, sizeof(event));
+    event.type = type;
+    event.element_id = context->element_id;
+    event.stack_size = context->stack_size;
+
+    reader->events.push_back(event);
+
+    return reader->events.back();
+
+}
+
+/**
+ * queue_start_tag
+ * @param context the push context
+ * @param type the kind of event
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param URI the namespace of tag
+ * @param num_namespaces number of namespaces definitions
+ * @param namespaces the defined namespaces
+ * @param num_attributes the number of attributes on the tag
+ * @param attributes list of attributes
+ *
+ * Queue a start tag event.  The names are interned by libxml2 for the
+ * parse and used as is, the namespaces and attributes are copied.
+ */
+static void queue_start_tag(struct srcsax_context * context, enum srcsax_event_type type,
+                            const char * localname, const char * prefix, const char * URI,
+                            int num_namespaces, const struct srcsax_namespace * namespaces,
+                            int num_attributes, const struct srcsax_attribute * attributes) {
+
+    srcsax_reader * reader = (srcsax_reader *)context->data;
+
+    srcsax_event & event = queue_event(context, type);
+    event.localname = localname;
+    event.prefix = prefix;
+    event.URI = URI;
+
+    event.num_namespaces = num_namespaces;
+    if(num_namespaces) {
+
+        srcsax_namespace * copy = (srcsax_namespace *)reader->arena.allocate(num_namespaces * sizeof(srcsax_namespace));
+        memcpy(copy, namespaces, num_namespaces * sizeof(srcsax_namespace));
+        event.namespaces = copy;
+
+    }
+
+    event.num_attributes = num_attributes;
+    if(num_attributes) {
+
+        srcsax_attribute * copy = (srcsax_attribute *)reader->arena.allocate(num_attributes * sizeof(srcsax_attribute));
+        for(int pos = 0; pos < num_attributes; ++pos) {
+
+            copy[pos] = attributes[pos];
+            copy[pos].value = reader->arena.copy(attributes[pos].value, strlen(attributes[pos].value));
+
+        }
+
+        event.attributes = copy;
+
+    }
+
+}
+
+/**
+ * queue_end_tag
+ * @param context the push context
+ * @param type the kind of event
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param URI the namespace of tag
+ *
+ * Queue an end tag event.
+ */
+static void queue_end_tag(struct srcsax_context * context, enum srcsax_event_type type,
+                          const char * localname, const char * prefix, const char * URI) {
+
+    srcsax_event & event = queue_event(context, type);
+    event.localname = localname;
+    event.prefix = prefix;
+    event.URI = URI;
+
+}
+
+/**
+ * queue_characters
+ * @param context the push context
+ * @param type the kind of event
+ * @param ch the characters
+ * @param len number of characters
+ *
+ * Queue a characters event with a copy of the characters.
+ */
+static void queue_characters(struct srcsax_context * context, enum srcsax_event_type type, const char * ch, int len) {
+
+    srcsax_reader * reader = (srcsax_reader *)context->data;
+
+    srcsax_event & event = queue_event(context, type);
+    event.value = reader->arena.copy(ch, len);
+    event.length = len;
+
+}
+
+/** start_document callback of the reader */
+static void reader_start_document(struct srcsax_context * context) {
+
+    queue_event(context, SRCSAX_START_DOCUMENT);
+
+}
+
+/** end_document callback of the reader */
+static void reader_end_document(struct srcsax_context * context) {
+
+    queue_event(context, SRCSAX_END_DOCUMENT);
+
+}
+
+/** start_root callback of the reader */
+static void reader_start_root(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                              int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                              const struct srcsax_attribute * attributes) {
+
+    queue_start_tag(context, SRCSAX_START_ROOT, localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+}
+
+/** start_unit callback of the reader */
+static void reader_start_unit(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                              int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                              const struct srcsax_attribute * attributes) {
+
+    queue_start_tag(context, SRCSAX_START_UNIT, localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+}
+
+/** start_element callback of the reader */
+static void reader_start_element(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                                 int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                                 const struct srcsax_attribute * attributes) {
+
+    queue_start_tag(context, SRCSAX_START_ELEMENT, localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+}
+
+/** end_root callback of the reader */
+static void reader_end_root(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI) {
+
+    queue_end_tag(context, SRCSAX_END_ROOT, localname, prefix, URI);
+
+}
+
+/** end_unit callback of the reader */
+static void reader_end_unit(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI) {
+
+    queue_end_tag(context, SRCSAX_END_UNIT, localname, prefix, URI);
+
+}
+
+/** end_element callback of the reader */
+static void reader_end_element(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI) {
+
+    queue_end_tag(context, SRCSAX_END_ELEMENT, localname, prefix, URI);
+
+}
+
+/** characters_root callback of the reader */
+static void reader_characters_root(struct srcsax_context * context, const char * ch, int len) {
+
+    queue_characters(context, SRCSAX_CHARACTERS_ROOT, ch, len);
+
+}
+
+/** characters_unit callback of the reader */
+static void reader_characters_unit(struct srcsax_context * context, const char * ch, int len) {
+
+    queue_characters(context, SRCSAX_CHARACTERS_UNIT, ch, len);
+
+}
+
+/** meta_tag callback of the reader */
+static void reader_meta_tag(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                            int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                            const struct srcsax_attribute * attributes) {
+
+    queue_start_tag(context, SRCSAX_META_TAG, localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+}
+
+/** comment callback of the reader */
+static void reader_comment(struct srcsax_context * context, const char * value) {
+
+    queue_characters(context, SRCSAX_COMMENT, value, (int)strlen(value));
+
+}
+
+/** cdata_block callback of the reader */
+static void reader_cdata_block(struct srcsax_context * context, const char * value, int len) {
+
+    queue_characters(context, SRCSAX_CDATA_BLOCK, value, len);
+
+}
+
+/** processing_instruction callback of the reader */
+static void reader_processing_instruction(struct srcsax_context * context, const char * target, const char * data) {
+
+    srcsax_reader * reader = (srcsax_reader *)context->data;
+
+    queue_characters(context, SRCSAX_PROCESSING_INSTRUCTION, data ? data : "", data ? (int)strlen(data) : 0);
+    reader->events.back().target = reader->arena.copy(target, strlen(target));
+
+}
+
+/**
+ * srcsax_create_reader
+ * @param context a srcSAX context providing the input
+ *
+ * Create a pull reader over the input of a context created by one of the
+ * srcsax_create_context_* functions.  The context must outlive the reader
+ * and is not parsed itself.
+ *
+ * @returns the reader or 0 on error.
+ */
+struct srcsax_reader * srcsax_create_reader(struct srcsax_context * context) {
+
+    if(context == 0 || context->push_state || context->input == 0) return 0;
+
+    struct srcsax_context * push = srcsax_create_push_context(0);
+    if(push == 0) return 0;
+
+    // converted input is already UTF-8
+    if(context->input->encoder)
+        xmlCtxtUseOptions(push->libxml2_context, XML_PARSE_COMPACT | XML_PARSE_HUGE | XML_PARSE_NODICT | XML_PARSE_IGNORE_ENC);
+
+    srcsax_reader * reader = new(std::nothrow) srcsax_reader;
+    if(reader == 0) {
+
+        srcsax_free_context(push);
+        return 0;
+
+    }
+
+    reader->source = context;
+    reader->push = push;
+    reader->next_event = 0;
+    reader->consumed = 0;
+    reader->done = false;
+    reader->status = 0;
+
+    memset(&reader->handler, 0, sizeof(reader->handler));
+    reader->handler.start_document = reader_start_document;
+    reader->handler.end_document = reader_end_document;
+    reader->handler.start_root = reader_start_root;
+    reader->handler.start_unit = reader_start_unit;
+    reader->handler.start_element = reader_start_element;
+    reader->handler.end_root = reader_end_root;
+    reader->handler.end_unit = reader_end_unit;
+    reader->handler.end_element = reader_end_element;
+    reader->handler.characters_root = reader_characters_root;
+    reader->handler.characters_unit = reader_characters_unit;
+    reader->handler.meta_tag = reader_meta_tag;
+    reader->handler.comment = reader_comment;
+    reader->handler.cdata_block = reader_cdata_block;
+    reader->handler.processing_instruction = reader_processing_instruction;
+    reader->handler.start_function = 0;
+    reader->handler.end_function = 0;
+
+    push->data = reader;
+    push->handler = &reader->handler;
+    push->srcsax_error = context->srcsax_error;
+
+    return reader;
+
+}
+
+/**
+ * parse_next_chunk
+ * @param reader a srcSAX reader
+ *
+ * Parse the next chunk of the source's input, queuing its events.
+ *
+ * @returns 0 on success -1 on error.
+ */
+static int parse_next_chunk(srcsax_reader * reader) {
+
+    xmlParserInputBufferPtr input = reader->source->input;
+
+    size_t use = xmlBufUse(input->buffer);
+    if(reader->consumed == use && input->readcallback) {
+
+        // all of the read input is parsed
+        xmlBufShrink(input->buffer, reader->consumed);
+        reader->consumed = 0;
+
+        if(xmlParserInputBufferGrow(input, (int)READER_CHUNK_SIZE) < 0) return -1;
+
+        use = xmlBufUse(input->buffer);
+
+    }
+
+    size_t size = use - reader->consumed;
+    if(size > READER_CHUNK_SIZE) size = READER_CHUNK_SIZE;
+
+    int is_last = input->readcallback ? size == 0 : reader->consumed + size == use;
+
+    const char * chunk = (const char *)xmlBufContent(input->buffer) + reader->consumed;
+    reader->consumed += size;
+    reader->done = is_last != 0 || reader->push->terminate;
+
+    return srcsax_parse_chunk(reader->push, chunk, size, is_last);
+
+}
+
+/**
+ * srcsax_reader_next
+ * @param reader a srcSAX reader
+ * @param event location for the next event
+ *
+ * Get the next event, parsing more of the input when needed.  The event and
+ * its data are valid until the next call.  Element and attribute names and
+ * namespaces are libxml2's interned strings, valid until the reader is freed.
+ *
+ * @returns 1 for an event, 0 at the end of the document and -1 on error.
+ */
+int srcsax_reader_next(struct srcsax_reader * reader, const struct srcsax_event ** event) {
+
+    if(reader == 0 || event == 0) return -1;
+
+    *event = 0;
+
+    if(reader->status != 0) return -1;
+
+    while(reader->next_event == reader->events.size()) {
+
+        if(reader->done) return 0;
+
+        reader->events.clear();
+        reader->next_event = 0;
+        reader->arena.rewind();
+
+        try {
+
+            reader->status = parse_next_chunk(reader);
+
+        } catch(...) {
+
+            reader->status = -1;
+
+        }
+
+        if(reader->status != 0) return -1;
+
+    }
+
+    *event = &reader->events[reader->next_event++];
+
+    return 1;
+
+}
+
+/**
+ * srcsax_reader_context
+ * @param reader a srcSAX reader
+ *
+ * The context of the reader's parse, e.g., for the unit count,
+ * element names or to stop the parser.
+ *
+ * @returns the context of the reader's parse.
+ */
+struct srcsax_context * srcsax_reader_context(struct srcsax_reader * reader) {
+
+    if(reader == 0) return 0;
+
+    return reader->push;
+
+}
+
+/**
+ * srcsax_free_reader
+ * @param reader a srcSAX reader
+ *
+ * Free a reader created with srcsax_create_reader.
+ */
+void srcsax_free_reader(struct srcsax_reader * reader) {
+
+    if(reader == 0) return;
+
+    srcsax_free_context(reader->push);
+
+    delete reader;
+
+}
@@ -0,0 +1,116 @@
+/**
+ * @file srcsax_reader.h
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INCLUDED_SRCSAX_READER_H
+#define INCLUDED_SRCSAX_READER_H
+
+#include <srcsax.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * srcsax_event_type
+ *
+ * The kind of a srcSAX event, one for each srcsax_handler callback.
+ */
+enum srcsax_event_type {
+
+    SRCSAX_START_DOCUMENT,
+    SRCSAX_END_DOCUMENT,
+    SRCSAX_START_ROOT,
+    SRCSAX_START_UNIT,
+    SRCSAX_START_ELEMENT,
+    SRCSAX_END_ROOT,
+    SRCSAX_END_UNIT,
+    SRCSAX_END_ELEMENT,
+    SRCSAX_CHARACTERS_ROOT,
+    SRCSAX_CHARACTERS_UNIT,
+    SRCSAX_META_TAG,
+    SRCSAX_COMMENT,
+    SRCSAX_CDATA_BLOCK,
+    SRCSAX_PROCESSING_INSTRUCTION
+
+};
+
+/**
+ * srcsax_event
+ *
+ * A srcSAX event with the arguments of its callback.  Members not
+ * used by the event type are 0.
+ */
+struct srcsax_event {
+
+    /** the kind of event */
+    enum srcsax_event_type type;
+
+    /** interned ID (srcml_element_id) of the element of a start/end/meta tag event */
+    int element_id;
+
+    /** size of the srcML element stack at the event */
+    size_t stack_size;
+
+    /** the name of the element tag */
+    const char * localname;
+
+    /** the tag prefix */
+    const char * prefix;
+
+    /** the namespace of the tag */
+    const char * URI;
+
+    /** number of namespace definitions */
+    int num_namespaces;
+
+    /** the defined namespaces */
+    const struct srcsax_namespace * namespaces;
+
+    /** the number of attributes on the tag */
+    int num_attributes;
+
+    /** list of attributes */
+    const struct srcsax_attribute * attributes;
+
+    /** the characters, comment, cdata or processing instruction data (null terminated) */
+    const char * value;
+
+    /** number of characters in value */
+    int length;
+
+    /** the processing instruction target */
+    const char * target;
+
+};
+
+/** srcSAX pull reader */
+struct srcsax_reader;
+
+/* srcSAX reader functions */
+struct srcsax_reader * srcsax_create_reader(struct srcsax_context * context);
+int srcsax_reader_next(struct srcsax_reader * reader, const struct srcsax_event ** event);
+struct srcsax_context * srcsax_reader_context(struct srcsax_reader * reader);
+void srcsax_free_reader(struct srcsax_reader * reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,551 @@
+/**
+ * @file srcsax_stats.cpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <srcsax_stats.hpp>
+#include <sax2_srcsax_handler.hpp>
+
+#include <algorithm>
+#include <new>
+
+/**
+ * callback_timer
+ *
+ * Adds the time until it goes out of scope to the callback time.
+ */
+struct callback_timer {
+
+    /** statistics collection */
+    srcsax_stats_state * state;
+
+    /** start of the callback */
+    std::chrono::steady_clock::time_point start;
+
+    /** constructor */
+    callback_timer(srcsax_stats_state * state)
+        : state(state), start(state->timing ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()) {}
+
+    /** destructor */
+    ~callback_timer() {
+
+        if(state->timing)
+            state->stats.callback_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    }
+
+};
+
+/**
+ * stats_start_document
+ * @param context a srcSAX context
+ *
+ * Count and forward start_document.
+ */
+static void stats_start_document(struct srcsax_context * context) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    ++state->stats.start_document;
+
+    callback_timer timer(state);
+    state->handler->start_document(context);
+
+}
+
+/**
+ * stats_end_document
+ * @param context a srcSAX context
+ *
+ * Count and forward end_document.
+ */
+static void stats_end_document(struct srcsax_context * context) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    ++state->stats.end_document;
+
+    callback_timer timer(state);
+    state->handler->end_document(context);
+
+}
+
+/**
+ * stats_start_root
+ * @param context a srcSAX context
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param URI the namespace of tag
+ * @param num_namespaces number of namespaces definitions
+ * @param namespaces the defined namespaces
+ * @param num_attributes the number of attributes on the tag
+ * @param attributes list of attributes
+ *
+ * Count and forward start_root.
+ */
+static void stats_start_root(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                             int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                             const struct srcsax_attribute * attributes) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    ++state->stats.start_root;
+
+    callback_timer timer(state);
+    state->handler->start_root(context, localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+}
+
+/**
+ * stats_start_unit
+ * @param context a srcSAX context
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param URI the namespace of tag
+ * @param num_namespaces number of namespaces definitions
+ * @param namespaces the defined namespaces
+ * @param num_attributes the number of attributes on the tag
+ * @param attributes list of attributes
+ *
+ * Count and forward start_unit.
+ */
+static void stats_start_unit(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                             int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                             const struct srcsax_attribute * attributes) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    ++state->stats.start_unit;
+
+    callback_timer timer(state);
+    state->handler->start_unit(context, localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+}
+
+/**
+ * stats_start_element
+ * @param context a srcSAX context
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param URI the namespace of tag
+ * @param num_namespaces number of namespaces definitions
+ * @param namespaces the defined namespaces
+ * @param num_attributes the number of attributes on the tag
+ * @param attributes list of attributes
+ *
+ * Count and forward start_element.
+ */
+static void stats_start_element(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                                int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                                const struct srcsax_attribute * attributes) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    ++state->stats.start_element;
+
+    callback_timer timer(state);
+    state->handler->start_element(context, localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+}
+
+/**
+ * stats_end_root
+ * @param context a srcSAX context
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param URI the namespace of tag
+ *
+ * Count and forward end_root.
+ */
+static void stats_end_root(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    ++state->stats.end_root;
+
+    callback_timer timer(state);
+    state->handler->end_root(context, localname, prefix, URI);
+
+}
+
+/**
+ * stats_end_unit
+ * @param context a srcSAX context
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param URI the namespace of tag
+ *
+ * Count and forward end_unit.
+ */
+static void stats_end_unit(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    ++state->stats.end_unit;
+
+    callback_timer timer(state);
+    state->handler->end_unit(context, localname, prefix, URI);
+
+}
+
+/**
+ * stats_end_element
+ * @param context a srcSAX context
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param URI the namespace of tag
+ *
+ * Count and forward end_element.
+ */
+static void stats_end_element(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    ++state->stats.end_element;
+
+    callback_timer timer(state);
+    state->handler->end_element(context, localname, prefix, URI);
+
+}
+
+/**
+ * stats_characters_root
+ * @param context a srcSAX context
+ * @param ch the characers
+ * @param len number of characters
+ *
+ * Count and forward characters_root.
+ */
+static void stats_characters_root(struct srcsax_context * context, const char * ch, int len) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    ++state->stats.characters_root;
+
+    callback_timer timer(state);
+    state->handler->characters_root(context, ch, len);
+
+}
+
+/**
+ * stats_characters_unit
+ * @param context a srcSAX context
+ * @param ch the characers
+ * @param len number of characters
+ *
+ * Count and forward characters_unit.
+ */
+static void stats_characters_unit(struct srcsax_context * context, const char * ch, int len) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    ++state->stats.characters_unit;
+
+    callback_timer timer(state);
+    state->handler->characters_unit(context, ch, len);
+
+}
+
+/**
+ * stats_meta_tag
+ * @param context a srcSAX context
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param URI the namespace of tag
+ * @param num_namespaces number of namespaces definitions
+ * @param namespaces the defined namespaces
+ * @param num_attributes the number of attributes on the tag
+ * @param attributes list of attributes
+ *
+ * Count and forward meta_tag.
+ */
+static void stats_meta_tag(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                           int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                           const struct srcsax_attribute * attributes) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    ++state->stats.meta_tag;
+
+    callback_timer timer(state);
+    state->handler->meta_tag(context, localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+}
+
+/**
+ * stats_comment
+ * @param context a srcSAX context
+ * @param value the comment content
+ *
+ * Count and forward comment.
+ */
+static void stats_comment(struct srcsax_context * context, const char * value) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    ++state->stats.comment;
+
+    callback_timer timer(state);
+    state->handler->comment(context, value);
+
+}
+
+/**
+ * stats_cdata_block
+ * @param context a srcSAX context
+ * @param value the pcdata content
+ * @param len the block length
+ *
+ * Count and forward cdata_block.
+ */
+static void stats_cdata_block(struct srcsax_context * context, const char * value, int len) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    ++state->stats.cdata_block;
+
+    callback_timer timer(state);
+    state->handler->cdata_block(context, value, len);
+
+}
+
+/**
+ * stats_processing_instruction
+ * @param context a srcSAX context
+ * @param target the processing instruction target.
+ * @param data the processing instruction data.
+ *
+ * Count and forward processing_instruction.
+ */
+static void stats_processing_instruction(struct srcsax_context * context, const char * target, const char * data) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    ++state->stats.processing_instruction;
+
+    callback_timer timer(state);
+    state->handler->processing_instruction(context, target, data);
+
+}
+
+/**
+ * stats_start_function
+ * @param context a srcSAX context
+ * @param name the function's name
+ * @param return_type the function return type
+ * @param num_parameters the number of parameters
+ * @param parameter_list a list of the function parameters
+ * @param is_decl indicates if the call is a function declaration (1) or definition (0)
+ *
+ * Count and forward start_function.
+ */
+static void stats_start_function(struct srcsax_context * context, const char * name, const char * return_type,
+                                 int num_parameters, const struct srcsax_declaration * parameter_list, int is_decl) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    ++state->stats.start_function;
+
+    callback_timer timer(state);
+    state->handler->start_function(context, name, return_type, num_parameters, parameter_list, is_decl);
+
+}
+
+/**
+ * stats_end_function
+ * @param context a srcSAX context
+ *
+ * Count and forward end_function.
+ */
+static void stats_end_function(struct srcsax_context * context) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    ++state->stats.end_function;
+
+    callback_timer timer(state);
+    state->handler->end_function(context);
+
+}
+
+/**
+ * srcsax_stats_begin
+ * @param context a srcSAX context
+ *
+ * Start collecting statistics for a parse call, if enabled,
+ * by installing the counting proxy for the callbacks of the handler.
+ */
+void srcsax_stats_begin(srcsax_context * context) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    if(state == 0 || state->handler) return;
+
+    srcsax_handler * handler = context->handler;
+
+    state->proxy.start_document = handler->start_document ? stats_start_document : 0;
+    state->proxy.end_document = handler->end_document ? stats_end_document : 0;
+    state->proxy.start_root = handler->start_root ? stats_start_root : 0;
+    state->proxy.start_unit = handler->start_unit ? stats_start_unit : 0;
+    state->proxy.start_element = handler->start_element ? stats_start_element : 0;
+    state->proxy.end_root = handler->end_root ? stats_end_root : 0;
+    state->proxy.end_unit = handler->end_unit ? stats_end_unit : 0;
+    state->proxy.end_element = handler->end_element ? stats_end_element : 0;
+    state->proxy.characters_root = handler->characters_root ? stats_characters_root : 0;
+    state->proxy.characters_unit = handler->characters_unit ? stats_characters_unit : 0;
+    state->proxy.meta_tag = handler->meta_tag ? stats_meta_tag : 0;
+    state->proxy.comment = handler->comment ? stats_comment : 0;
+    state->proxy.cdata_block = handler->cdata_block ? stats_cdata_block : 0;
+    state->proxy.processing_instruction = handler->processing_instruction ? stats_processing_instruction : 0;
+    state->proxy.start_function = handler->start_function ? stats_start_function : 0;
+    state->proxy.end_function = handler->end_function ? stats_end_function : 0;
+
+    state->handler = handler;
+    context->handler = &state->proxy;
+
+    state->parse_unit_count = context->unit_count;
+    if(state->timing) {
+
+        state->parse_callback_time = state->stats.callback_time;
+        state->parse_start = std::chrono::steady_clock::now();
+
+    }
+
+}
+
+/**
+ * SRCSAX_STATS_RESTORE
+ * @param CALLBACK a srcsax_handler callback
+ *
+ * Keep a callback changed through the proxy during the parse
+ * (e.g., disabled) in the user's handler.
+ */
+#define SRCSAX_STATS_RESTORE(CALLBACK) \
+    if(state->proxy.CALLBACK != stats_##CALLBACK) state->handler->CALLBACK = state->proxy.CALLBACK;
+
+/**
+ * srcsax_stats_end
+ * @param context a srcSAX context
+ * @param parse_state the parse state, 0 if not available
+ * @param bytes_consumed bytes of input consumed by the parse call
+ *
+ * Finish collecting statistics for a parse call restoring the user's handler.
+ */
+void srcsax_stats_end(srcsax_context * context, sax2_srcsax_handler * parse_state, size_t bytes_consumed) {
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    if(state == 0 || state->handler == 0) return;
+
+    SRCSAX_STATS_RESTORE(start_document)
+    SRCSAX_STATS_RESTORE(end_document)
+    SRCSAX_STATS_RESTORE(start_root)
+    SRCSAX_STATS_RESTORE(start_unit)
+    SRCSAX_STATS_RESTORE(start_element)
+    SRCSAX_STATS_RESTORE(end_root)
+    SRCSAX_STATS_RESTORE(end_unit)
+    SRCSAX_STATS_RESTORE(end_element)
+    SRCSAX_STATS_RESTORE(characters_root)
+    SRCSAX_STATS_RESTORE(characters_unit)
+    SRCSAX_STATS_RESTORE(meta_tag)
+    SRCSAX_STATS_RESTORE(comment)
+    SRCSAX_STATS_RESTORE(cdata_block)
+    SRCSAX_STATS_RESTORE(processing_instruction)
+    SRCSAX_STATS_RESTORE(start_function)
+    SRCSAX_STATS_RESTORE(end_function)
+
+    context->handler = state->handler;
+    state->handler = 0;
+
+    state->stats.bytes_consumed += bytes_consumed;
+    state->units += context->unit_count - state->parse_unit_count;
+
+    if(parse_state) {
+
+        state->stats.max_stack_depth = std::max(state->stats.max_stack_depth, parse_state->srcml_element_stack.max_size);
+
+        // counters of a push context's state persist between chunks, so they are moved into the statistics
+        state->stats.marshal_allocations += parse_state->element_buffer.allocations + parse_state->element_copies;
+        parse_state->element_buffer.allocations = 0;
+        parse_state->element_copies = 0;
+
+    }
+
+    if(state->timing) {
+
+        double parse_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - state->parse_start).count();
+        state->stats.parser_time += parse_time - (state->stats.callback_time - state->parse_callback_time);
+
+    }
+
+}
+
+#undef SRCSAX_STATS_RESTORE
+
+/**
+ * srcsax_enable_stats
+ * @param context a srcSAX context
+ * @param timing time the handler callbacks and the parser
+ *
+ * Start collecting statistics of the parses of the context.  If already
+ * enabled, the statistics are reset.  Parallel parses are not counted.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_enable_stats(struct srcsax_context * context, int timing) {
+
+    if(context == 0) return -1;
+
+    srcsax_stats_state * state = (srcsax_stats_state *)context->stats;
+    if(state == 0) {
+
+        state = new (std::nothrow) srcsax_stats_state;
+        if(state == 0) return -1;
+
+        context->stats = state;
+
+    }
+
+    state->stats = srcsax_stats();
+    state->units = 0;
+    state->timing = timing != 0;
+
+    return 0;
+
+}
+
+/**
+ * srcsax_disable_stats
+ * @param context a srcSAX context
+ *
+ * Stop collecting statistics.  Has no effect during a parse call.
+ */
+void srcsax_disable_stats(struct srcsax_context * context) {
+
+    if(context == 0 || context->stats == 0 || ((srcsax_stats_state *)context->stats)->handler) return;
+
+    delete (srcsax_stats_state *)context->stats;
+    context->stats = 0;
+
+}
+
+/**
+ * srcsax_get_stats
+ * @param context a srcSAX context
+ * @param stats storage for the statistics
+ *
+ * Get the statistics collected since they were enabled.
+ *
+ * @returns 0 on success -1 on error (including not enabled).
+ */
+int srcsax_get_stats(const struct srcsax_context * context, struct srcsax_stats * stats) {
+
+    if(context == 0 || context->stats == 0 || stats == 0) return -1;
+
+    const srcsax_stats_state * state = (const srcsax_stats_state *)context->stats;
+
+    *stats = state->stats;
+
+    double time = stats->callback_time + stats->parser_time;
+    stats->units_per_second = time > 0 ? state->units / time : 0;
+
+    return 0;
+
+}
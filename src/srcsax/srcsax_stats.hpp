@@ -0,0 +1,72 @@
+/**
+ * @file srcsax_stats.hpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INCLUDED_SRCSAX_STATS_HPP
+#define INCLUDED_SRCSAX_STATS_HPP
+
+#include <srcsax.h>
+
+#include <chrono>
+
+struct sax2_srcsax_handler;
+
+/**
+ * srcsax_stats_state
+ *
+ * Statistics collection of a context.  While parsing, the context's handler
+ * is replaced by a proxy that counts (and times) each callback before
+ * forwarding it to the user's handler.
+ */
+struct srcsax_stats_state {
+
+    /** default constructor */
+    srcsax_stats_state() : stats(), timing(false), proxy(), handler(0), units(0), parse_start(), parse_callback_time(0), parse_unit_count(0) {}
+
+    /** collected statistics */
+    srcsax_stats stats;
+
+    /** time the callbacks and the parser */
+    bool timing;
+
+    /** counting handler installed while parsing */
+    srcsax_handler proxy;
+
+    /** the user's handler, 0 when not parsing */
+    srcsax_handler * handler;
+
+    /** number of units parsed */
+    size_t units;
+
+    /** start of the current parse call */
+    std::chrono::steady_clock::time_point parse_start;
+
+    /** callback time at the start of the current parse call */
+    double parse_callback_time;
+
+    /** unit count of the context at the start of the current parse call */
+    int parse_unit_count;
+
+};
+
+/* statistics collection around a parse call */
+void srcsax_stats_begin(srcsax_context * context);
+void srcsax_stats_end(srcsax_context * context, sax2_srcsax_handler * state, size_t bytes_consumed);
+
+#endif
@@ -0,0 +1,384 @@
+/**
+ * @file srcsax_unit_index.cpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <srcsax.h>
+#include <srcml_unit_scan.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef _MSC_BUILD
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/** first line of a persisted unit index */
+static const char * const UNIT_INDEX_HEADER = "srcsax-unit-index 2\n";
+
+/**
+ * copy_string
+ * @param value a string
+ *
+ * @returns a malloc'd copy of the string.
+ */
+static char * copy_string(const std::string & value) {
+
+    char * copy = (char *)malloc(value.size() + 1);
+    if(copy == 0) return 0;
+
+    memcpy(copy, value.data(), value.size());
+    copy[value.size()] = '\0';
+
+    return copy;
+
+}
+
+/**
+ * copy_attribute
+ * @param tag the start tag
+ * @param length the length of the start tag
+ * @param qname the qualified name of the attribute
+ *
+ * @returns a malloc'd copy of the attribute value or 0 if the tag does not have the attribute.
+ */
+static char * copy_attribute(const char * tag, size_t length, const char * qname) {
+
+    std::string value;
+    if(!srcml_tag_attribute(tag, length, qname, value)) return 0;
+
+    return copy_string(value);
+
+}
+
+/**
+ * srcsax_create_unit_index_memory
+ * @param buffer a srcML archive
+ * @param buffer_size the size of the archive
+ *
+ * Index the units of a srcML archive by scanning its markup.  Only documents
+ * srcsax_parse_parallel can split, i.e., archives in an ASCII compatible encoding
+ * without a DOCTYPE, are indexed.
+ *
+ * @returns the unit index or 0 on error.
+ */
+struct srcsax_unit_index * srcsax_create_unit_index_memory(const char * buffer, size_t buffer_size) {
+
+    if(buffer == 0 || buffer_size == 0) return 0;
+
+    srcml_document_scan scan;
+    if(!srcml_scan_document(buffer, buffer_size, scan)) return 0;
+
+    struct srcsax_unit_index * index = (struct srcsax_unit_index *)calloc(1, sizeof(struct srcsax_unit_index));
+    if(index == 0) return 0;
+
+    index->archive_size = buffer_size;
+    index->declaration_offset = scan.declaration_offset;
+    index->declaration_length = scan.declaration_length;
+    index->root_offset = scan.root_offset;
+    index->root_length = scan.root_length;
+    index->header_length = scan.units.front().offset - (scan.root_offset + scan.root_length);
+    index->root_qname = copy_string(scan.root_qname);
+    index->units = (struct srcsax_unit_index_entry *)calloc(scan.units.size(), sizeof(struct srcsax_unit_index_entry));
+
+    if(index->root_qname == 0 || index->units == 0) {
+
+        srcsax_free_unit_index(index);
+        return 0;
+
+    }
+
+    for(std::vector<srcml_unit_range>::const_iterator citr = scan.units.begin(); citr != scan.units.end(); ++citr) {
+
+        struct srcsax_unit_index_entry & unit = index->units[index->unit_count++];
+        unit.offset = citr->offset;
+        unit.length = citr->length;
+
+        const char * tag = buffer + citr->offset;
+        unit.filename = copy_attribute(tag, citr->start_tag_length, "filename");
+        unit.hash = copy_attribute(tag, citr->start_tag_length, "hash");
+        unit.language = copy_attribute(tag, citr->start_tag_length, "language");
+
+    }
+
+    return index;
+
+}
+
+/**
+ * srcsax_create_unit_index
+ * @param filename a srcML archive file
+ *
+ * Index the units of a srcML archive file.  The file is mapped into memory
+ * and scanned once, see srcsax_create_unit_index_memory.
+ *
+ * @returns the unit index or 0 on error.
+ */
+struct srcsax_unit_index * srcsax_create_unit_index(const char * filename) {
+
+    if(filename == 0) return 0;
+
+#ifndef _MSC_BUILD
+
+    int fd = open(filename, O_RDONLY);
+    if(fd < 0) return 0;
+
+    struct stat status;
+    if(fstat(fd, &status) != 0 || status.st_size == 0) {
+
+        close(fd);
+        return 0;
+
+    }
+
+    size_t size = (size_t)status.st_size;
+    void * buffer = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(buffer == MAP_FAILED) return 0;
+
+    madvise(buffer, size, MADV_SEQUENTIAL);
+
+    struct srcsax_unit_index * index = srcsax_create_unit_index_memory((const char *)buffer, size);
+
+    munmap(buffer, size);
+
+    return index;
+
+#else
+
+    FILE * file = fopen(filename, "rb");
+    if(file == 0) return 0;
+
+    std::vector<char> buffer;
+    char block[1 << 16];
+    size_t num_read;
+    while((num_read = fread(block, 1, sizeof(block), file)) > 0)
+        buffer.insert(buffer.end(), block, block + num_read);
+
+    fclose(file);
+
+    if(buffer.empty()) return 0;
+
+    return srcsax_create_unit_index_memory(&buffer.front(), buffer.size());
+
+#endif
+
+}
+
+/**
+ * write_string
+ * @param file the index file
+ * @param value a string or 0
+ *
+ * Write a length prefixed string, -1 for no string.
+ *
+ * @returns if the string was written.
+ */
+static bool write_string(FILE * file, const char * value) {
+
+    if(value == 0) return fprintf(file, "-1\n") > 0;
+
+    size_t length = strlen(value);
+
+    return fprintf(file, "%llu\n", (unsigned long long)length) > 0 && fwrite(value, 1, length, file) == length && fputc('\n', file) != EOF;
+
+}
+
+/**
+ * read_string
+ * @param file the index file
+ * @param value location for the read string, 0 if none
+ *
+ * Read a string written by write_string.
+ *
+ * @returns if the string was read.
+ */
+static bool read_string(FILE * file, char ** value) {
+
+    *value = 0;
+
+    long length;
+    if(fscanf(file, "%ld", &length) != 1 || fgetc(file) != '\n') return false;
+
+    if(length < 0) return true;
+
+    *value = (char *)malloc((size_t)length + 1);
+    if(*value == 0) return false;
+
+    if(fread(*value, 1, (size_t)length, file) != (size_t)length || fgetc(file) != '\n') return false;
+    (*value)[length] = '\0';
+
+    return true;
+
+}
+
+/**
+ * srcsax_write_unit_index
+ * @param index a unit index
+ * @param index_filename the file to save the index in
+ *
+ * Save a unit index, typically next to the archive as <archive>.idx.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_write_unit_index(const struct srcsax_unit_index * index, const char * index_filename) {
+
+    if(index == 0 || index_filename == 0) return -1;
+
+    FILE * file = fopen(index_filename, "wb");
+    if(file == 0) return -1;
+
+    bool written = fputs(UNIT_INDEX_HEADER, file) != EOF
+        && fprintf(file, "%llu %llu %llu %llu %llu %llu %llu\n", (unsigned long long)index->archive_size,
+                   (unsigned long long)index->declaration_offset, (unsigned long long)index->declaration_length,
+                   (unsigned long long)index->root_offset, (unsigned long long)index->root_length,
+                   (unsigned long long)index->header_length, (unsigned long long)index->unit_count) > 0
+        && write_string(file, index->root_qname);
+
+    for(size_t pos = 0; written && pos < index->unit_count; ++pos) {
+
+        const struct srcsax_unit_index_entry & unit = index->units[pos];
+        written = fprintf(file, "%llu %llu\n", (unsigned long long)unit.offset, (unsigned long long)unit.length) > 0
+            && write_string(file, unit.filename) && write_string(file, unit.hash) && write_string(file, unit.language);
+
+    }
+
+    if(fclose(file) != 0) written = false;
+
+    return written ? 0 : -1;
+
+}
+
+/**
+ * srcsax_read_unit_index
+ * @param index_filename a file saved with srcsax_write_unit_index
+ *
+ * Load a saved unit index.
+ *
+ * @returns the unit index or 0 on error.
+ */
+struct srcsax_unit_index * srcsax_read_unit_index(const char * index_filename) {
+
+    if(index_filename == 0) return 0;
+
+    FILE * file = fopen(index_filename, "rb");
+    if(file == 0) return 0;
+
+    char header[32];
+    unsigned long long archive_size, declaration_offset, declaration_length, root_offset, root_length, header_length, unit_count;
+    struct srcsax_unit_index * index = 0;
+
+    if(fgets(header, sizeof(header), file) == 0 || strcmp(header, UNIT_INDEX_HEADER) != 0
+       || fscanf(file, "%llu %llu %llu %llu %llu %llu %llu", &archive_size, &declaration_offset, &declaration_length,
+                 &root_offset, &root_length, &header_length, &unit_count) != 7 || fgetc(file) != '\n'
+       || (index = (struct srcsax_unit_index *)calloc(1, sizeof(struct srcsax_unit_index))) == 0) {
+
+        fclose(file);
+        return 0;
+
+    }
+
+    index->archive_size = archive_size;
+    index->declaration_offset = declaration_offset;
+    index->declaration_length = declaration_length;
+    index->root_offset = root_offset;
+    index->root_length = root_length;
+    index->header_length = header_length;
+
+    bool read = read_string(file, &index->root_qname) && index->root_qname != 0 && unit_count != 0
+        && (index->units = (struct srcsax_unit_index_entry *)calloc(unit_count, sizeof(struct srcsax_unit_index_entry))) != 0;
+
+    for(; read && index->unit_count < unit_count; ++index->unit_count) {
+
+        struct srcsax_unit_index_entry & unit = index->units[index->unit_count];
+
+        unsigned long long offset, length;
+        read = fscanf(file, "%llu %llu", &offset, &length) == 2 && fgetc(file) == '\n';
+        unit.offset = offset;
+        unit.length = length;
+
+        read = read && read_string(file, &unit.filename) && read_string(file, &unit.hash) && read_string(file, &unit.language);
+
+    }
+
+    fclose(file);
+
+    if(!read) {
+
+        srcsax_free_unit_index(index);
+        return 0;
+
+    }
+
+    return index;
+
+}
+
+/**
+ * srcsax_find_unit
+ * @param index a unit index
+ * @param filename the filename attribute of a unit
+ *
+ * @returns the position of the first unit with the filename or -1 if not found.
+ */
+long srcsax_find_unit(const struct srcsax_unit_index * index, const char * filename) {
+
+    if(index == 0 || filename == 0) return -1;
+
+    for(size_t pos = 0; pos < index->unit_count; ++pos)
+        if(index->units[pos].filename && strcmp(index->units[pos].filename, filename) == 0)
+            return (long)pos;
+
+    return -1;
+
+}
+
+/**
+ * srcsax_free_unit_index
+ * @param index a unit index
+ *
+ * Free a unit index created by srcsax_create_unit_index* or srcsax_read_unit_index.
+ */
+void srcsax_free_unit_index(struct srcsax_unit_index * index) {
+
+    if(index == 0) return;
+
+    if(index->units) {
+
+        for(size_t pos = 0; pos < index->unit_count; ++pos) {
+
+            free(index->units[pos].filename);
+            free(index->units[pos].hash);
+            free(index->units[pos].language);
+
+        }
+
+        free(index->units);
+
+    }
+
+    free(index->root_qname);
+    free(index);
+
+}
@@ -0,0 +1,925 @@
+/**
+ * @file srcsax_writer.cpp
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <srcsax_writer.h>
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifndef _MSC_BUILD
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#else
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+/** size of the output buffer of a file descriptor */
+static const size_t WRITER_BUFFER_SIZE = 1 << 16;
+
+/** pieces at least this long that do not fit the buffer are written from the caller's storage */
+static const size_t WRITER_DIRECT_SIZE = WRITER_BUFFER_SIZE / 4;
+
+/** maximum number of rendered namespace declarations kept */
+static const size_t WRITER_MAX_DECLARATIONS = 32;
+
+/**
+ * srcsax_namespace_declaration
+ *
+ * A namespace and its rendered declaration, e.g., xmlns:cpp="...".
+ */
+struct srcsax_namespace_declaration {
+
+    /** namespace prefix */
+    std::string prefix;
+
+    /** if the namespace has a prefix */
+    bool has_prefix;
+
+    /** namespace uri */
+    std::string uri;
+
+    /** the declaration, with its leading space */
+    std::string declaration;
+
+};
+
+/**
+ * srcsax_writer
+ *
+ * Output buffer and state of a streaming srcML writer.
+ */
+struct srcsax_writer {
+
+    /** output file descriptor, -1 when writing to memory */
+    int fd;
+
+    /** if the file descriptor is closed with the writer */
+    bool close_fd;
+
+    /** output buffer, all of the output when writing to memory */
+    std::vector<char> buffer;
+
+    /** number of bytes used in buffer */
+    size_t used;
+
+    /** if the last start tag is still open, i.e., without its > */
+    bool open_tag;
+
+    /** if an error occurred, further writes fail */
+    bool error;
+
+    /** if the last write was a copied element, whose end tag is already written */
+    bool copied_element;
+
+    /** rendered namespace declarations */
+    std::vector<srcsax_namespace_declaration> declarations;
+
+};
+
+/**
+ * write_all
+ * @param writer a srcSAX writer
+ * @param data the bytes to write
+ * @param size number of bytes
+ *
+ * Write all the bytes to the writer's file descriptor.
+ *
+ * @returns if all was written.
+ */
+static bool write_all(srcsax_writer * writer, const char * data, size_t size) {
+
+    while(size) {
+
+#ifndef _MSC_BUILD
+        ssize_t written = write(writer->fd, data, size);
+#else
+        int written = _write(writer->fd, data, (unsigned int)size);
+#endif
+        if(written < 0) {
+
+            if(errno == EINTR) continue;
+
+            writer->error = true;
+            return false;
+
+        }
+
+        data += written;
+        size -= written;
+
+    }
+
+    return true;
+
+}
+
+/**
+ * flush_buffer
+ * @param writer a srcSAX writer
+ *
+ * Write the buffered output to the file descriptor.
+ *
+ * @returns if the output was written.
+ */
+static bool flush_buffer(srcsax_writer * writer) {
+
+    if(writer->fd < 0 || writer->used == 0) return !writer->error;
+
+    bool written = write_all(writer, &writer->buffer.front(), writer->used);
+    writer->used = 0;
+
+    return written;
+
+}
+
+/**
+ * write_direct
+ * @param writer a srcSAX writer
+ * @param data the bytes to write
+ * @param size number of bytes
+ *
+ * Write the buffered output followed by the bytes, without copying them
+ * into the buffer, with a single writev when available.
+ *
+ * @returns if all was written.
+ */
+static bool write_direct(srcsax_writer * writer, const char * data, size_t size) {
+
+#ifndef _MSC_BUILD
+
+    struct iovec vector[2];
+    vector[0].iov_base = writer->buffer.empty() ? 0 : &writer->buffer.front();
+    vector[0].iov_len = writer->used;
+    vector[1].iov_base = (void *)data;
+    vector[1].iov_len = size;
+
+    struct iovec * current = writer->used ? vector : vector + 1;
+    int count = writer->used ? 2 : 1;
+    writer->used = 0;
+
+    while(count) {
+
+        ssize_t written = writev(writer->fd, current, count);
+        if(written < 0) {
+
+            if(errno == EINTR) continue;
+
+            writer->error = true;
+            return false;
+
+        }
+
+        // skip what was written, partially written vectors are continued
+        while(count && (size_t)written >= current->iov_len) {
+
+            written -= current->iov_len;
+            ++current;
+            --count;
+
+        }
+
+        if(count) {
+
+            current->iov_base = (char *)current->iov_base + written;
+            current->iov_len -= written;
+
+        }
+
+    }
+
+    return true;
+
+#else
+
+    return flush_buffer(writer) && write_all(writer, data, size);
+
+#endif
+
+}
+
+/**
+ * append_overflow
+ * @param writer a srcSAX writer
+ * @param data the bytes to append
+ * @param size number of bytes
+ *
+ * Append bytes that do not fit the buffer: grow the buffer of a memory writer,
+ * or write out the buffer of a file descriptor.
+ */
+static void append_overflow(srcsax_writer * writer, const char * data, size_t size) {
+
+    if(writer->fd < 0) {
+
+        size_t capacity = writer->buffer.size() * 2;
+        if(capacity < writer->used + size) capacity = writer->used + size;
+        writer->buffer.resize(capacity);
+
+    } else if(size >= WRITER_DIRECT_SIZE) {
+
+        write_direct(writer, data, size);
+        return;
+
+    } else if(!flush_buffer(writer)) {
+
+        return;
+
+    }
+
+    memcpy(&writer->buffer.front() + writer->used, data, size);
+    writer->used += size;
+
+}
+
+/**
+ * append
+ * @param writer a srcSAX writer
+ * @param data the bytes to append
+ * @param size number of bytes
+ *
+ * Append bytes to the output.
+ */
+static inline void append(srcsax_writer * writer, const char * data, size_t size) {
+
+    if(writer->used + size > writer->buffer.size()) {
+
+        append_overflow(writer, data, size);
+        return;
+
+    }
+
+    memcpy(&writer->buffer.front() + writer->used, data, size);
+    writer->used += size;
+
+}
+
+/**
+ * append
+ * @param writer a srcSAX writer
+ * @param str a null terminated string
+ *
+ * Append a string to the output.
+ */
+static inline void append(srcsax_writer * writer, const char * str) {
+
+    append(writer, str, strlen(str));
+
+}
+
+/**
+ * append_qname
+ * @param writer a srcSAX writer
+ * @param localname the local name
+ * @param prefix the prefix, or 0
+ *
+ * Append a qualified name to the output.
+ */
+static inline void append_qname(srcsax_writer * writer, const char * localname, const char * prefix) {
+
+    if(prefix) {
+
+        append(writer, prefix);
+        append(writer, ":", 1);
+
+    }
+
+    append(writer, localname);
+
+}
+
+/**
+ * is_text_special
+ * @param c a character
+ *
+ * @returns if the character is escaped in text.
+ */
+static inline bool is_text_special(char c) {
+
+    return c == '<' || c == '>' || c == '&' || c == '\r';
+
+}
+
+/**
+ * find_text_special
+ * @param ch the characters
+ * @param len number of characters
+ *
+ * Find the first character that is escaped in text, 16 characters
+ * at a time with SSE2.
+ *
+ * @returns the position of the character, len if there is none.
+ */
+static inline size_t find_text_special(const char * ch, size_t len) {
+
+    size_t pos = 0;
+
+#ifdef __SSE2__
+
+    const __m128i less = _mm_set1_epi8('<');
+    const __m128i greater = _mm_set1_epi8('>');
+    const __m128i ampersand = _mm_set1_epi8('&');
+    const __m128i carriage_return = _mm_set1_epi8('\r');
+
+    for(; pos + 16 <= len; pos += 16) {
+
+        __m128i block = _mm_loadu_si128((const __m128i *)(ch + pos));
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, less), _mm_cmpeq_epi8(block, greater)),
+                                       _mm_or_si128(_mm_cmpeq_epi8(block, ampersand), _mm_cmpeq_epi8(block, carriage_return)));
+
+        int mask = _mm_movemask_epi8(special);
+        if(mask) return pos + __builtin_ctz(mask);
+
+    }
+
+#endif
+
+    for(; pos < len; ++pos)
+        if(is_text_special(ch[pos])) return pos;
+
+    return len;
+
+}
+
+/**
+ * append_text
+ * @param writer a srcSAX writer
+ * @param ch the characters
+ * @param len number of characters
+ *
+ * Append text escaping <, >, & and carriage returns.  Quotes are not
+ * escaped, as in srcML.
+ */
+static void append_text(srcsax_writer * writer, const char * ch, size_t len) {
+
+    while(len) {
+
+        size_t run = find_text_special(ch, len);
+        if(run) append(writer, ch, run);
+        if(run == len) return;
+
+        switch(ch[run]) {
+
+            case '<' : append(writer, "&lt;", 4); break;
+            case '>' : append(writer, "&gt;", 4); break;
+            case '&' : append(writer, "&amp;", 5); break;
+            default  : append(writer, "&#13;", 5); break;
+
+        }
+
+        ch += run + 1;
+        len -= run + 1;
+
+    }
+
+}
+
+/**
+ * attribute_escape
+ * @param c a character
+ *
+ * @returns the escape of the character in an attribute value, 0 if not escaped.
+ * Whitespace that attribute value normalization would change is escaped as well.
+ */
+static inline const char * attribute_escape(char c) {
+
+    switch(c) {
+
+        case '<'  : return "&lt;";
+        case '>'  : return "&gt;";
+        case '&'  : return "&amp;";
+        case '"'  : return "&quot;";
+        case '\n' : return "&#10;";
+        case '\r' : return "&#13;";
+        case '\t' : return "&#9;";
+        default   : return 0;
+
+    }
+
+}
+
+/**
+ * append_attribute_value
+ * @param writer a srcSAX writer
+ * @param value a null terminated attribute value
+ *
+ * Append an escaped attribute value.
+ */
+static void append_attribute_value(srcsax_writer * writer, const char * value) {
+
+    const char * run = value;
+    for(const char * pos = value; *pos; ++pos) {
+
+        const char * escape = attribute_escape(*pos);
+        if(escape == 0) continue;
+
+        append(writer, run, pos - run);
+        append(writer, escape);
+        run = pos + 1;
+
+    }
+
+    append(writer, run);
+
+}
+
+/**
+ * namespace_declaration
+ * @param writer a srcSAX writer
+ * @param ns a namespace
+ *
+ * Find, or render and keep, the declaration of a namespace.
+ *
+ * @returns the declaration, or 0 if too many are kept already.
+ */
+static const std::string * namespace_declaration(srcsax_writer * writer, const srcsax_namespace & ns) {
+
+    const char * uri = ns.uri ? ns.uri : "";
+
+    for(std::vector<srcsax_namespace_declaration>::const_iterator citr = writer->declarations.begin(); citr != writer->declarations.end(); ++citr)
+        if(citr->has_prefix == (ns.prefix != 0) && (!ns.prefix || citr->prefix == ns.prefix) && citr->uri == uri)
+            return &citr->declaration;
+
+    if(writer->declarations.size() == WRITER_MAX_DECLARATIONS) return 0;
+
+    srcsax_namespace_declaration declaration;
+    declaration.has_prefix = ns.prefix != 0;
+    if(ns.prefix) declaration.prefix = ns.prefix;
+    declaration.uri = uri;
+
+    declaration.declaration = ns.prefix ? " xmlns:" : " xmlns";
+    if(ns.prefix) declaration.declaration += ns.prefix;
+    declaration.declaration += "=\"";
+    for(const char * pos = uri; *pos; ++pos) {
+
+        const char * escape = attribute_escape(*pos);
+        if(escape) declaration.declaration += escape;
+        else declaration.declaration += *pos;
+
+    }
+    declaration.declaration += '"';
+
+    writer->declarations.push_back(declaration);
+
+    return &writer->declarations.back().declaration;
+
+}
+
+/**
+ * create_writer
+ * @param fd output file descriptor, -1 for memory
+ * @param close_fd if the file descriptor is closed with the writer
+ *
+ * @returns the writer or 0 on error.
+ */
+static struct srcsax_writer * create_writer(int fd, bool close_fd) {
+
+    srcsax_writer * writer = new(std::nothrow) srcsax_writer;
+    if(writer == 0) return 0;
+
+    writer->fd = fd;
+    writer->close_fd = close_fd;
+    writer->used = 0;
+    writer->open_tag = false;
+    writer->error = false;
+    writer->copied_element = false;
+
+    try {
+
+        writer->buffer.resize(WRITER_BUFFER_SIZE);
+
+    } catch(...) {
+
+        delete writer;
+        return 0;
+
+    }
+
+    return writer;
+
+}
+
+/**
+ * srcsax_create_writer_filename
+ * @param filename name of the output file
+ *
+ * Create a writer to a file, created or truncated.  The file is
+ * closed when the writer is freed.
+ *
+ * @returns the writer or 0 on error.
+ */
+struct srcsax_writer * srcsax_create_writer_filename(const char * filename) {
+
+    if(filename == 0) return 0;
+
+#ifndef _MSC_BUILD
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+#else
+    int fd = _open(filename, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0666);
+#endif
+    if(fd < 0) return 0;
+
+    srcsax_writer * writer = create_writer(fd, true);
+    if(writer == 0) {
+
+#ifndef _MSC_BUILD
+        close(fd);
+#else
+        _close(fd);
+#endif
+
+    }
+
+    return writer;
+
+}
+
+/**
+ * srcsax_create_writer_fd
+ * @param fd an open file descriptor
+ *
+ * Create a writer to a file descriptor.  The file descriptor
+ * is not closed when the writer is freed.
+ *
+ * @returns the writer or 0 on error.
+ */
+struct srcsax_writer * srcsax_create_writer_fd(int fd) {
+
+    if(fd < 0) return 0;
+
+    return create_writer(fd, false);
+
+}
+
+/**
+ * srcsax_create_writer_memory
+ *
+ * Create a writer to memory, see srcsax_writer_memory.
+ *
+ * @returns the writer or 0 on error.
+ */
+struct srcsax_writer * srcsax_create_writer_memory(void) {
+
+    return create_writer(-1, false);
+
+}
+
+/**
+ * close_open_tag
+ * @param writer a srcSAX writer
+ *
+ * End the open start tag, if any, as the element has content.
+ */
+static inline void close_open_tag(srcsax_writer * writer) {
+
+    writer->copied_element = false;
+
+    if(!writer->open_tag) return;
+
+    append(writer, ">", 1);
+    writer->open_tag = false;
+
+}
+
+/**
+ * srcsax_write_start_document
+ * @param writer a srcSAX writer
+ *
+ * Write the XML declaration.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_write_start_document(struct srcsax_writer * writer) {
+
+    if(writer == 0 || writer->error) return -1;
+
+    static const char declaration[] = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n";
+    append(writer, declaration, sizeof(declaration) - 1);
+
+    return writer->error ? -1 : 0;
+
+}
+
+/**
+ * srcsax_write_end_document
+ * @param writer a srcSAX writer
+ *
+ * End the document and write out the buffered output.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_write_end_document(struct srcsax_writer * writer) {
+
+    if(writer == 0 || writer->error) return -1;
+
+    close_open_tag(writer);
+    append(writer, "\n", 1);
+
+    return srcsax_writer_flush(writer);
+
+}
+
+/**
+ * srcsax_write_start_element
+ * @param writer a srcSAX writer
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ * @param num_namespaces number of namespaces definitions
+ * @param namespaces the defined namespaces
+ * @param num_attributes the number of attributes on the tag
+ * @param attributes list of attributes
+ *
+ * Write a start tag, e.g., from a start_root, start_unit, start_element or meta_tag
+ * callback.  The tag is left open so an element without content is written as an
+ * empty element.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_write_start_element(struct srcsax_writer * writer, const char * localname, const char * prefix,
+                               int num_namespaces, const struct srcsax_namespace * namespaces,
+                               int num_attributes, const struct srcsax_attribute * attributes) {
+
+    if(writer == 0 || writer->error || localname == 0) return -1;
+
+    close_open_tag(writer);
+
+    append(writer, "<", 1);
+    append_qname(writer, localname, prefix);
+
+    for(int pos = 0; pos < num_namespaces; ++pos) {
+
+        const std::string * declaration = namespace_declaration(writer, namespaces[pos]);
+        if(declaration) {
+
+            append(writer, declaration->data(), declaration->size());
+
+        } else {
+
+            append(writer, namespaces[pos].prefix ? " xmlns:" : " xmlns");
+            if(namespaces[pos].prefix) append(writer, namespaces[pos].prefix);
+            append(writer, "=\"", 2);
+            append_attribute_value(writer, namespaces[pos].uri ? namespaces[pos].uri : "");
+            append(writer, "\"", 1);
+
+        }
+
+    }
+
+    for(int pos = 0; pos < num_attributes; ++pos) {
+
+        append(writer, " ", 1);
+        append_qname(writer, attributes[pos].localname, attributes[pos].prefix);
+        append(writer, "=\"", 2);
+        append_attribute_value(writer, attributes[pos].value ? attributes[pos].value : "");
+        append(writer, "\"", 1);
+
+    }
+
+    writer->open_tag = true;
+
+    return writer->error ? -1 : 0;
+
+}
+
+/**
+ * srcsax_write_end_element
+ * @param writer a srcSAX writer
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ *
+ * Write an end tag, or end the open start tag as an empty element.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_write_end_element(struct srcsax_writer * writer, const char * localname, const char * prefix) {
+
+    if(writer == 0 || writer->error || localname == 0) return -1;
+
+    if(writer->copied_element) {
+
+        writer->copied_element = false;
+
+    } else if(writer->open_tag) {
+
+        append(writer, "/>", 2);
+        writer->open_tag = false;
+
+    } else {
+
+        append(writer, "</", 2);
+        append_qname(writer, localname, prefix);
+        append(writer, ">", 1);
+
+    }
+
+    return writer->error ? -1 : 0;
+
+}
+
+/**
+ * srcsax_write_characters
+ * @param writer a srcSAX writer
+ * @param ch the characters
+ * @param len number of characters
+ *
+ * Write text, e.g., from a characters_root or characters_unit callback,
+ * escaping <, > and &.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_write_characters(struct srcsax_writer * writer, const char * ch, int len) {
+
+    if(writer == 0 || writer->error || (ch == 0 && len > 0)) return -1;
+
+    if(len <= 0) return 0;
+
+    close_open_tag(writer);
+    append_text(writer, ch, len);
+
+    return writer->error ? -1 : 0;
+
+}
+
+/**
+ * srcsax_write_comment
+ * @param writer a srcSAX writer
+ * @param value the comment content
+ *
+ * Write a comment.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_write_comment(struct srcsax_writer * writer, const char * value) {
+
+    if(writer == 0 || writer->error) return -1;
+
+    close_open_tag(writer);
+    append(writer, "<!--", 4);
+    if(value) append(writer, value);
+    append(writer, "-->", 3);
+
+    return writer->error ? -1 : 0;
+
+}
+
+/**
+ * srcsax_write_cdata_block
+ * @param writer a srcSAX writer
+ * @param value the pcdata content
+ * @param len the block length
+ *
+ * Write a CDATA section.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_write_cdata_block(struct srcsax_writer * writer, const char * value, int len) {
+
+    if(writer == 0 || writer->error || (value == 0 && len > 0)) return -1;
+
+    close_open_tag(writer);
+    append(writer, "<![CDATA[", 9);
+    if(len > 0) append(writer, value, len);
+    append(writer, "]]>", 3);
+
+    return writer->error ? -1 : 0;
+
+}
+
+/**
+ * srcsax_write_processing_instruction
+ * @param writer a srcSAX writer
+ * @param target the processing instruction target.
+ * @param data the processing instruction data.
+ *
+ * Write a processing instruction.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_write_processing_instruction(struct srcsax_writer * writer, const char * target, const char * data) {
+
+    if(writer == 0 || writer->error || target == 0) return -1;
+
+    close_open_tag(writer);
+    append(writer, "<?", 2);
+    append(writer, target);
+    if(data && *data) {
+
+        append(writer, " ", 1);
+        append(writer, data);
+
+    }
+    append(writer, "?>", 2);
+
+    return writer->error ? -1 : 0;
+
+}
+
+/**
+ * srcsax_write_element_copy
+ * @param writer a srcSAX writer
+ * @param data the original bytes of the element
+ * @param size number of bytes
+ *
+ * Write a complete element verbatim, e.g., a subtree copied with srcsax_copy_subtree.
+ * The end tag is part of the copy, so the following srcsax_write_end_element, from the
+ * element's end callback, writes nothing.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_write_element_copy(struct srcsax_writer * writer, const char * data, size_t size) {
+
+    if(writer == 0 || writer->error || (data == 0 && size > 0)) return -1;
+
+    close_open_tag(writer);
+    append(writer, data, size);
+    writer->copied_element = true;
+
+    return writer->error ? -1 : 0;
+
+}
+
+/**
+ * srcsax_writer_flush
+ * @param writer a srcSAX writer
+ *
+ * Write out the buffered output of a file writer.
+ *
+ * @returns 0 on success -1 on error.
+ */
+int srcsax_writer_flush(struct srcsax_writer * writer) {
+
+    if(writer == 0) return -1;
+
+    return flush_buffer(writer) ? 0 : -1;
+
+}
+
+/**
+ * srcsax_writer_memory
+ * @param writer a srcSAX writer created with srcsax_create_writer_memory
+ * @param size location for the size of the output
+ *
+ * Get the output of a memory writer, valid until the next write.
+ * The output is not null terminated.
+ *
+ * @returns the output or 0 if not a memory writer.
+ */
+const char * srcsax_writer_memory(struct srcsax_writer * writer, size_t * size) {
+
+    if(writer == 0 || writer->fd >= 0) return 0;
+
+    if(size) *size = writer->used;
+
+    return &writer->buffer.front();
+
+}
+
+/**
+ * srcsax_free_writer
+ * @param writer a srcSAX writer
+ *
+ * Write out the buffered output and free the writer, closing
+ * the file of srcsax_create_writer_filename.
+ *
+ * @returns 0 on success -1 if any write failed.
+ */
+int srcsax_free_writer(struct srcsax_writer * writer) {
+
+    if(writer == 0) return 0;
+
+    int status = srcsax_writer_flush(writer);
+
+#ifndef _MSC_BUILD
+    if(writer->close_fd && close(writer->fd) != 0) status = -1;
+#else
+    if(writer->close_fd && _close(writer->fd) != 0) status = -1;
+#endif
+
+    delete writer;
+
+    return status;
+
+}
@@ -0,0 +1,63 @@
+/**
+ * @file srcsax_writer.h
+ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * srcSAX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * srcSAX is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INCLUDED_SRCSAX_WRITER_H
+#define INCLUDED_SRCSAX_WRITER_H
+
+#include <srcsax.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** srcSAX streaming srcML writer */
+struct srcsax_writer;
+
+/* srcSAX writer create functions */
+struct srcsax_writer * srcsax_create_writer_filename(const char * filename);
+struct srcsax_writer * srcsax_create_writer_fd(int fd);
+struct srcsax_writer * srcsax_create_writer_memory(void);
+
+/* srcSAX writer functions */
+int srcsax_write_start_document(struct srcsax_writer * writer);
+int srcsax_write_end_document(struct srcsax_writer * writer);
+int srcsax_write_start_element(struct srcsax_writer * writer, const char * localname, const char * prefix,
+                               int num_namespaces, const struct srcsax_namespace * namespaces,
+                               int num_attributes, const struct srcsax_attribute * attributes);
+int srcsax_write_end_element(struct srcsax_writer * writer, const char * localname, const char * prefix);
+int srcsax_write_characters(struct srcsax_writer * writer, const char * ch, int len);
+int srcsax_write_comment(struct srcsax_writer * writer, const char * value);
+int srcsax_write_cdata_block(struct srcsax_writer * writer, const char * value, int len);
+int srcsax_write_processing_instruction(struct srcsax_writer * writer, const char * target, const char * data);
+int srcsax_write_element_copy(struct srcsax_writer * writer, const char * data, size_t size);
+int srcsax_writer_flush(struct srcsax_writer * writer);
+const char * srcsax_writer_memory(struct srcsax_writer * writer, size_t * size);
+
+/* srcSAX transform function */
+int srcsax_copy_subtree(struct srcsax_context * context, struct srcsax_writer * writer);
+
+/* srcSAX writer free function */
+int srcsax_free_writer(struct srcsax_writer * writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -19,7 +19,10 @@
  */
 
 #include <srcSAXController.hpp>
+#include <srcSAXControllerPool.hpp>
 #include <srcSAXHandler.hpp>
+#include <srcSAXReader.hpp>
+#include <srcSAXWriter.hpp>
 #include <cppCallbackAdapter.hpp>
 
 #include <srcsax.h>
@@ -61,6 +64,325 @@ int close_callback(void * context) {
 
 }
 
+/**
+ * skip_function_handler
+ *
+ * Handler skipping the contents of function elements.
+ */
+class skip_function_handler : public srcSAXHandler {
+
+public :
+
+    /** number of startElement calls */
+    int start_element_count;
+
+    /** number of endElement calls */
+    int end_element_count;
+
+    /** constructor */
+    skip_function_handler() : start_element_count(0), end_element_count(0) {}
+
+    /** count elements and skip functions */
+    virtual void startElement(const char * localname, const char *, const char *,
+                              int, const struct srcsax_namespace *, int, const struct srcsax_attribute *) {
+
+        ++start_element_count;
+        if(strcmp(localname, "function") == 0) assert(skip_element());
+
+    }
+
+    /** count elements */
+    virtual void endElement(const char *, const char *, const char *) {
+
+        ++end_element_count;
+        assert(!skip_element());
+
+    }
+
+};
+
+/**
+ * copy_function_handler
+ *
+ * Handler writing out the document, copying functions unchanged.
+ */
+class copy_function_handler : public srcSAXHandler {
+
+public :
+
+    /** the writer of the output */
+    srcSAXWriter & writer;
+
+    /** constructor */
+    copy_function_handler(srcSAXWriter & writer) : writer(writer) {}
+
+    /** write the root */
+    virtual void startRoot(const char * localname, const char * prefix, const char *,
+                           int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                           const struct srcsax_attribute * attributes) {
+
+        writer.start_element(localname, prefix, num_namespaces, namespaces, num_attributes, attributes);
+
+    }
+
+    /** write the unit */
+    virtual void startUnit(const char * localname, const char * prefix, const char *,
+                           int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                           const struct srcsax_attribute * attributes) {
+
+        writer.start_element(localname, prefix, num_namespaces, namespaces, num_attributes, attributes);
+
+    }
+
+    /** write the element, or copy a function */
+    virtual void startElement(const char * localname, const char * prefix, const char *,
+                              int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                              const struct srcsax_attribute * attributes) {
+
+        if(strcmp(localname, "function") == 0 && copy_element(writer)) return;
+
+        writer.start_element(localname, prefix, num_namespaces, namespaces, num_attributes, attributes);
+
+    }
+
+    /** write the end of the root */
+    virtual void endRoot(const char * localname, const char * prefix, const char *) {
+
+        writer.end_element(localname, prefix);
+
+    }
+
+    /** write the end of the unit */
+    virtual void endUnit(const char * localname, const char * prefix, const char *) {
+
+        writer.end_element(localname, prefix);
+
+    }
+
+    /** write the end of the element */
+    virtual void endElement(const char * localname, const char * prefix, const char *) {
+
+        writer.end_element(localname, prefix);
+
+    }
+
+    /** write the text */
+    virtual void charactersUnit(const char * ch, int len) {
+
+        writer.characters(ch, len);
+
+    }
+
+};
+
+/**
+ * static_count_handler
+ *
+ * Handler for compile-time dispatch, not based on srcSAXHandler.
+ */
+struct static_count_handler {
+
+    /** number of startElement calls */
+    int start_element_count;
+
+    /** number of endUnit calls */
+    int end_unit_count;
+
+    /** constructor */
+    static_count_handler() : start_element_count(0), end_unit_count(0) {}
+
+    /** count elements */
+    void startElement(const char *, const char *, const char *,
+                      int, const struct srcsax_namespace *, int, const struct srcsax_attribute *) {
+
+        ++start_element_count;
+
+    }
+
+    /** count units */
+    void endUnit(const char *, const char *, const char *) {
+
+        ++end_unit_count;
+
+    }
+
+};
+
+/**
+ * overloaded_count_handler
+ *
+ * Handler overloading a callback method.
+ */
+struct overloaded_count_handler : public static_count_handler {
+
+    using static_count_handler::endUnit;
+
+    /** count several units */
+    void endUnit(int count) {
+
+        end_unit_count += count;
+
+    }
+
+};
+
+/**
+ * signature_handler
+ *
+ * Handler recording function signatures, and elements, for enable_function.
+ */
+class signature_handler : public srcSAXHandler {
+
+public :
+
+    /** recorded signatures and elements */
+    std::string events;
+
+    /** record signatures */
+    virtual void startFunction(const char * name, const char * return_type, int num_parameters,
+                               const struct srcsax_declaration * parameter_list, bool is_decl) {
+
+        events += is_decl ? "decl " : "function ";
+        events += return_type;
+        events += ' ';
+        events += name;
+        events += '(';
+        for(int i = 0; i < num_parameters; ++i) {
+
+            if(i) events += ',';
+            events += parameter_list[i].type;
+            events += ' ';
+            events += parameter_list[i].name;
+
+        }
+        events += ')';
+
+    }
+
+    /** record end of functions */
+    virtual void endFunction() {
+
+        events += ';';
+
+    }
+
+    /** record elements */
+    virtual void startElement(const char * localname, const char *, const char *,
+                              int, const struct srcsax_namespace *, int, const struct srcsax_attribute *) {
+
+        events += '<';
+        events += localname;
+
+    }
+
+};
+
+/**
+ * root_handler
+ *
+ * Handler recording the root attributes looked up from each unit.
+ */
+class root_handler : public srcSAXHandler {
+
+public :
+
+    /** recorded root attributes */
+    std::string attributes;
+
+    /** record the root attributes */
+    virtual void startUnit(const char *, const char *, const char *,
+                           int, const struct srcsax_namespace *, int, const struct srcsax_attribute *) {
+
+        int num_attributes = 0;
+        const struct srcsax_attribute * root_attributes = get_root_attributes(num_attributes);
+        for(int pos = 0; pos < num_attributes; ++pos) {
+
+            attributes += root_attributes[pos].localname;
+            attributes += '=';
+            attributes += root_attributes[pos].value;
+            attributes += ';';
+
+        }
+
+    }
+
+};
+
+/**
+ * position_handler
+ *
+ * Handler recording the input position of each element.
+ */
+class position_handler : public srcSAXHandler {
+
+public :
+
+    /** recorded positions */
+    std::string positions;
+
+    /** record the position of the start tag */
+    virtual void startElement(const char * localname, const char *, const char *,
+                              int, const struct srcsax_namespace *, int, const struct srcsax_attribute *) {
+
+        int line = 0, column = 0;
+        assert(get_position(line, column));
+
+        positions += localname;
+        positions += '@' + std::to_string(get_offset()) + ':' + std::to_string(line) + ':' + std::to_string(column) + ';';
+
+    }
+
+};
+
+/**
+ * text_handler
+ *
+ * Handler recording each charactersUnit call, for enable_coalescing.
+ */
+class text_handler : public srcSAXHandler {
+
+public :
+
+    /** recorded characters, one [] per call */
+    std::string text;
+
+    /** record characters */
+    virtual void charactersUnit(const char * ch, int len) {
+
+        text += '[';
+        text.append(ch, len);
+        text += ']';
+
+    }
+
+};
+
+/**
+ * static_signature_handler
+ *
+ * Handler recording function names for compile-time dispatch.
+ */
+struct static_signature_handler {
+
+    /** recorded names */
+    std::string names;
+
+    /** record names */
+    void startFunction(const char * name, const char *, int, const struct srcsax_declaration *, bool) {
+
+        names += name;
+
+    }
+
+    /** record end of functions */
+    void endFunction() {
+
+        names += ';';
+
+    }
+
+};
+
 /**
  * main
  *
@@ -1805,5 +2127,550 @@ int main() {
 
   }
 
+  /*
+    parse_parallel
+   */
+
+  {
+
+    srcSAXController control(std::string("<unit><unit/><unit><expr/></unit><unit/></unit>"));
+    srcSAXHandler handler_one;
+    srcSAXHandler handler_two;
+    std::vector<srcSAXHandler *> handlers;
+    handlers.push_back(&handler_one);
+    handlers.push_back(&handler_two);
+    try {
+      control.parse_parallel(handlers, true);
+    } catch(SAXError error) { assert(false); }
+
+  }
+
+  {
+
+    srcSAXController control(std::string("<unit/>"));
+    std::vector<srcSAXHandler *> handlers;
+    try {
+      control.parse_parallel(handlers);
+      assert(false);
+    } catch(SAXError error) {}
+
+  }
+
+  {
+
+    srcSAXController control(std::string("<unit><unit><a></b></unit><unit/></unit>"));
+    srcSAXHandler handler;
+    std::vector<srcSAXHandler *> handlers(1, &handler);
+    try {
+      control.parse_parallel(handlers);
+      assert(false);
+    } catch(SAXError error) {
+      assert(error.message != "");
+      assert(error.error_code != 0);
+    }
+
+  }
+
+  /*
+    srcSAXController unit index
+   */
+
+  {
+
+    const char * srcml_buffer = "<unit><unit filename=\"a.cpp\"/><unit filename=\"b.cpp\"><expr/></unit></unit>";
+    FILE * file = fopen("controller_unit_test.xml", "wb");
+    fwrite(srcml_buffer, 1, strlen(srcml_buffer), file);
+    fclose(file);
+
+    srcsax_unit_index * index = srcsax_create_unit_index("controller_unit_test.xml");
+    assert(index != 0);
+
+    try {
+      srcSAXController control("controller_unit_test.xml", index, 1, 2);
+      srcSAXHandler handler;
+      control.parse(&handler);
+      assert(control.getContext()->unit_count == 1);
+    } catch(...) { assert(false); }
+
+    try {
+      srcSAXController control("controller_unit_test.xml", index, 2, 3);
+      assert(false);
+    } catch(std::string) {}
+
+    srcsax_free_unit_index(index);
+    remove("controller_unit_test.xml");
+
+  }
+
+  /*
+    srcSAXController memory map
+   */
+
+  {
+
+    srcSAXController control(__FILE__, 0, true);
+    srcSAXHandler handler;
+    try {
+      control.parse(&handler);
+      assert(false);
+    } catch(SAXError error) {
+      assert(error.message != "");
+    }
+
+  }
+
+  {
+
+    try {
+      srcSAXController control("test_srcsax_controller_missing.xml", 0, true);
+      assert(false);
+    } catch(std::string) {}
+
+  }
+
+  /*
+    parse_chunk
+   */
+
+  {
+
+    srcSAXController control;
+    srcSAXHandler handler;
+    try {
+      control.parse_chunk(&handler, "<unit><unit>", 12);
+      control.parse_chunk(&handler, "</unit><unit/>", 14);
+      control.parse_chunk(&handler, "</unit>", 7, true);
+      assert(control.getContext()->unit_count == 2);
+    } catch(SAXError error) { assert(false); }
+
+  }
+
+  {
+
+    srcSAXController control;
+    srcSAXHandler handler;
+    try {
+      control.parse_chunk(&handler, "<unit>", 6);
+      control.parse_chunk(&handler, "</name>", 7, true);
+      assert(false);
+    } catch(SAXError error) {
+      assert(error.message != "");
+      assert(error.error_code != 0);
+    }
+
+  }
+
+  /*
+    srcSAXReader
+   */
+
+  {
+
+    std::string srcml = "<unit><unit filename=\"a.cpp\"><name>a</name></unit><unit/></unit>";
+    srcSAXController control(srcml);
+    srcSAXReader reader(control);
+    int start_unit_count = 0;
+    int element_count = 0;
+    try {
+      while(reader.next()) {
+        if(reader.event().type == SRCSAX_START_UNIT) ++start_unit_count;
+        if(reader.event().type == SRCSAX_START_ELEMENT) {
+          ++element_count;
+          assert(strcmp(reader.get_element_name(reader.event().element_id), "name") == 0);
+        }
+      }
+    } catch(SAXError error) { assert(false); }
+    assert(start_unit_count == 2);
+    assert(element_count == 1);
+    assert(!reader.next());
+
+  }
+
+  {
+
+    std::string srcml = "<unit><name></unit>";
+    srcSAXController control(srcml);
+    srcSAXReader reader(control);
+    try {
+      while(reader.next())
+        ;
+      assert(false);
+    } catch(SAXError error) {
+      assert(error.message != "");
+      assert(error.error_code != 0);
+    }
+
+  }
+
+  {
+
+    srcSAXController control;
+    try {
+      srcSAXReader reader(control);
+      assert(false);
+    } catch(std::string) {}
+
+  }
+
+  /*
+    skip_element
+   */
+
+  {
+
+    std::string srcml = "<unit><unit><function><name>f</name><block>{<return>return;</return>}</block></function><decl><name>a</name></decl></unit></unit>";
+    srcSAXController control(srcml);
+    skip_function_handler handler;
+    try {
+      control.parse(&handler);
+    } catch(SAXError error) { assert(false); }
+    assert(handler.start_element_count == 3);
+    assert(handler.end_element_count == 3);
+    assert(handler.get_stack().empty());
+
+  }
+
+  /*
+    subscribe
+   */
+
+  {
+
+    std::string srcml = "<unit><unit><function><name>f</name><block>{<return>return;</return>}</block></function><decl><name>a</name></decl></unit></unit>";
+    srcSAXController control(srcml);
+    skip_function_handler handler;
+    try {
+      control.subscribe("name");
+      control.subscribe(SRCML_SRC_RETURN);
+      control.parse(&handler);
+    } catch(...) { assert(false); }
+    assert(handler.start_element_count == 3);
+    assert(handler.end_element_count == 3);
+
+  }
+
+  {
+
+    srcSAXController control(std::string("<unit/>"));
+    try {
+      control.subscribe(SRCML_ELEMENT_ID_COUNT);
+      assert(false);
+    } catch(std::string) {}
+    control.clear_subscriptions();
+
+  }
+
+  /*
+    parse<Handler>
+   */
+
+  {
+
+    std::string srcml = "<unit><unit><function><name>f</name><block>{<return>return;</return>}</block></function></unit><unit><name>a</name></unit></unit>";
+    srcSAXController control(srcml);
+    static_count_handler handler;
+    try {
+      control.parse(handler);
+    } catch(SAXError error) { assert(false); }
+    assert(handler.start_element_count == 5);
+    assert(handler.end_unit_count == 2);
+
+    srcsax_handler sax_handler = staticCallbackAdapter<static_count_handler>::factory();
+    assert(sax_handler.start_element != 0);
+    assert(sax_handler.end_unit != 0);
+    assert(sax_handler.start_unit == 0);
+    assert(sax_handler.characters_unit == 0);
+
+  }
+
+  {
+
+    std::string srcml = "<unit><unit/><unit/></unit>";
+    srcSAXController control(srcml);
+    overloaded_count_handler handler;
+    try {
+      control.parse(handler);
+    } catch(SAXError error) { assert(false); }
+    assert(handler.end_unit_count == 2);
+
+    // the overload with the callback's signature is found
+    static_assert(srcsax_defines_endUnit<overloaded_count_handler>::value, "overloaded endUnit");
+    static_assert(srcsax_defines_startElement<overloaded_count_handler>::value, "inherited startElement");
+    static_assert(!srcsax_defines_startUnit<overloaded_count_handler>::value, "no startUnit");
+    static_assert(!srcsax_defines_startUnit<skip_function_handler>::value, "srcSAXHandler startUnit");
+
+  }
+
+  {
+
+    std::string srcml = "<unit><unit><function><name>f</name><block>{<return>return;</return>}</block></function><decl><name>a</name></decl></unit></unit>";
+    srcSAXController control(srcml);
+    skip_function_handler handler;
+    try {
+      control.parse(handler);
+    } catch(SAXError error) { assert(false); }
+    assert(handler.start_element_count == 3);
+    assert(handler.end_element_count == 3);
+
+    srcsax_handler sax_handler = staticCallbackAdapter<skip_function_handler>::factory();
+    assert(sax_handler.start_element != 0);
+    assert(sax_handler.start_unit == 0);
+
+  }
+
+  {
+
+    std::string srcml = "<unit><name></unit>";
+    srcSAXController control(srcml);
+    static_count_handler handler;
+    try {
+      control.parse(handler);
+      assert(false);
+    } catch(SAXError error) {
+      assert(error.message != "");
+      assert(error.error_code != 0);
+    }
+
+  }
+
+  /*
+    enable_stats
+   */
+
+  {
+
+    std::string srcml = "<unit><unit><function><name>f</name><block>{<return>return;</return>}</block></function><decl><name>a</name></decl></unit></unit>";
+    srcSAXController control(srcml);
+    skip_function_handler handler;
+    try {
+      control.get_stats();
+      assert(false);
+    } catch(std::string) {}
+    try {
+      control.enable_stats(true);
+      control.parse(&handler);
+    } catch(...) { assert(false); }
+    srcsax_stats stats = control.get_stats();
+    assert(stats.start_unit == 1);
+    assert(stats.start_element == 3);
+    assert(stats.end_element == 3);
+    assert(stats.bytes_consumed == srcml.size());
+    assert(stats.units_per_second > 0);
+    control.disable_stats();
+
+  }
+
+  /*
+    reset
+   */
+
+  {
+
+    std::string srcml = "<unit><unit><function><name>f</name><block>{<return>return;</return>}</block></function><decl><name>a</name></decl></unit></unit>";
+    srcSAXController control(srcml);
+    skip_function_handler handler;
+    try {
+      control.parse(&handler);
+      control.reset(std::string("<unit><expr><name>a</name></expr></unit>"));
+      control.parse(&handler);
+    } catch(...) { assert(false); }
+    assert(handler.start_element_count == 5);
+    assert(handler.end_element_count == 5);
+
+    try {
+      control.reset();
+      assert(false);
+    } catch(std::string) {}
+
+  }
+
+  {
+
+    srcSAXController control;
+    skip_function_handler handler;
+    try {
+      control.parse_chunk(&handler, "<unit><name>a</name></unit>", 27, true);
+      control.reset();
+      control.parse_chunk(&handler, "<unit><name>b</name></unit>", 27, true);
+    } catch(...) { assert(false); }
+    assert(handler.start_element_count == 2);
+
+    try {
+      control.reset(std::string("<unit/>"));
+      assert(false);
+    } catch(std::string) {}
+
+  }
+
+  /*
+    srcSAXControllerPool
+   */
+
+  {
+
+    srcSAXControllerPool pool(1);
+    srcSAXController * first = pool.acquire(std::string("<unit><name>a</name></unit>"));
+    srcsax_context * context = first->getContext();
+    skip_function_handler handler;
+    try {
+      first->parse(&handler);
+    } catch(...) { assert(false); }
+    assert(handler.start_element_count == 1);
+    pool.release(first);
+    assert(pool.idle() == 1);
+
+    srcSAXController * second = pool.acquire(std::string("<unit><expr><name>a</name></expr></unit>"));
+    assert(second->getContext() == context);
+    try {
+      second->parse(&handler);
+    } catch(...) { assert(false); }
+    assert(handler.start_element_count == 3);
+    pool.release(second);
+
+    try {
+      pool.acquire(std::string());
+      assert(false);
+    } catch(std::string) {}
+    assert(pool.idle() == 1);
+
+  }
+
+  /*
+    enable_function
+   */
+
+  {
+
+    std::string srcml = "<unit><unit><function><type><name>int</name></type> <name>f</name><parameter_list>(<param><decl><type><name>int</name></type> <name>a</name></decl></param>)</parameter_list> "
+                        "<block>{<return>return <expr><name>a</name></expr>;</return>}</block></function><function_decl><type><name>void</name></type> <name>g</name><parameter_list>()</parameter_list>;</function_decl></unit></unit>";
+    srcSAXController control(srcml);
+    control.enable_function(true);
+    signature_handler handler;
+    try {
+      control.parse(&handler);
+    } catch(...) { assert(false); }
+    assert(handler.events == "function int f(int a)<block<return<expr<name;decl void g();");
+
+    control.reset(srcml);
+    static_signature_handler static_handler;
+    try {
+      control.parse(static_handler);
+    } catch(...) { assert(false); }
+    assert(static_handler.names == "f;g;");
+
+    control.reset(srcml);
+    control.enable_function(false);
+    handler.events = "";
+    try {
+      control.parse(&handler);
+    } catch(...) { assert(false); }
+    assert(handler.events.compare(0, 15, "<function<type<") == 0);
+
+  }
+
+  /*
+    enable_coalescing
+   */
+
+  {
+
+    std::string srcml = "<unit><unit><expr><name>a</name> &lt;&lt; b &amp; c</expr>;</unit></unit>";
+    srcSAXController control(srcml);
+    control.enable_coalescing(true);
+    text_handler handler;
+    try {
+      control.parse(&handler);
+    } catch(...) { assert(false); }
+    assert(handler.text == "[a][ << b & c][;]");
+
+    control.reset(srcml);
+    control.enable_coalescing(false);
+    handler.text = "";
+    try {
+      control.parse(&handler);
+    } catch(...) { assert(false); }
+    assert(handler.text != "[a][ << b & c][;]");
+
+  }
+
+  /*
+    get_root_attributes
+   */
+
+  {
+
+    std::string srcml = "<unit revision=\"1.0\"><unit filename=\"a.cpp\"/><unit filename=\"b.cpp\"/></unit>";
+    srcSAXController control(srcml);
+    root_handler handler;
+    try {
+      control.parse(&handler);
+    } catch(...) { assert(false); }
+    assert(handler.attributes == "revision=1.0;revision=1.0;");
+
+  }
+
+  /*
+    get_offset
+   */
+
+  {
+
+    std::string srcml = "<unit>\n<unit><expr><name>a</name>\n<op>+</op></expr></unit>\n</unit>";
+    srcSAXController control(srcml);
+    position_handler handler;
+    try {
+      control.parse(&handler);
+    } catch(...) { assert(false); }
+    assert(handler.positions == "expr@13:2:7;name@19:2:13;op@34:3:1;");
+
+    int line = 0, column = 0;
+    assert(!handler.get_position(line, column));
+
+  }
+
+  /*
+    srcSAXWriter
+   */
+
+  {
+
+    srcSAXWriter writer;
+    srcsax_attribute attribute = { "filename", 0, 0, "a.cpp" };
+    writer.start_element("unit", 0, 0, 0, 1, &attribute);
+    writer.characters("a < b", 5);
+    writer.start_element("name", 0, 0, 0, 0, 0);
+    writer.end_element("name", 0);
+    writer.end_element("unit", 0);
+    assert(writer.str() == "<unit filename=\"a.cpp\">a &lt; b<name/></unit>");
+
+    try {
+      writer.end_element(0, 0);
+      assert(false);
+    } catch(std::string) {}
+
+    try {
+      srcSAXWriter file_writer("/nonexistent/directory/out.xml");
+      assert(false);
+    } catch(std::string) {}
+
+  }
+
+  {
+
+    std::string srcml = "<unit><unit><function><name >f</name><block type='pseudo'>{<return>return a&lt;b;</return>}</block></function><decl><name>a</name></decl></unit></unit>";
+    srcSAXController control(srcml);
+    srcSAXWriter writer;
+    copy_function_handler handler(writer);
+    try {
+      control.parse(&handler);
+    } catch(...) { assert(false); }
+    // the function is copied as is, not rewritten
+    assert(writer.str() == srcml);
+
+    // outside of a parse
+    assert(!handler.copy_element(writer));
+
+  }
+
   return 0;
-}
+}
\ No newline at end of file
@@ -50,10 +50,11 @@ int main() {
   {
 
     srcSAXHandler handler;
+    handler.enable_legacy_stack(true);
     cppCallbackAdapter cpp_adapter(&handler);
     srcsax_handler srcsax_sax = cppCallbackAdapter::factory();
 
-    srcsax_context context;
+    srcsax_context context = {};
     context.data = &cpp_adapter;
     context.handler = &srcsax_sax;
 
@@ -146,10 +147,11 @@ int main() {
   {
 
     srcSAXHandler handler;
+    handler.enable_legacy_stack(true);
     cppCallbackAdapter cpp_adapter(&handler);
     srcsax_handler srcsax_sax = cppCallbackAdapter::factory();
 
-    srcsax_context context;
+    srcsax_context context = {};
     context.data = &cpp_adapter;
     context.handler = &srcsax_sax;
 
@@ -203,10 +205,11 @@ int main() {
   {
 
     srcSAXHandler handler;
+    handler.enable_legacy_stack(true);
     cppCallbackAdapter cpp_adapter(&handler);
     srcsax_handler srcsax_sax = cppCallbackAdapter::factory();
 
-    srcsax_context context;
+    srcsax_context context = {};
     context.data = &cpp_adapter;
     context.handler = &srcsax_sax;
 
@@ -271,10 +274,11 @@ int main() {
   {
 
     srcSAXHandler handler;
+    handler.enable_legacy_stack(true);
     cppCallbackAdapter cpp_adapter(&handler);
     srcsax_handler srcsax_sax = cppCallbackAdapter::factory();
 
-    srcsax_context context;
+    srcsax_context context = {};
     context.data = &cpp_adapter;
     context.handler = &srcsax_sax;
 
@@ -322,5 +326,80 @@ int main() {
 
   }
 
+  /**
+    get_element_stack
+   */
+  {
+
+    srcSAXHandler handler;
+    cppCallbackAdapter cpp_adapter(&handler);
+    srcsax_handler srcsax_sax = cppCallbackAdapter::factory();
+
+    srcsax_context context = {};
+    context.data = &cpp_adapter;
+    context.handler = &srcsax_sax;
+
+    sax2_srcsax_handler sax2_handler = sax2_handler_init;
+    sax2_handler.context = &context;
+
+    xmlParserCtxt ctxt = ctxt_init;
+    xmlSAXHandler sax = srcsax_sax2_factory();
+    ctxt.sax = &sax;
+    ctxt._private = &sax2_handler;
+
+    assert(handler.get_element_stack().empty());
+
+    start_document(&ctxt);
+    assert(handler.get_element_stack().size() == 0);
+
+    const char * namespaces[4] = { 0, "http://www.sdml.info/srcML/src", "cpp", "http://www.sdml.info/srcML/cpp" };
+    const char * values = "abc";
+    const char * attributes[15] = { "filename", 0, "http://www.sdml.info/srcML/src", values, values + 1,
+                                    "dir", 0, "http://www.sdml.info/srcML/src", values + 1, values + 2,
+                                   "language", 0, "http://www.sdml.info/srcML/src", values + 2, values + 3 };
+    start_root(&ctxt, (const xmlChar *)"unit", (const xmlChar *)0,
+              (const xmlChar *)"http://www.sdml.info/srcML/src", 2, (const xmlChar **)namespaces, 3, 0,
+              (const xmlChar **) attributes);
+
+    start_element_ns_first(&ctxt, (const xmlChar *)"expr_stmt", (const xmlChar *)0,
+              (const xmlChar *)"http://www.sdml.info/srcML/src", 2, (const xmlChar **)namespaces, 3, 0,
+              (const xmlChar **) attributes);
+
+    assert(handler.get_stack().size() == 0);
+    assert(handler.get_element_stack().size() == 2);
+    assert(strcmp(handler.get_element_stack().front(), "unit") == 0);
+    assert(strcmp(handler.get_element_stack().back(), "expr_stmt") == 0);
+
+    start_unit(&ctxt, (const xmlChar *)"if", (const xmlChar *)"cpp",
+              (const xmlChar *)"http://www.sdml.info/srcML/cpp", 2, (const xmlChar **)namespaces, 3, 0,
+              (const xmlChar **) attributes);
+
+    assert(handler.get_stack().size() == 0);
+    assert(handler.get_element_stack().size() == 3);
+    assert(strcmp(handler.get_element_stack()[2], "cpp:if") == 0);
+    assert(handler.get_element_stack().end() - handler.get_element_stack().begin() == 3);
+
+    end_element_ns(&ctxt, (const xmlChar *)"if", (const xmlChar *)"cpp",
+              (const xmlChar *)"http://www.sdml.info/srcML/cpp");
+
+    assert(handler.get_element_stack().size() == 2);
+
+    end_element_ns(&ctxt, (const xmlChar *)"expr_stmt", (const xmlChar *)0,
+              (const xmlChar *)"http://www.sdml.info/srcML/src");
+
+    assert(handler.get_element_stack().size() == 1);
+    assert(strcmp(handler.get_element_stack().back(), "unit") == 0);
+
+    end_element_ns(&ctxt, (const xmlChar *)"unit", (const xmlChar *)0,
+              (const xmlChar *)"http://www.sdml.info/srcML/src");
+
+    assert(handler.get_element_stack().empty());
+
+    end_document(&ctxt);
+
+    assert(handler.get_stack().size() == 0);
+
+  }
+
   return 0;
 }
@@ -110,6 +110,8 @@ public :
       handler.comment = comment;
       handler.cdata_block = cdata_block;
       handler.processing_instruction = processing_instruction;
+      handler.start_function = 0;
+      handler.end_function = 0;
 
       return handler;
 
@@ -1085,5 +1085,270 @@ int main() {
 
   }
 
+  /*
+    attribute/namespace marshalling
+   */
+  {
+
+    srcsax_handler_test test_handler;
+    srcsax_handler srcsax_sax = srcsax_handler_test::factory();
+
+    srcsax_context context = {};
+    context.data = &test_handler;
+    context.handler = &srcsax_sax;
+
+    sax2_srcsax_handler sax2_handler = sax2_handler_init;
+    sax2_handler.context = &context;
+
+    xmlParserCtxt ctxt = ctxt_init;
+    xmlSAXHandler sax = srcsax_sax2_factory();
+    ctxt.sax = &sax;
+    ctxt._private = &sax2_handler;
+    const char * namespaces[4] = { 0, "http://www.srcML.org/srcML/src", "cpp", "http://www.srcML.org/srcML/cpp" };
+    const char * values = "abc";
+    const char * attributes[15] = { "filename", 0, "http://www.srcML.org/srcML/src", values, values + 1,
+                                    "dir", 0, "http://www.srcML.org/srcML/src", values + 1, values + 2,
+                                   "language", 0, "http://www.srcML.org/srcML/src", values + 2, values + 3 };
+
+    start_element_ns(&ctxt, (const xmlChar *)"expr", (const xmlChar *)0,
+              (const xmlChar *)"http://www.srcML.org/srcML/src", 2, (const xmlChar **)namespaces, 3, 0,
+              (const xmlChar **) attributes);
+
+    assert(sax2_handler.element_buffer.namespaces.size() == 2);
+    assert(sax2_handler.element_buffer.namespaces[0].prefix == 0);
+    assert(sax2_handler.element_buffer.namespaces[1].prefix == std::string("cpp"));
+    assert(sax2_handler.element_buffer.attributes.size() == 3);
+    assert(sax2_handler.element_buffer.attributes[0].localname == std::string("filename"));
+    assert(sax2_handler.element_buffer.attributes[0].value == std::string("a"));
+    assert(sax2_handler.element_buffer.attributes[1].value == std::string("b"));
+    assert(sax2_handler.element_buffer.attributes[2].value == std::string("c"));
+
+    const srcsax_attribute * attribute_storage = sax2_handler.element_buffer.attributes.data();
+    const char * value_storage = sax2_handler.element_buffer.values.data();
+
+    start_element_ns(&ctxt, (const xmlChar *)"name", (const xmlChar *)0,
+              (const xmlChar *)"http://www.srcML.org/srcML/src", 0, (const xmlChar **)0, 1, 0,
+              (const xmlChar **) attributes + 5);
+
+    assert(sax2_handler.element_buffer.attributes.data() == attribute_storage);
+    assert(sax2_handler.element_buffer.values.data() == value_storage);
+    assert(sax2_handler.element_buffer.attributes[0].localname == std::string("dir"));
+    assert(sax2_handler.element_buffer.attributes[0].value == std::string("b"));
+
+  }
+
+  /*
+    element stack arena
+   */
+  {
+
+    srcml_element_name_stack stack;
+
+    const char * name = stack.push("cpp", "define");
+    assert(name == std::string("cpp:define"));
+    assert(stack.push(0, "expr") == std::string("expr"));
+    assert(stack.size() == 2);
+    assert(stack.data()[0] == name);
+
+    for(int i = 0; i < 2000; ++i)
+      stack.push(0, "expr");
+
+    assert(stack.size() == 2002);
+    assert(stack.data()[0] == name);
+    assert(stack.data()[0] == std::string("cpp:define"));
+
+    const char * top = stack.data()[stack.size() - 1];
+    stack.pop();
+    assert(stack.push(0, "name") == top);
+    assert(stack.data()[stack.size() - 1] == std::string("name"));
+
+    size_t blocks = stack.blocks.size();
+    while(!stack.empty())
+      stack.pop();
+
+    assert(stack.data() == 0);
+
+    for(int i = 0; i < 2002; ++i)
+      stack.push(0, "expr");
+
+    assert(stack.blocks.size() == blocks);
+
+    srcml_element_name_stack copy = stack;
+    assert(copy.size() == stack.size());
+    assert(copy.data()[0] != stack.data()[0]);
+    assert(copy.data()[0] == std::string("expr"));
+
+  }
+
+  /*
+    element ids
+   */
+  {
+
+    for(int id = SRCML_ELEMENT_UNKNOWN + 1; id < SRCML_ELEMENT_ID_COUNT; ++id) {
+
+      const char * name = srcml_element_id_known_name(id);
+      assert(name != 0);
+      assert(srcml_element_id_known(SRCML_NAMESPACE_SRC, name) == id || srcml_element_id_known(SRCML_NAMESPACE_CPP, name) == id);
+
+    }
+
+    assert(srcml_element_id_known(SRCML_NAMESPACE_SRC, "unit") == SRCML_SRC_UNIT);
+    assert(srcml_element_id_known(SRCML_NAMESPACE_SRC, "if") == SRCML_SRC_IF);
+    assert(srcml_element_id_known(SRCML_NAMESPACE_SRC, "param") == SRCML_SRC_PARAM);
+    assert(srcml_element_id_known(SRCML_NAMESPACE_SRC, "parameter") == SRCML_SRC_PARAMETER);
+    assert(srcml_element_id_known(SRCML_NAMESPACE_CPP, "if") == SRCML_CPP_IF);
+    assert(srcml_element_id_known(SRCML_NAMESPACE_CPP, "function") == SRCML_ELEMENT_UNKNOWN);
+    assert(srcml_element_id_known(SRCML_NAMESPACE_SRC, "foo") == SRCML_ELEMENT_UNKNOWN);
+
+    srcml_element_table table;
+    assert(table.intern("expr", "http://www.srcML.org/srcML/src") == SRCML_SRC_EXPR);
+    assert(table.intern("expr", "http://www.sdml.info/srcML/src") == SRCML_SRC_EXPR);
+    assert(table.intern("define", "http://www.sdml.info/srcML/cpp") == SRCML_CPP_DEFINE);
+
+    std::string foo = "foo";
+    int foo_id = table.intern("foo", "http://www.example.com/foo");
+    assert(foo_id == SRCML_ELEMENT_ID_COUNT);
+    assert(table.intern(foo.c_str(), "http://www.example.com/foo") == foo_id);
+    assert(table.intern("expr", "http://www.example.com/foo") == SRCML_ELEMENT_ID_COUNT + 1);
+    assert(table.name(foo_id) == std::string("foo"));
+    assert(table.name(SRCML_SRC_EXPR) == std::string("expr"));
+    assert(table.name(SRCML_ELEMENT_ID_COUNT + 2) == 0);
+
+    // units and macro lists are known by name in any namespace
+    assert(table.kind(SRCML_SRC_UNIT) == SRCML_KIND_UNIT);
+    assert(table.kind(SRCML_SRC_MACRO_LIST) == SRCML_KIND_MACRO_LIST);
+    assert(table.kind(SRCML_SRC_EXPR) == SRCML_KIND_ELEMENT);
+    assert(table.kind(foo_id) == SRCML_KIND_ELEMENT);
+    assert(table.kind(table.intern("unit", "http://www.example.com/foo")) == SRCML_KIND_UNIT);
+    assert(table.kind(table.intern("macro-list", "http://www.example.com/foo")) == SRCML_KIND_MACRO_LIST);
+    assert(table.kind(SRCML_ELEMENT_ID_COUNT + 4) == SRCML_KIND_ELEMENT);
+
+    srcsax_handler_test test_handler;
+    srcsax_handler srcsax_sax = srcsax_handler_test::factory();
+
+    srcsax_context context = {};
+    context.data = &test_handler;
+    context.handler = &srcsax_sax;
+
+    sax2_srcsax_handler sax2_handler = sax2_handler_init;
+    sax2_handler.context = &context;
+
+    xmlParserCtxt ctxt = ctxt_init;
+    xmlSAXHandler sax = srcsax_sax2_factory();
+    ctxt.sax = &sax;
+    ctxt._private = &sax2_handler;
+
+    start_element_ns(&ctxt, (const xmlChar *)"decl_stmt", (const xmlChar *)0,
+              (const xmlChar *)"http://www.srcML.org/srcML/src", 0, (const xmlChar **)0, 0, 0,
+              (const xmlChar **)0);
+    assert(context.element_id == SRCML_SRC_DECL_STMT);
+
+    start_element_ns(&ctxt, (const xmlChar *)"if", (const xmlChar *)"cpp",
+              (const xmlChar *)"http://www.srcML.org/srcML/cpp", 0, (const xmlChar **)0, 0, 0,
+              (const xmlChar **)0);
+    assert(context.element_id == SRCML_CPP_IF);
+
+    end_element_ns(&ctxt, (const xmlChar *)"if", (const xmlChar *)"cpp",
+              (const xmlChar *)"http://www.srcML.org/srcML/cpp");
+    assert(context.element_id == SRCML_CPP_IF);
+
+    start_element_ns(&ctxt, (const xmlChar *)"foo", (const xmlChar *)"foo",
+              (const xmlChar *)"http://www.example.com/foo", 0, (const xmlChar **)0, 0, 0,
+              (const xmlChar **)0);
+    assert(context.element_id == SRCML_ELEMENT_ID_COUNT);
+
+    context.element_table = &sax2_handler.element_table;
+    assert(srcsax_element_name(&context, context.element_id) == std::string("foo"));
+    assert(srcsax_element_name(0, SRCML_SRC_DECL_STMT) == std::string("decl_stmt"));
+    assert(srcsax_element_name(0, SRCML_ELEMENT_ID_COUNT) == 0);
+
+  }
+
+  /*
+    namespace_table
+   */
+  {
+
+    srcsax_handler_test test_handler;
+    srcsax_handler srcsax_sax = srcsax_handler_test::factory();
+
+    srcsax_context context = {};
+    context.data = &test_handler;
+    context.handler = &srcsax_sax;
+
+    sax2_srcsax_handler sax2_handler = sax2_handler_init;
+    sax2_handler.context = &context;
+
+    xmlParserCtxt ctxt = ctxt_init;
+    xmlSAXHandler sax = srcsax_sax2_factory();
+    ctxt.sax = &sax;
+    ctxt._private = &sax2_handler;
+    const char * namespaces[4] = { 0, "http://www.srcML.org/srcML/src", "cpp", "http://www.srcML.org/srcML/cpp" };
+    start_root(&ctxt, (const xmlChar *)"unit", (const xmlChar *)0,
+              (const xmlChar *)"http://www.srcML.org/srcML/src", 2, (const xmlChar **)namespaces, 0, 0, 0);
+
+    const xmlChar * prefix = (const xmlChar *)namespaces[2];
+    const xmlChar * URI = (const xmlChar *)namespaces[3];
+    sax2_handler.namespace_table.resolve(prefix, URI);
+    assert(prefix == sax2_handler.root.namespaces[2]);
+    assert(URI == sax2_handler.root.namespaces[3]);
+
+    // not a dictionary string of the root's namespaces
+    const char other_prefix[] = "cpp";
+    prefix = (const xmlChar *)other_prefix;
+    URI = 0;
+    sax2_handler.namespace_table.resolve(prefix, URI);
+    assert(prefix == (const xmlChar *)other_prefix);
+    assert(URI == 0);
+
+    end_document(&ctxt);
+
+  }
+
+  /*
+    srcml_element
+   */
+  {
+
+    const char * namespaces[4] = { 0, "http://www.srcML.org/srcML/src", "cpp", "http://www.srcML.org/srcML/cpp" };
+    const char * values = "C++f.cpp";
+    const char * attributes[10] = { "language", 0, 0, values, values + 3,
+                                    "filename", 0, 0, values + 3, values + 8 };
+    srcml_element element(0, (const xmlChar *)"unit", (const xmlChar *)0, (const xmlChar *)"http://www.srcML.org/srcML/src",
+                          2, (const xmlChar **)namespaces, 2, 0, (const xmlChar **)attributes);
+
+    assert(strcmp((const char *)element.localname, "unit") == 0);
+    assert(element.prefix == 0);
+    assert(element.namespaces[0] == 0);
+    assert(strcmp((const char *)element.namespaces[3], "http://www.srcML.org/srcML/cpp") == 0);
+    assert(element.srcsax_namespaces[1].prefix == std::string("cpp"));
+    assert(element.srcsax_namespaces[1].uri == (const char *)element.namespaces[3]);
+    assert(element.srcsax_attributes[0].value == std::string("C++"));
+    assert(element.srcsax_attributes[1].value == std::string("f.cpp"));
+    assert(element.attributes[9] - element.attributes[8] == 5);
+
+    // copies are independent of the original
+    srcml_element copy(element);
+    assert(copy.localname != element.localname);
+    assert(copy.srcsax_attributes[1].value == std::string("f.cpp"));
+    assert(copy.srcsax_attributes[1].value != element.srcsax_attributes[1].value);
+
+    // moves keep the storage
+    const xmlChar * localname = copy.localname;
+    srcml_element moved(std::move(copy));
+    assert(moved.localname == localname);
+    assert(copy.localname == 0 && copy.srcsax_attributes == 0);
+
+    std::vector<srcml_element> elements;
+    for(int i = 0; i < 10; ++i)
+      elements.push_back(element);
+    assert(elements.back().srcsax_namespaces[0].uri == std::string("http://www.srcML.org/srcML/src"));
+
+    moved = srcml_element();
+    assert(moved.localname == 0 && moved.nb_attributes == 0);
+
+  }
+
   return 0;
 }
@@ -19,6 +19,8 @@
  */
 
 #include <srcsax.h>
+#include <srcsax_reader.h>
+#include <srcsax_writer.h>
 #include <srcsax_handler_test.hpp>
 
 #include <stdio.h>
@@ -26,6 +28,10 @@
 #include <fcntl.h>
 #include <string.h>
 #include <cassert>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 /**
  * read_callback
@@ -57,6 +63,503 @@ int close_callback(void * context) {
 
 }
 
+/** unit numbers in the order start_unit was called */
+std::vector<int> start_unit_order;
+
+/** unit numbers in the order end_unit was called */
+std::vector<int> end_unit_order;
+
+/** unit numbers in the order start_unit (positive) and end_unit (negative) were called */
+std::vector<int> unit_event_order;
+
+/** guards the unit order */
+std::mutex unit_order_mutex;
+
+/**
+ * record_start_unit
+ * @param context the srcSAX context
+ *
+ * Record the order of start_unit for testing ordered parallel parsing.
+ */
+void record_start_unit(struct srcsax_context * context, const char *, const char *, const char *,
+                       int, const struct srcsax_namespace *, int, const struct srcsax_attribute *) {
+
+    std::lock_guard<std::mutex> lock(unit_order_mutex);
+    start_unit_order.push_back(context->unit_count);
+    unit_event_order.push_back(context->unit_count);
+
+}
+
+/**
+ * record_end_unit
+ * @param context the srcSAX context
+ *
+ * Record the order of end_unit for testing ordered parallel parsing.
+ */
+void record_end_unit(struct srcsax_context * context, const char *, const char *, const char *) {
+
+    std::lock_guard<std::mutex> lock(unit_order_mutex);
+    end_unit_order.push_back(context->unit_count);
+    unit_event_order.push_back(-context->unit_count);
+
+}
+
+/** number of start_element/end_element/characters_unit/end_unit calls when skipping */
+int skip_start_element_count = 0;
+int skip_end_element_count = 0;
+int skip_characters_count = 0;
+int skip_end_unit_count = 0;
+
+/**
+ * skip_start_unit
+ * @param context the srcSAX context
+ * @param num_attributes the number of attributes on the tag
+ * @param attributes list of attributes
+ *
+ * Skip units with a Java language attribute.
+ */
+void skip_start_unit(struct srcsax_context * context, const char *, const char *, const char *,
+                     int, const struct srcsax_namespace *, int num_attributes, const struct srcsax_attribute * attributes) {
+
+    for(int i = 0; i < num_attributes; ++i)
+        if(strcmp(attributes[i].localname, "language") == 0 && strcmp(attributes[i].value, "Java") == 0)
+            assert(srcsax_skip_subtree(context) == 0);
+
+}
+
+/**
+ * skip_start_element
+ * @param context the srcSAX context
+ * @param localname the name of the element tag
+ *
+ * Skip the contents of expr elements.
+ */
+void skip_start_element(struct srcsax_context * context, const char * localname, const char *, const char *,
+                        int, const struct srcsax_namespace *, int, const struct srcsax_attribute *) {
+
+    ++skip_start_element_count;
+    if(strcmp(localname, "expr") == 0)
+        assert(srcsax_skip_subtree(context) == 0);
+
+}
+
+/**
+ * skip_end_element
+ *
+ * Count end_element calls when skipping.
+ */
+void skip_end_element(struct srcsax_context *, const char *, const char *, const char *) {
+
+    ++skip_end_element_count;
+
+}
+
+/**
+ * skip_characters_unit
+ *
+ * Count characters_unit calls when skipping.
+ */
+void skip_characters_unit(struct srcsax_context *, const char *, int) {
+
+    ++skip_characters_count;
+
+}
+
+/**
+ * skip_end_unit
+ * @param context the srcSAX context
+ *
+ * Count end_unit calls when skipping, the stack is back to the unit.
+ */
+void skip_end_unit(struct srcsax_context * context, const char *, const char *, const char *) {
+
+    ++skip_end_unit_count;
+    assert(srcsax_skip_subtree(context) == -1);
+
+}
+
+/** message of the last srcsax_error call */
+std::string error_message;
+
+/**
+ * record_error
+ * @param message the error message
+ * @param error_code the libxml2 error code
+ *
+ * Record the error message.
+ */
+void record_error(const char * message, int) {
+
+    error_message = message;
+
+}
+
+/** names of the start_element calls and the characters_unit received with subscriptions */
+std::string filter_elements;
+std::string filter_characters;
+
+/**
+ * filter_start_element
+ * @param localname the name of the element tag
+ * @param prefix the tag prefix
+ *
+ * Record the started elements with subscriptions.
+ */
+void filter_start_element(struct srcsax_context *, const char * localname, const char * prefix, const char *,
+                          int, const struct srcsax_namespace *, int, const struct srcsax_attribute *) {
+
+    filter_elements += '<';
+    if(prefix) {
+
+      filter_elements += prefix;
+      filter_elements += ':';
+
+    }
+    filter_elements += localname;
+
+}
+
+/**
+ * filter_end_element
+ * @param localname the name of the element tag
+ *
+ * Record the ended elements with subscriptions.
+ */
+void filter_end_element(struct srcsax_context *, const char * localname, const char *, const char *) {
+
+    filter_elements += "</";
+    filter_elements += localname;
+
+}
+
+/** root attributes passed to start_root */
+const struct srcsax_attribute * root_attributes_start_root = 0;
+
+/**
+ * root_start_root
+ * @param attributes list of attributes
+ *
+ * Record the root attributes passed to start_root.
+ */
+void root_start_root(struct srcsax_context *, const char *, const char *, const char *,
+                     int, const struct srcsax_namespace *, int, const struct srcsax_attribute * attributes) {
+
+    root_attributes_start_root = attributes;
+
+}
+
+/**
+ * root_start_unit
+ * @param context a srcSAX context
+ *
+ * Record the root attributes and namespaces looked up from start_unit.
+ */
+void root_start_unit(struct srcsax_context * context, const char *, const char *, const char *,
+                     int, const struct srcsax_namespace *, int, const struct srcsax_attribute *) {
+
+    int num_attributes = 0;
+    const struct srcsax_attribute * attributes = srcsax_get_root_attributes(context, &num_attributes);
+    assert(attributes == root_attributes_start_root);
+    for(int pos = 0; pos < num_attributes; ++pos) {
+
+        filter_elements += attributes[pos].localname;
+        filter_elements += '=';
+        filter_elements += attributes[pos].value;
+        filter_elements += ';';
+
+    }
+
+    int num_namespaces = 0;
+    const struct srcsax_namespace * namespaces = srcsax_get_root_namespaces(context, &num_namespaces);
+    for(int pos = 0; pos < num_namespaces; ++pos) {
+
+        filter_elements += namespaces[pos].prefix ? namespaces[pos].prefix : "";
+        filter_elements += ':';
+
+    }
+
+}
+
+/**
+ * position_record
+ * @param context a srcSAX context
+ * @param name the name recorded for the callback
+ *
+ * Record the name, offset, line and column of a callback.
+ */
+void position_record(struct srcsax_context * context, const char * name) {
+
+    int line = 0, column = 0;
+    char position[64];
+    if(srcsax_current_position(context, &line, &column) == 0)
+        snprintf(position, sizeof(position), "%s@%ld:%d:%d;", name, srcsax_current_offset(context), line, column);
+    else
+        snprintf(position, sizeof(position), "%s@%ld;", name, srcsax_current_offset(context));
+
+    filter_elements += position;
+
+}
+
+void position_start_root(struct srcsax_context * context, const char *, const char *, const char *,
+                         int, const struct srcsax_namespace *, int, const struct srcsax_attribute *) {
+
+    position_record(context, "root");
+
+}
+
+void position_start_unit(struct srcsax_context * context, const char *, const char *, const char *,
+                         int, const struct srcsax_namespace *, int, const struct srcsax_attribute *) {
+
+    position_record(context, "unit");
+
+}
+
+void position_start_element(struct srcsax_context * context, const char * localname, const char *, const char *,
+                            int, const struct srcsax_namespace *, int, const struct srcsax_attribute *) {
+
+    position_record(context, localname);
+
+}
+
+void position_end_root(struct srcsax_context * context, const char *, const char *, const char *) {
+
+    position_record(context, "/root");
+
+}
+
+void position_end_unit(struct srcsax_context * context, const char *, const char *, const char *) {
+
+    position_record(context, "/unit");
+
+}
+
+void position_end_element(struct srcsax_context * context, const char * localname, const char *, const char *) {
+
+    std::string name = "/";
+    name += localname;
+    position_record(context, name.c_str());
+
+}
+
+void position_characters_unit(struct srcsax_context * context, const char *, int) {
+
+    position_record(context, "text");
+
+}
+
+void position_start_function(struct srcsax_context * context, const char *, const char *, int, const struct srcsax_declaration *, int) {
+
+    position_record(context, "function");
+
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+/**
+ * copy_start
+ *
+ * Write a start tag.  The root of a non-archive is written as its unit.
+ */
+void copy_start(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                const struct srcsax_attribute * attributes) {
+
+    assert(srcsax_write_start_element((srcsax_writer *)context->data, localname, prefix, num_namespaces, namespaces, num_attributes, attributes) == 0);
+
+}
+
+void copy_start_root(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                     int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                     const struct srcsax_attribute * attributes) {
+
+    if(context->is_archive) copy_start(context, localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+}
+
+void copy_end(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI) {
+
+    assert(srcsax_write_end_element((srcsax_writer *)context->data, localname, prefix) == 0);
+
+}
+
+void copy_end_root(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI) {
+
+    if(context->is_archive) copy_end(context, localname, prefix, URI);
+
+}
+
+void copy_meta_tag(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                   int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                   const struct srcsax_attribute * attributes) {
+
+    copy_start(context, localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+    copy_end(context, localname, prefix, URI);
+
+}
+
+void copy_characters(struct srcsax_context * context, const char * ch, int len) {
+
+    assert(srcsax_write_characters((srcsax_writer *)context->data, ch, len) == 0);
+
+}
+
+void copy_start_document(struct srcsax_context * context) {
+
+    assert(srcsax_write_start_document((srcsax_writer *)context->data) == 0);
+
+}
+
+void copy_end_document(struct srcsax_context * context) {
+
+    assert(srcsax_write_end_document((srcsax_writer *)context->data) == 0);
+
+}
+
+/**
+ * transform_start_unit
+ *
+ * Copy the odd units unchanged, when possible, and write the others.
+ */
+void transform_start_unit(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                          int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                          const struct srcsax_attribute * attributes) {
+
+    if(context->unit_count % 2 == 1 && srcsax_copy_subtree(context, (srcsax_writer *)context->data) == 0) return;
+
+    copy_start(context, localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+}
+
+/**
+ * transform_start_element
+ *
+ * Copy expressions unchanged, when possible, and write other elements.
+ */
+void transform_start_element(struct srcsax_context * context, const char * localname, const char * prefix, const char * URI,
+                             int num_namespaces, const struct srcsax_namespace * namespaces, int num_attributes,
+                             const struct srcsax_attribute * attributes) {
+
+    if(strcmp(localname, "expr") == 0 && srcsax_copy_subtree(context, (srcsax_writer *)context->data) == 0) return;
+
+    copy_start(context, localname, prefix, URI, num_namespaces, namespaces, num_attributes, attributes);
+
+}
+
+#pragma GCC diagnostic pop
+
+/**
+ * coalesce_characters_unit
+ * @param ch the characters
+ * @param len number of characters
+ *
+ * Record each call with its characters.
+ */
+void coalesce_characters_unit(struct srcsax_context *, const char * ch, int len) {
+
+    filter_characters += '[';
+    filter_characters.append(ch, len);
+    filter_characters += ']';
+
+}
+
+/**
+ * filter_characters_unit
+ * @param ch the characters
+ * @param len number of characters
+ *
+ * Record the characters with subscriptions.
+ */
+void filter_characters_unit(struct srcsax_context *, const char * ch, int len) {
+
+    filter_characters.append(ch, len);
+
+}
+
+/**
+ * stop_start_unit
+ * @param context a srcSAX context
+ *
+ * Stop the parser from start_unit.
+ */
+void stop_start_unit(struct srcsax_context * context, const char *, const char *, const char *,
+                     int, const struct srcsax_namespace *, int, const struct srcsax_attribute *) {
+
+    srcsax_stop_parser(context);
+
+}
+
+/**
+ * stop_start_element
+ * @param context a srcSAX context
+ *
+ * Stop the parser at the first element.
+ */
+void stop_start_element(struct srcsax_context * context, const char *, const char *, const char *,
+                        int, const struct srcsax_namespace *, int, const struct srcsax_attribute *) {
+
+    srcsax_stop_parser(context);
+
+}
+
+/**
+ * function_start_function
+ * @param context a srcSAX context
+ * @param name the function's name
+ * @param return_type the function return type
+ * @param num_parameters the number of parameters
+ * @param parameter_list the function parameters
+ * @param is_decl indicates if the call is a function declaration (1) or definition (0)
+ *
+ * Record the function signatures among the elements, skipping the body of functions named skip.
+ */
+void function_start_function(struct srcsax_context * context, const char * name, const char * return_type,
+                             int num_parameters, const struct srcsax_declaration * parameter_list, int is_decl) {
+
+    filter_elements += is_decl ? "<decl:" : "<function:";
+    filter_elements += return_type;
+    filter_elements += ' ';
+    filter_elements += name;
+    filter_elements += '(';
+    for(int i = 0; i < num_parameters; ++i) {
+
+      if(i) filter_elements += ',';
+      filter_elements += parameter_list[i].type;
+      filter_elements += '|';
+      filter_elements += parameter_list[i].name;
+
+    }
+    filter_elements += ')';
+
+    if(strcmp(name, "skip") == 0)
+        assert(srcsax_skip_subtree(context) == 0);
+
+}
+
+/**
+ * function_end_function
+ *
+ * Record the end of a function among the elements.
+ */
+void function_end_function(struct srcsax_context *) {
+
+    filter_elements += "</function";
+
+}
+
+/**
+ * count_start_element
+ * @param context a srcSAX context
+ *
+ * Count the elements in the int of the context data.
+ */
+void count_start_element(struct srcsax_context * context, const char *, const char *, const char *,
+                         int, const struct srcsax_namespace *, int, const struct srcsax_attribute *) {
+
+    ++*(int *)context->data;
+
+}
+
 /**
  * main
  *
@@ -607,6 +1110,1500 @@ int main() {
 
   }
 
+  {
+
+    srcsax_handler_test data;
+    srcsax_handler handler = srcsax_handler_test::factory();
+    handler.start_unit = stop_start_unit;
+
+    const char * srcml_buffer = "<unit><unit/><unit/></unit>";
+
+    // stopped while parsing, the context still owns its input
+    srcsax_context * context = srcsax_create_context_memory(srcml_buffer, strlen(srcml_buffer), "UTF-8");
+    context->data = &data;
+    context->handler = &handler;
+
+    srcsax_parse(context);
+    assert(context->unit_count == 1);
+
+    srcsax_free_context(context);
+
+  }
+
+  {
+
+    srcsax_handler_test data;
+    srcsax_handler handler = srcsax_handler_test::factory();
+
+    const char * srcml_buffer = "<unit xmlns=\"http://example.com/other\"><macro-list token=\"M\"/><unit/><unit/></unit>";
+
+    // units and macro lists are detected by name regardless of namespace
+    srcsax_context * context = srcsax_create_context_memory(srcml_buffer, strlen(srcml_buffer), "UTF-8");
+    context->data = &data;
+    context->handler = &handler;
+
+    assert(srcsax_parse(context) == 0);
+    assert(context->is_archive == 1);
+    assert(context->unit_count == 2);
+    assert(data.meta_tag_call_number != 0);
+    assert(data.start_unit_call_number != 0);
+    assert(data.start_element_call_number == 0);
+
+    srcsax_free_context(context);
+
+  }
+
+  /*
+    srcsax_parse_parallel
+   */
+  {
+
+    srcsax_handler_test data;
+    srcsax_handler_test data_one;
+    srcsax_handler_test data_two;
+    srcsax_handler handler = srcsax_handler_test::factory();
+    void * thread_data[] = { &data_one, &data_two };
+
+    const char * srcml_buffer = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+      "<unit xmlns=\"http://www.srcML.org/srcML/src\"><macro-list token=\"M\" type=\"src:macro\"/>\n"
+      "<unit filename=\"a.cpp\"><expr_stmt><expr><name>a</name></expr>;</expr_stmt></unit>\n"
+      "<unit filename=\"b.cpp\"><!-- </unit> --><name><![CDATA[<unit>]]></name></unit>\n"
+      "<unit filename=\"c.cpp\"/>\n"
+      "</unit>\n";
+
+    srcsax_context * context = srcsax_create_context_memory(srcml_buffer, strlen(srcml_buffer), "UTF-8");
+    context->data = &data;
+    context->handler = &handler;
+
+    assert(srcsax_parse_parallel(context, 2, thread_data, 0) == 0);
+    assert(context->is_archive == 1);
+    assert(context->unit_count == 3);
+    assert(data.start_document_call_number == 1);
+    assert(data.start_root_call_number == 2);
+    assert(data.meta_tag_call_number == 3);
+    assert(data.start_unit_call_number == 0);
+    assert(data.end_root_call_number != 0);
+    assert(data.end_document_call_number == data.call_count);
+    assert(data_one.start_unit_call_number != 0 || data_two.start_unit_call_number != 0);
+    assert(data_one.start_root_call_number == 0 && data_two.start_root_call_number == 0);
+    assert(data_one.end_document_call_number == 0 && data_two.end_document_call_number == 0);
+
+    srcsax_free_context(context);
+
+  }
+
+  {
+
+    srcsax_handler handler = srcsax_handler_test::factory();
+    handler.start_unit = record_start_unit;
+    handler.end_unit = record_end_unit;
+
+    std::string srcml = "<unit xmlns=\"http://www.srcML.org/srcML/src\">";
+    for(int i = 0; i < 50; ++i)
+      srcml += "<unit><expr><name>a</name></expr></unit>";
+    srcml += "</unit>";
+
+    srcsax_handler_test data;
+    srcsax_context * context = srcsax_create_context_memory(srcml.c_str(), srcml.size(), "UTF-8");
+    context->data = &data;
+    context->handler = &handler;
+
+    assert(srcsax_parse_parallel(context, 4, 0, 1) == 0);
+    assert(start_unit_order.size() == 50);
+    assert(end_unit_order.size() == 50);
+    for(int i = 0; i < 50; ++i) {
+
+      assert(start_unit_order[i] == i + 1);
+      assert(end_unit_order[i] == i + 1);
+
+    }
+
+    // a unit starts after the preceding units started and ends after they ended
+    assert(unit_event_order.size() == 100);
+    int last_start = 0, last_end = 0;
+    for(std::vector<int>::const_iterator citr = unit_event_order.begin(); citr != unit_event_order.end(); ++citr) {
+
+      if(*citr > 0)
+        assert(*citr == ++last_start);
+      else
+        assert(-*citr == ++last_end && last_end <= last_start);
+
+    }
+
+    srcsax_free_context(context);
+
+  }
+
+  {
+
+    srcsax_handler_test data;
+    srcsax_handler handler = srcsax_handler_test::factory();
+
+    const char * srcml_buffer = "<unit/>";
+
+    srcsax_context * context = srcsax_create_context_memory(srcml_buffer, strlen(srcml_buffer), "UTF-8");
+    context->data = &data;
+    context->handler = &handler;
+
+    assert(srcsax_parse_parallel(context, 2, 0, 0) == 0);
+    assert(data.start_unit_call_number != 0);
+    assert(data.end_document_call_number == data.call_count);
+
+    srcsax_free_context(context);
+
+  }
+
+  {
+
+    // libxml2 shrinks static buffers near their end, which a unit ending in markup reaches
+    std::string srcml = "<unit xmlns=\"http://www.srcML.org/srcML/src\">\n<unit>" + std::string(1000, 'x');
+    for(int i = 0; i < 30; ++i)
+      srcml += "<name>b</name>";
+    srcml += "</unit>\n<unit/>\n</unit>\n";
+
+    srcsax_handler handler = srcsax_handler();
+
+    srcsax_context * context = srcsax_create_context_memory(srcml.c_str(), srcml.size(), 0);
+    context->handler = &handler;
+
+    assert(srcsax_parse_parallel(context, 2, 0, 1) == 0);
+    assert(context->unit_count == 2);
+
+    srcsax_free_context(context);
+
+  }
+
+  {
+
+    srcsax_handler_test data;
+    srcsax_handler handler = srcsax_handler_test::factory();
+
+    const char * srcml_buffer = "<unit><unit><a></b></unit><unit/></unit>";
+
+    srcsax_context * context = srcsax_create_context_memory(srcml_buffer, strlen(srcml_buffer), "UTF-8");
+    context->data = &data;
+    context->handler = &handler;
+
+    context->srcsax_error = record_error;
+
+    error_message = "";
+    assert(srcsax_parse_parallel(context, 2, 0, 0) == -1);
+    std::string message = error_message;
+    assert(message != "" && message[message.size() - 1] != '\n');
+
+    // the last error is kept, only its newline is removed
+    error_message = "";
+    assert(srcsax_parse_parallel(context, 2, 0, 0) == -1);
+    assert(error_message == message);
+
+    srcsax_free_context(context);
+
+  }
+
+  {
+
+    srcsax_handler_test data;
+    srcsax_handler handler = srcsax_handler_test::factory();
+    void * thread_data[] = { &data };
+
+    const char * srcml_buffer = "<unit><unit/><unit/></unit>";
+
+    // per thread data needs an explicit thread count
+    srcsax_context * context = srcsax_create_context_memory(srcml_buffer, strlen(srcml_buffer), "UTF-8");
+    context->data = &data;
+    context->handler = &handler;
+
+    assert(srcsax_parse_parallel(context, 0, thread_data, 0) == -1);
+    assert(srcsax_parse_parallel(context, -1, thread_data, 0) == -1);
+    assert(data.call_count == 0);
+
+    srcsax_free_context(context);
+
+  }
+
+  {
+
+    assert(srcsax_parse_parallel(0, 2, 0, 0) == -1);
+
+  }
+
+  /*
+    srcsax_create_unit_index_memory
+   */
+  {
+
+    const char * srcml_buffer = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+      "<unit xmlns=\"http://www.srcML.org/srcML/src\">\n"
+      "<unit filename=\"a&amp;b.cpp\" language=\"C++\" hash=\"1a\"><name>a</name></unit>\n"
+      "<unit language='C' filename=\"c.c\"/>\n"
+      "</unit>\n";
+
+    srcsax_unit_index * index = srcsax_create_unit_index_memory(srcml_buffer, strlen(srcml_buffer));
+    assert(index != 0);
+    assert(index->archive_size == strlen(srcml_buffer));
+    assert(index->declaration_offset == 0);
+    assert(strcmp(index->root_qname, "unit") == 0);
+    assert(index->unit_count == 2);
+    assert(strncmp(srcml_buffer + index->units[0].offset, "<unit filename", 14) == 0);
+    assert(strncmp(srcml_buffer + index->units[0].offset + index->units[0].length - 7, "</unit>", 7) == 0);
+    assert(strcmp(index->units[0].filename, "a&b.cpp") == 0);
+    assert(strcmp(index->units[0].language, "C++") == 0);
+    assert(strcmp(index->units[0].hash, "1a") == 0);
+    assert(strcmp(index->units[1].filename, "c.c") == 0);
+    assert(strcmp(index->units[1].language, "C") == 0);
+    assert(index->units[1].hash == 0);
+    assert(srcsax_find_unit(index, "c.c") == 1);
+    assert(srcsax_find_unit(index, "d.c") == -1);
+
+    srcsax_free_unit_index(index);
+
+  }
+
+  {
+
+    const char * srcml_buffer = "<unit/>";
+
+    assert(srcsax_create_unit_index_memory(srcml_buffer, strlen(srcml_buffer)) == 0);
+    assert(srcsax_create_unit_index_memory(0, 0) == 0);
+    assert(srcsax_create_unit_index(0) == 0);
+    assert(srcsax_read_unit_index(0) == 0);
+    assert(srcsax_write_unit_index(0, "unit_index_test.xml.idx") == -1);
+
+  }
+
+  /*
+    srcsax_create_unit_index/srcsax_create_context_unit
+   */
+  {
+
+    const char * srcml_buffer = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+      "<unit xmlns=\"http://www.srcML.org/srcML/src\">\n"
+      "<macro-list token=\"M\" type=\"src:macro\"/>\n"
+      "<unit filename=\"a.cpp\"><name>a</name></unit>\n"
+      "<unit filename=\"b.cpp\"><name>b</name></unit>\n"
+      "<unit filename=\"c.cpp\"><name>c</name></unit>\n"
+      "</unit>\n";
+
+    FILE * file = fopen("unit_index_test.xml", "wb");
+    fwrite(srcml_buffer, 1, strlen(srcml_buffer), file);
+    fclose(file);
+
+    srcsax_unit_index * index = srcsax_create_unit_index("unit_index_test.xml");
+    assert(index != 0);
+    assert(index->unit_count == 3);
+    assert(srcsax_write_unit_index(index, "unit_index_test.xml.idx") == 0);
+    srcsax_free_unit_index(index);
+
+    index = srcsax_read_unit_index("unit_index_test.xml.idx");
+    assert(index != 0);
+    assert(index->unit_count == 3);
+    assert(index->declaration_length != 0);
+    assert(index->header_length == strlen("\n<macro-list token=\"M\" type=\"src:macro\"/>\n"));
+    assert(strcmp(index->root_qname, "unit") == 0);
+    assert(strcmp(index->units[2].filename, "c.cpp") == 0);
+    assert(index->units[2].hash == 0);
+
+    srcsax_handler_test data;
+    srcsax_handler handler = srcsax_handler_test::factory();
+
+    srcsax_context * context = srcsax_create_context_unit("unit_index_test.xml", index, 1, 2, 0);
+    assert(context != 0);
+    context->data = &data;
+    context->handler = &handler;
+
+    assert(srcsax_parse(context) == 0);
+    assert(context->is_archive == 1);
+    assert(context->unit_count == 1);
+    assert(data.start_root_call_number == 2);
+    assert(data.meta_tag_call_number == 3);
+    assert(data.start_unit_call_number != 0);
+
+    srcsax_free_context(context);
+
+    context = srcsax_create_context_unit("unit_index_test.xml", index, 1, 3, 0);
+    assert(context != 0);
+    context->handler = &handler;
+    context->data = &data;
+    assert(srcsax_parse(context) == 0);
+    assert(context->unit_count == 2);
+    srcsax_free_context(context);
+
+    assert(srcsax_create_context_unit("unit_index_test.xml", index, 2, 4, 0) == 0);
+    assert(srcsax_create_context_unit("unit_index_test.xml", index, 1, 1, 0) == 0);
+    assert(srcsax_create_context_unit(__FILE__, index, 0, 1, 0) == 0);
+
+    srcsax_free_unit_index(index);
+
+    remove("unit_index_test.xml");
+    remove("unit_index_test.xml.idx");
+
+  }
+
+  /*
+    srcsax_create_context_mmap
+   */
+  {
+
+    // a file of exactly one page has no zero bytes after it in its own mapping
+    std::string srcml = "<unit xmlns=\"http://www.srcML.org/srcML/src\"><unit><name>a</name></unit>";
+    srcml.append((size_t)sysconf(_SC_PAGESIZE) - srcml.size() - 7, ' ');
+    srcml += "</unit>";
+
+    FILE * file = fopen("mmap_test.xml", "wb");
+    fwrite(srcml.c_str(), 1, srcml.size(), file);
+    fclose(file);
+
+    srcsax_handler_test data;
+    srcsax_handler handler = srcsax_handler_test::factory();
+
+    srcsax_context * context = srcsax_create_context_mmap("mmap_test.xml", 0);
+    assert(context != 0);
+    assert(context->mapping != 0);
+    context->data = &data;
+    context->handler = &handler;
+
+    assert(srcsax_parse(context) == 0);
+    assert(context->unit_count == 1);
+    assert(data.end_document_call_number == data.call_count);
+
+    srcsax_free_context(context);
+
+    remove("mmap_test.xml");
+
+  }
+
+  {
+
+    // larger than libxml2's first conversion of the input
+    std::string srcml = "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n<unit>";
+    for(int i = 0; i < 1000; ++i)
+      srcml += "<name>\xE9</name>";
+    srcml += "</unit>";
+
+    FILE * file = fopen("mmap_test.xml", "wb");
+    fwrite(srcml.c_str(), 1, srcml.size(), file);
+    fclose(file);
+
+    srcsax_handler_test data;
+    srcsax_handler handler = srcsax_handler_test::factory();
+
+    srcsax_context * context = srcsax_create_context_mmap("mmap_test.xml", 0);
+    assert(context != 0);
+    context->data = &data;
+    context->handler = &handler;
+    assert(srcsax_parse(context) == 0);
+    srcsax_free_context(context);
+
+    context = srcsax_create_context_mmap("mmap_test.xml", "ISO-8859-1");
+    assert(context != 0);
+    context->data = &data;
+    context->handler = &handler;
+    assert(srcsax_parse(context) == 0);
+    srcsax_free_context(context);
+
+    remove("mmap_test.xml");
+
+  }
+
+  {
+
+    // libxml2 shrinks static buffers near their end, which a document ending in markup reaches
+    std::string srcml = "<unit xmlns=\"http://www.srcML.org/srcML/src\">\n<unit>" + std::string(1000, 'x') + "</unit>\n<unit>";
+    for(int i = 0; i < 30; ++i)
+      srcml += "<name>b</name>";
+    srcml += "</unit>\n</unit>\n";
+
+    FILE * file = fopen("mmap_test.xml", "wb");
+    fwrite(srcml.c_str(), 1, srcml.size(), file);
+    fclose(file);
+
+    srcsax_handler_test data;
+    srcsax_handler handler = srcsax_handler_test::factory();
+
+    srcsax_context * context = srcsax_create_context_mmap("mmap_test.xml", 0);
+    assert(context != 0);
+    context->data = &data;
+    context->handler = &handler;
+    assert(srcsax_enable_stats(context, 0) == 0);
+
+    assert(srcsax_parse(context) == 0);
+    assert(context->unit_count == 2);
+
+    srcsax_stats stats;
+    assert(srcsax_get_stats(context, &stats) == 0);
+    assert(stats.bytes_consumed == srcml.size());
+
+    srcsax_free_context(context);
+
+    remove("mmap_test.xml");
+
+  }
+
+  {
+
+    assert(srcsax_create_context_mmap(0, 0) == 0);
+    assert(srcsax_create_context_mmap("mmap_test_missing.xml", 0) == 0);
+
+  }
+
+  /*
+    srcsax_parse_chunk
+   */
+  {
+
+    srcsax_handler_test data;
+    srcsax_handler handler = srcsax_handler_test::factory();
+
+    const char * srcml_buffer = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<unit xmlns=\"http://www.srcML.org/srcML/src\"><unit filename=\"a.cpp\"><expr><name>a</name></expr></unit>"
+      "<unit filename=\"b.cpp\"/></unit>";
+
+    srcsax_context * context = srcsax_create_push_context(0);
+    assert(context != 0);
+    context->data = &data;
+    context->handler = &handler;
+
+    // one byte at a time
+    size_t length = strlen(srcml_buffer);
+    for(size_t pos = 0; pos < length; ++pos)
+      assert(srcsax_parse_chunk(context, srcml_buffer + pos, 1, 0) == 0);
+
+    assert(data.end_document_call_number == 0);
+    assert(srcsax_parse_chunk(context, 0, 0, 1) == 0);
+    assert(context->is_archive == 1);
+    assert(context->unit_count == 2);
+    assert(data.start_document_call_number == 1);
+    assert(data.start_root_call_number == 2);
+    assert(data.end_document_call_number == data.call_count);
+
+    srcsax_free_context(context);
+
+  }
+
+  {
+
+    srcsax_handler_test data;
+    srcsax_handler handler = srcsax_handler_test::factory();
+
+    const char * srcml_buffer = "<unit><name>";
+
+    srcsax_context * context = srcsax_create_push_context("UTF-8");
+    context->data = &data;
+    context->handler = &handler;
+
+    assert(srcsax_parse_chunk(context, srcml_buffer, strlen(srcml_buffer), 0) == 0);
+    assert(srcsax_parse_chunk(context, "</unit>", 7, 1) == -1);
+    assert(srcsax_parse(context) == -1);
+
+    srcsax_free_context(context);
+
+  }
+
+  {
+
+    srcsax_handler_test data;
+    srcsax_handler handler = srcsax_handler_test::factory();
+
+    const char * srcml_buffer = "<unit/>";
+
+    srcsax_context * context = srcsax_create_context_memory(srcml_buffer, strlen(srcml_buffer), "UTF-8");
+    context->data = &data;
+    context->handler = &handler;
+
+    assert(srcsax_parse_chunk(context, srcml_buffer, strlen(srcml_buffer), 1) == -1);
+    assert(srcsax_parse_chunk(0, srcml_buffer, strlen(srcml_buffer), 1) == -1);
+
+    srcsax_free_context(context);
+
+  }
+
+  /*
+    srcsax_create_reader/srcsax_reader_next
+   */
+
+  {
+
+    const char * srcml_buffer = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+      "<unit xmlns=\"http://www.srcML.org/srcML/src\"><unit filename=\"a.cpp\"><expr><name>a</name></expr><!--c--></unit>"
+      "<unit filename=\"b.cpp\"/></unit>";
+
+    srcsax_context * context = srcsax_create_context_memory(srcml_buffer, strlen(srcml_buffer), "UTF-8");
+    srcsax_reader * reader = srcsax_create_reader(context);
+    assert(reader != 0);
+
+    std::vector<srcsax_event_type> types;
+    const srcsax_event * event;
+    while(srcsax_reader_next(reader, &event) == 1) {
+
+      types.push_back(event->type);
+
+      if(event->type == SRCSAX_START_UNIT && types.size() == 4) {
+
+        assert(strcmp(event->localname, "unit") == 0);
+        assert(event->num_attributes == 1);
+        assert(strcmp(event->attributes[0].localname, "filename") == 0);
+        assert(strcmp(event->attributes[0].value, "a.cpp") == 0);
+        assert(strcmp(srcsax_element_name(srcsax_reader_context(reader), event->element_id), "unit") == 0);
+
+      }
+
+      if(event->type == SRCSAX_CHARACTERS_UNIT) {
+
+        assert(event->length == 1);
+        assert(strcmp(event->value, "a") == 0);
+        assert(event->stack_size == 4);
+
+      }
+
+      if(event->type == SRCSAX_COMMENT)
+        assert(strcmp(event->value, "c") == 0);
+
+    }
+
+    const srcsax_event_type expected[] = { SRCSAX_START_DOCUMENT, SRCSAX_START_ROOT, SRCSAX_CHARACTERS_ROOT, SRCSAX_START_UNIT,
+                                           SRCSAX_START_ELEMENT, SRCSAX_START_ELEMENT, SRCSAX_CHARACTERS_UNIT, SRCSAX_END_ELEMENT, SRCSAX_END_ELEMENT,
+                                           SRCSAX_COMMENT, SRCSAX_END_UNIT, SRCSAX_START_UNIT, SRCSAX_END_UNIT, SRCSAX_END_ROOT,
+                                           SRCSAX_END_DOCUMENT };
+    assert(types == std::vector<srcsax_event_type>(expected, expected + sizeof(expected) / sizeof(expected[0])));
+    assert(srcsax_reader_next(reader, &event) == 0);
+    assert(srcsax_reader_context(reader)->unit_count == 2);
+
+    srcsax_free_reader(reader);
+    srcsax_free_context(context);
+
+  }
+
+  {
+
+    // larger than a chunk, read through the io callbacks
+    FILE * file = fopen("reader_test.xml", "w");
+    fputs("<unit xmlns=\"http://www.srcML.org/srcML/src\">", file);
+    for(int i = 0; i < 2000; ++i)
+      fputs("<unit filename=\"a.cpp\"><expr><name>a</name></expr></unit>", file);
+    fputs("</unit>", file);
+    fclose(file);
+
+    file = fopen("reader_test.xml", "r");
+    srcsax_context * context = srcsax_create_context_io(file, read_callback, close_callback, 0);
+    srcsax_reader * reader = srcsax_create_reader(context);
+
+    int start_unit_count = 0;
+    int characters_count = 0;
+    const srcsax_event * event;
+    int status;
+    while((status = srcsax_reader_next(reader, &event)) == 1) {
+
+      if(event->type == SRCSAX_START_UNIT) ++start_unit_count;
+      if(event->type == SRCSAX_CHARACTERS_UNIT) ++characters_count;
+
+    }
+
+    assert(status == 0);
+    assert(start_unit_count == 2000);
+    assert(characters_count == 2000);
+
+    srcsax_free_reader(reader);
+    srcsax_free_context(context);
+
+    context = srcsax_create_context_filename("reader_test.xml", 0);
+    reader = srcsax_create_reader(context);
+
+    // stopped after the first unit
+    start_unit_count = 0;
+    while(srcsax_reader_next(reader, &event) == 1)
+      if(event->type == SRCSAX_END_UNIT && ++start_unit_count == 1)
+        srcsax_stop_parser(srcsax_reader_context(reader));
+
+    assert(start_unit_count < 2000);
+
+    srcsax_free_reader(reader);
+    srcsax_free_context(context);
+
+    unlink("reader_test.xml");
+
+  }
+
+  {
+
+    const char * srcml_buffer = "<unit><name></unit>";
+
+    srcsax_context * context = srcsax_create_context_memory(srcml_buffer, strlen(srcml_buffer), "UTF-8");
+    srcsax_reader * reader = srcsax_create_reader(context);
+
+    const srcsax_event * event;
+    int status;
+    while((status = srcsax_reader_next(reader, &event)) == 1)
+      ;
+
+    assert(status == -1);
+    assert(event == 0);
+    assert(srcsax_reader_next(reader, &event) == -1);
+
+    srcsax_free_reader(reader);
+    srcsax_free_context(context);
+
+  }
+
+  {
+
+    srcsax_context * context = srcsax_create_push_context(0);
+    assert(srcsax_create_reader(context) == 0);
+    assert(srcsax_create_reader(0) == 0);
+    assert(srcsax_reader_next(0, 0) == -1);
+    assert(srcsax_reader_context(0) == 0);
+    srcsax_free_reader(0);
+
+    srcsax_free_context(context);
+
+  }
+
+  /*
+    srcsax_skip_subtree
+   */
+
+  {
+
+    srcsax_handler handler = srcsax_handler_test::factory();
+    handler.start_unit = skip_start_unit;
+    handler.start_element = skip_start_element;
+    handler.end_element = skip_end_element;
+    handler.characters_unit = skip_characters_unit;
+    handler.end_unit = skip_end_unit;
+
+    const char * srcml_buffer = "<unit xmlns=\"http://www.srcML.org/srcML/src\">"
+      "<unit language=\"C++\"><expr><name>a</name><op>+</op><expr><name>c</name></expr></expr><name>b</name></unit>"
+      "<unit language=\"Java\"><name>c</name><!--c--></unit><unit language=\"C\"><name>d</name></unit></unit>";
+
+    srcsax_handler_test data;
+    srcsax_context * context = srcsax_create_context_memory(srcml_buffer, strlen(srcml_buffer), "UTF-8");
+    context->data = &data;
+    context->handler = &handler;
+
+    skip_start_element_count = skip_end_element_count = skip_characters_count = skip_end_unit_count = 0;
+    assert(srcsax_parse(context) == 0);
+    assert(skip_start_element_count == 3);
+    assert(skip_end_element_count == 3);
+    assert(skip_characters_count == 2);
+    assert(skip_end_unit_count == 3);
+    assert(data.comment_call_number == 0);
+    assert(context->unit_count == 3);
+    assert(srcsax_skip_subtree(context) == -1);
+
+    srcsax_free_context(context);
+
+  }
+
+  {
+
+    srcsax_handler handler = srcsax_handler_test::factory();
+    handler.start_unit = skip_start_unit;
+    handler.start_element = skip_start_element;
+    handler.end_element = skip_end_element;
+    handler.characters_unit = skip_characters_unit;
+    handler.end_unit = skip_end_unit;
+
+    const char * srcml_buffer = "<unit xmlns=\"http://www.srcML.org/srcML/src\" language=\"Java\">a<name>c</name><name>d</name></unit>";
+
+    srcsax_handler_test data;
+    srcsax_context * context = srcsax_create_context_memory(srcml_buffer, strlen(srcml_buffer), "UTF-8");
+    context->data = &data;
+    context->handler = &handler;
+
+    skip_start_element_count = skip_end_element_count = skip_characters_count = skip_end_unit_count = 0;
+    assert(srcsax_parse(context) == 0);
+    assert(skip_start_element_count == 0);
+    assert(skip_end_element_count == 0);
+    assert(skip_characters_count == 0);
+    assert(skip_end_unit_count == 1);
+    assert(data.end_root_call_number != 0);
+    assert(data.end_document_call_number == data.call_count);
+
+    srcsax_free_context(context);
+
+  }
+
+  {
+
+    srcsax_handler handler = srcsax_handler_test::factory();
+    handler.start_element = skip_start_element;
+    handler.end_element = skip_end_element;
+    handler.characters_unit = skip_characters_unit;
+
+    const char * srcml_buffer = "<unit><expr><name>a</name></expr><name>b</name></unit>";
+
+    srcsax_handler_test data;
+    srcsax_context * context = srcsax_create_push_context(0);
+    context->data = &data;
+    context->handler = &handler;
+
+    // skipping across chunks
+    skip_start_element_count = skip_end_element_count = skip_characters_count = 0;
+    size_t length = strlen(srcml_buffer);
+    for(size_t pos = 0; pos < length; ++pos)
+      assert(srcsax_parse_chunk(context, srcml_buffer + pos, 1, 0) == 0);
+    assert(srcsax_parse_chunk(context, 0, 0, 1) == 0);
+    assert(skip_start_element_count == 2);
+    assert(skip_end_element_count == 2);
+    assert(skip_characters_count == 1);
+
+    srcsax_free_context(context);
+
+    assert(srcsax_skip_subtree(0) == -1);
+
+  }
+
+  /*
+    srcsax_subscribe_element
+   */
+
+  {
+
+    srcsax_handler handler = srcsax_handler_test::factory();
+    handler.start_element = filter_start_element;
+    handler.end_element = filter_end_element;
+    handler.characters_unit = filter_characters_unit;
+
+    const char * srcml_buffer = "<unit xmlns=\"http://www.srcML.org/srcML/src\" xmlns:cpp=\"http://www.srcML.org/srcML/cpp\" xmlns:pos=\"http://www.srcML.org/srcML/position\">"
+      "<unit><cpp:include>#<cpp:directive>include</cpp:directive> <cpp:file>&lt;a&gt;</cpp:file></cpp:include>\n"
+      "<function><type><name>int</name></type> <name>f</name><parameter_list>()</parameter_list> <block>{<pos:position/>}</block></function></unit>"
+      "<unit><expr><name>a</name></expr>;</unit></unit>";
+
+    srcsax_handler_test data;
+    srcsax_context * context = srcsax_create_context_memory(srcml_buffer, strlen(srcml_buffer), "UTF-8");
+    context->data = &data;
+    context->handler = &handler;
+
+    assert(srcsax_subscribe_element(context, "cpp:include") == 0);
+    assert(srcsax_subscribe_element(context, "src:name") == 0);
+    assert(srcsax_subscribe_element_id(context, SRCML_SRC_PARAMETER_LIST) == 0);
+    assert(srcsax_subscribe_element(context, "pos:position") == 0);
+
+    filter_elements = filter_characters = "";
+    assert(srcsax_parse(context) == 0);
+    assert(filter_elements == "<cpp:include</include<name</name<name</name<parameter_list</parameter_list<pos:position</position<name</name");
+    assert(filter_characters == "#include <a>intf()a");
+    assert(data.start_unit_call_number != 0);
+    assert(context->unit_count == 2);
+
+    srcsax_clear_subscriptions(context);
+    srcsax_free_context(context);
+
+  }
+
+  {
+
+    srcsax_handler handler = srcsax_handler_test::factory();
+    handler.start_element = filter_start_element;
+    handler.end_element = filter_end_element;
+    handler.characters_unit = filter_characters_unit;
+
+    const char * srcml_buffer = "<unit xmlns=\"http://www.srcML.org/srcML/src\">a<expr><name>b</name>+<name>c</name></expr></unit>";
+
+    srcsax_handler_test data;
+    srcsax_context * context = srcsax_create_context_memory(srcml_buffer, strlen(srcml_buffer), "UTF-8");
+    context->data = &data;
+    context->handler = &handler;
+
+    assert(srcsax_subscribe_element(context, "expr") == 0);
+
+    filter_elements = filter_characters = "";
+    assert(srcsax_parse(context) == 0);
+    assert(filter_elements == "<expr</expr");
+    assert(filter_characters == "b+c");
+
+    assert(srcsax_subscribe_element(0, "expr") == -1);
+    assert(srcsax_subscribe_element(context, 0) == -1);
+    assert(srcsax_subscribe_element(context, "") == -1);
+    assert(srcsax_subscribe_element_id(context, SRCML_ELEMENT_UNKNOWN) == -1);
+    assert(srcsax_subscribe_element_id(context, SRCML_ELEMENT_ID_COUNT) == -1);
+    srcsax_clear_subscriptions(0);
+
+    srcsax_free_context(context);
+
+  }
+
+  /*
+    srcsax_enable_stats
+   */
+
+  {
+
+    srcsax_handler handler = srcsax_handler_test::factory();
+
+    const char * srcml_buffer = "<unit><unit><expr><name>a</name></expr></unit><unit><name>b</name></unit></unit>";
+
+    srcsax_handler_test data;
+    srcsax_context * context = srcsax_create_context_memory(srcml_buffer, strlen(srcml_buffer), "UTF-8");
+    context->data = &data;
+    context->handler = &handler;
+
+    srcsax_stats stats;
+    assert(srcsax_get_stats(context, &stats) == -1);
+    assert(srcsax_enable_stats(context, 1) == 0);
+    assert(srcsax_parse(context) == 0);
+    assert(context->handler == &handler);
+
+    assert(srcsax_get_stats(context, &stats) == 0);
+    assert(stats.start_document == 1);
+    assert(stats.end_document == 1);
+    assert(stats.start_root == 1);
+    assert(stats.end_root == 1);
+    assert(stats.start_unit == 2);
+    assert(stats.end_unit == 2);
+    assert(stats.start_element == 3);
+    assert(stats.end_element == 3);
+    assert(stats.characters_unit == 2);
+    assert(stats.comment == 0);
+    assert(stats.bytes_consumed == strlen(srcml_buffer));
+    assert(stats.max_stack_depth == 4);
+    assert(stats.marshal_allocations != 0);
+    assert(stats.callback_time >= 0);
+    assert(stats.parser_time > 0);
+    assert(stats.units_per_second > 0);
+
+    srcsax_disable_stats(context);
+    assert(srcsax_get_stats(context, &stats) == -1);
+    srcsax_free_context(context);
+
+    assert(srcsax_enable_stats(0, 0) == -1);
+    assert(srcsax_get_stats(0, &stats) == -1);
+    srcsax_disable_stats(0);
+
+  }
+
+  {
+
+    srcsax_handler handler = srcsax_handler_test::factory();
+    handler.comment = 0;
+
+    const char * srcml_buffer = "<unit><expr><name>a</name></expr><!-- c --></unit>";
+
+    srcsax_handler_test data;
+    srcsax_context * context = srcsax_create_push_context(0);
+    context->data = &data;
+    context->handler = &handler;
+
+    assert(srcsax_enable_stats(context, 0) == 0);
+    size_t length = strlen(srcml_buffer);
+    for(size_t pos = 0; pos < length; ++pos)
+      assert(srcsax_parse_chunk(context, srcml_buffer + pos, 1, 0) == 0);
+    assert(srcsax_parse_chunk(context, 0, 0, 1) == 0);
+    assert(context->handler == &handler);
+
+    srcsax_stats stats;
+    assert(srcsax_get_stats(context, &stats) == 0);
+    assert(stats.start_unit == 1);
+    assert(stats.end_unit == 1);
+    assert(stats.start_element == 2);
+    assert(stats.end_element == 2);
+    assert(stats.comment == 0);
+    assert(stats.bytes_consumed == length);
+    assert(stats.max_stack_depth == 3);
+    assert(stats.callback_time == 0);
+    assert(stats.parser_time == 0);
+
+    srcsax_free_context(context);
+
+  }
+
+  /*
+    srcsax_reset_context
+   */
+
+  {
+
+    srcsax_handler handler = srcsax_handler_test::factory();
+    handler.start_element = filter_start_element;
+    handler.end_element = filter_end_element;
+    handler.characters_unit = filter_characters_unit;
+
+    const char * first_buffer = "<unit><unit><expr><name>a</name></expr></unit><unit><name>b</name></unit></unit>";
+    const char * second_buffer = "<unit xmlns=\"http://www.srcML.org/srcML/src\"><decl><name>c</name></decl></unit>";
+    const char * error_buffer = "<unit><name></unit>";
+
+    srcsax_handler_test data;
+    srcsax_context * context = srcsax_create_context_memory(first_buffer, strlen(first_buffer), "UTF-8");
+    context->data = &data;
+    context->handler = &handler;
+
+    filter_elements = filter_characters = "";
+    assert(srcsax_parse(context) == 0);
+    assert(filter_elements == "<expr<name</name</expr<name</name");
+    assert(context->unit_count == 2);
+    assert(context->is_archive);
+
+    // reused parser context and parse state
+    xmlParserCtxtPtr ctxt = context->libxml2_context;
+    void * parse_state = context->parse_state;
+
+    srcsax_handler_test second_data;
+    context->data = &second_data;
+    assert(srcsax_reset_context_memory(context, second_buffer, strlen(second_buffer), 0) == 0);
+    assert(context->libxml2_context == ctxt);
+    assert(context->handler == &handler);
+    assert(context->unit_count == 0);
+
+    filter_elements = filter_characters = "";
+    assert(srcsax_parse(context) == 0);
+    assert(context->parse_state == parse_state);
+    assert(filter_elements == "<decl<name</name</decl");
+    assert(filter_characters == "c");
+    assert(context->unit_count == 1);
+    assert(!context->is_archive);
+    assert(second_data.start_unit_call_number != 0);
+
+    // after an error
+    srcsax_handler_test error_data;
+    context->data = &error_data;
+    assert(srcsax_reset_context_memory(context, error_buffer, strlen(error_buffer), 0) == 0);
+    assert(srcsax_parse(context) != 0);
+
+    // after stopping
+    srcsax_handler_test stop_data;
+    context->data = &stop_data;
+    assert(srcsax_reset_context_memory(context, first_buffer, strlen(first_buffer), 0) == 0);
+    handler.start_element = stop_start_element;
+    assert(srcsax_parse(context) == 0);
+    assert(context->terminate);
+    handler = srcsax_handler_test::factory();
+    handler.start_element = filter_start_element;
+    handler.end_element = filter_end_element;
+    handler.characters_unit = filter_characters_unit;
+
+    FILE * file = fopen("reset_test.xml", "w");
+    fputs(second_buffer, file);
+    fclose(file);
+
+    srcsax_handler_test file_data;
+    context->data = &file_data;
+    assert(srcsax_reset_context_filename(context, "reset_test.xml", 0) == 0);
+    filter_elements = filter_characters = "";
+    assert(srcsax_parse(context) == 0);
+    assert(filter_elements == "<decl<name</name</decl");
+    remove("reset_test.xml");
+
+    assert(srcsax_reset_context(context, 0) == -1);
+    assert(srcsax_reset_context_memory(context, 0, 0, 0) == -1);
+    assert(srcsax_reset_context_filename(context, 0, 0) == -1);
+    assert(srcsax_reset_context_memory(0, second_buffer, strlen(second_buffer), 0) == -1);
+
+    srcsax_free_context(context);
+
+  }
+
+  {
+
+    srcsax_handler handler = srcsax_handler_test::factory();
+    handler.start_element = filter_start_element;
+    handler.end_element = filter_end_element;
+    handler.characters_unit = filter_characters_unit;
+
+    const char * first_buffer = "<unit><expr><name>a</name></expr></unit>";
+    const char * second_buffer = "<unit><unit><name>b</name></unit></unit>";
+
+    srcsax_handler_test data;
+    srcsax_context * context = srcsax_create_push_context(0);
+    context->data = &data;
+    context->handler = &handler;
+
+    filter_elements = filter_characters = "";
+    assert(srcsax_parse_chunk(context, first_buffer, strlen(first_buffer), 1) == 0);
+    assert(filter_elements == "<expr<name</name</expr");
+
+    srcsax_handler_test second_data;
+    context->data = &second_data;
+    assert(srcsax_reset_context(context, 0) == 0);
+
+    filter_elements = filter_characters = "";
+    size_t length = strlen(second_buffer);
+    for(size_t pos = 0; pos < length; ++pos)
+      assert(srcsax_parse_chunk(context, second_buffer + pos, 1, 0) == 0);
+    assert(srcsax_parse_chunk(context, 0, 0, 1) == 0);
+    assert(filter_elements == "<name</name");
+    assert(filter_characters == "b");
+    assert(context->unit_count == 1);
+    assert(context->is_archive);
+
+    assert(srcsax_reset_context_memory(context, second_buffer, length, 0) == -1);
+
+    srcsax_free_context(context);
+
+  }
+
+  /*
+    srcsax_context_pool
+   */
+
+  {
+
+    const char * buffer = "<unit><decl><name>a</name></decl></unit>";
+    srcsax_context_pool * pool = srcsax_create_context_pool(1);
+    assert(pool);
+
+    srcsax_handler handler = srcsax_handler();
+    handler.start_element = count_start_element;
+
+    srcsax_context * first = srcsax_context_pool_acquire_memory(pool, buffer, strlen(buffer), 0);
+    srcsax_context * second = srcsax_context_pool_acquire_memory(pool, buffer, strlen(buffer), 0);
+    assert(first && second && first != second);
+
+    int first_count = 0;
+    first->data = &first_count;
+    assert(srcsax_parse_handler(first, &handler) == 0);
+    assert(first_count == 2);
+
+    srcsax_context_pool_release(pool, first);
+    srcsax_context_pool_release(pool, second);
+    assert(srcsax_context_pool_idle(pool) == 1);
+
+    srcsax_context * reused = srcsax_context_pool_acquire_memory(pool, buffer, strlen(buffer), 0);
+    assert(reused == first);
+    assert(reused->data == 0 && reused->handler == 0);
+    assert(srcsax_context_pool_idle(pool) == 0);
+
+    int reused_count = 0;
+    reused->data = &reused_count;
+    assert(srcsax_parse_handler(reused, &handler) == 0);
+    assert(reused_count == 2);
+    srcsax_context_pool_release(pool, reused);
+
+    assert(srcsax_context_pool_acquire_memory(pool, 0, 0, 0) == 0);
+    assert(srcsax_context_pool_acquire_memory(0, buffer, strlen(buffer), 0) == 0);
+    assert(srcsax_context_pool_acquire_filename(pool, 0, 0) == 0);
+    assert(srcsax_context_pool_idle(pool) == 1);
+
+    srcsax_free_context_pool(pool);
+
+  }
+
+  {
+
+    const char * buffer = "<unit><decl><name>a</name></decl><expr><name>b</name></expr></unit>";
+    srcsax_context_pool * pool = srcsax_create_context_pool(0);
+
+    std::vector<int> counts(4, 0);
+    std::vector<std::thread> workers;
+    for(int thread = 0; thread < 4; ++thread)
+        workers.push_back(std::thread([pool, buffer, &counts, thread]() {
+
+            srcsax_handler handler = srcsax_handler();
+            handler.start_element = count_start_element;
+
+            for(int i = 0; i < 50; ++i) {
+
+                srcsax_context * context = srcsax_context_pool_acquire_memory(pool, buffer, strlen(buffer), 0);
+                assert(context);
+                context->data = &counts[thread];
+                assert(srcsax_parse_handler(context, &handler) == 0);
+                srcsax_context_pool_release(pool, context);
+
+            }
+
+        }));
+
+    for(std::vector<std::thread>::iterator itr = workers.begin(); itr != workers.end(); ++itr)
+        itr->join();
+
+    for(int thread = 0; thread < 4; ++thread)
+        assert(counts[thread] == 50 * 4);
+    assert(srcsax_context_pool_idle(pool) >= 1 && srcsax_context_pool_idle(pool) <= 4);
+
+    srcsax_free_context_pool(pool);
+
+  }
+
+  /*
+    srcsax_enable_function
+   */
+
+  {
+
+    // older srcML has param, current srcML parameter
+    const char * buffer = "<unit><function><type><name>int</name></type> <name>main</name><parameter_list>("
+      "<param><decl><type><name>int</name></type> <name>argc</name></decl></param>, "
+      "<parameter><decl><type><name>char</name> <modifier>*</modifier></type> <name><name>argv</name><index>[]</index></name></decl></parameter>)"
+      "</parameter_list> <block>{ <return>return <expr><name>argc</name></expr>;</return> }</block></function>\n"
+      "<function_decl><type><name>void</name></type> <name><name>A</name><operator>::</operator><name>f</name></name><parameter_list>()</parameter_list>;</function_decl>\n"
+      "<function><type><name>void</name></type> <name>skip</name><parameter_list>()</parameter_list> <block>{ <expr><name>a</name></expr>; }</block></function>\n"
+      "</unit>";
+
+    srcsax_handler handler = srcsax_handler();
+    handler.start_element = filter_start_element;
+    handler.end_element = filter_end_element;
+    handler.characters_unit = filter_characters_unit;
+    handler.start_function = function_start_function;
+    handler.end_function = function_end_function;
+
+    srcsax_context * context = srcsax_create_context_memory(buffer, strlen(buffer), 0);
+    context->handler = &handler;
+    assert(srcsax_enable_function(context, 1) == 0);
+    assert(srcsax_enable_function(0, 1) == -1);
+
+    filter_elements = filter_characters = "";
+    assert(srcsax_parse(context) == 0);
+    assert(filter_elements == "<function:int main(int|argc,char *|argv[])<block<return<expr<name</name</expr</return</block</function"
+                              "<decl:void A::f()</function"
+                              "<function:void skip()</function");
+    assert(filter_characters == " { return argc; }\n;\n\n");
+
+    // disabled, functions are elements again
+    assert(srcsax_reset_context_memory(context, buffer, strlen(buffer), 0) == 0);
+    assert(srcsax_enable_function(context, 0) == 0);
+    filter_elements = "";
+    assert(srcsax_parse(context) == 0);
+    assert(filter_elements.compare(0, 21, "<function<type<name</") == 0);
+
+    srcsax_free_context(context);
+
+  }
+
+  /*
+    srcsax_enable_coalescing
+   */
+
+  {
+
+    const char * buffer = "<unit><expr><name>a</name> &lt; <name>b</name> &amp;&amp; c &#x00e9;t\u00e9</expr>\n</unit>";
+
+    srcsax_handler handler = srcsax_handler();
+    handler.characters_unit = coalesce_characters_unit;
+
+    srcsax_context * context = srcsax_create_context_memory(buffer, strlen(buffer), 0);
+    context->handler = &handler;
+    assert(srcsax_enable_coalescing(context, 1) == 0);
+    assert(srcsax_enable_coalescing(0, 1) == -1);
+
+    filter_characters = "";
+    assert(srcsax_parse(context) == 0);
+    assert(filter_characters == "[a][ < ][b][ && c \u00e9t\u00e9][\n]");
+
+    // disabled, runs are split at the entity references
+    assert(srcsax_reset_context_memory(context, buffer, strlen(buffer), 0) == 0);
+    assert(srcsax_enable_coalescing(context, 0) == 0);
+    filter_characters = "";
+    assert(srcsax_parse(context) == 0);
+    assert(filter_characters != "[a][ < ][b][ && c \u00e9t\u00e9][\n]");
+    assert(filter_characters.compare(0, 6, "[a][ ]") == 0);
+
+    srcsax_free_context(context);
+
+    // runs split across chunks
+    context = srcsax_create_push_context(0);
+    context->handler = &handler;
+    assert(srcsax_enable_coalescing(context, 1) == 0);
+
+    filter_characters = "";
+    for(size_t pos = 0; pos < strlen(buffer); pos += 3)
+      assert(srcsax_parse_chunk(context, buffer + pos, strlen(buffer) - pos < 3 ? strlen(buffer) - pos : 3, 0) == 0);
+    assert(srcsax_parse_chunk(context, 0, 0, 1) == 0);
+    assert(filter_characters == "[a][ < ][b][ && c \u00e9t\u00e9][\n]");
+
+    srcsax_free_context(context);
+
+  }
+
+  /*
+    srcsax_get_root_attributes
+   */
+
+  {
+
+    const char * buffer = "<unit xmlns=\"http://www.srcML.org/srcML/src\" xmlns:cpp=\"http://www.srcML.org/srcML/cpp\" revision=\"1.0\" url=\"project\">"
+      "<unit filename=\"a.cpp\"><expr><name>a</name></expr>;</unit><unit filename=\"b.cpp\"/></unit>";
+
+    srcsax_handler handler = srcsax_handler();
+    handler.start_root = root_start_root;
+    handler.start_unit = root_start_unit;
+
+    srcsax_context * context = srcsax_create_context_memory(buffer, strlen(buffer), 0);
+    context->handler = &handler;
+
+    int num_attributes = -1;
+    assert(srcsax_get_root_attributes(context, &num_attributes) == 0 && num_attributes == 0);
+    assert(srcsax_get_root_namespaces(0, 0) == 0);
+
+    filter_elements = "";
+    assert(srcsax_parse(context) == 0);
+    assert(filter_elements == "revision=1.0;url=project;:cpp:revision=1.0;url=project;:cpp:");
+
+    assert(srcsax_get_root_attributes(context, &num_attributes) == 0);
+
+    srcsax_free_context(context);
+
+  }
+
+  /*
+    srcsax_current_offset
+   */
+
+  {
+
+    const char * buffer = "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n<unit xmlns=\"http://www.srcML.org/srcML/src\">\n"
+      "<unit filename=\"\xe9.c\"><function><name>f</name><parameter_list>()</parameter_list>\n  <block>{}</block></function></unit>\n</unit>\n";
+
+    srcsax_handler handler = srcsax_handler();
+    handler.start_root = position_start_root;
+    handler.start_unit = position_start_unit;
+    handler.start_element = position_start_element;
+    handler.end_root = position_end_root;
+    handler.end_unit = position_end_unit;
+    handler.end_element = position_end_element;
+    handler.characters_unit = position_characters_unit;
+
+    assert(srcsax_current_offset(0) == -1);
+    assert(srcsax_current_position(0, 0, 0) == -1);
+
+    srcsax_context * context = srcsax_create_context_memory(buffer, strlen(buffer), 0);
+    context->handler = &handler;
+
+    // offsets are in the original encoding, columns in the converted one
+    filter_elements = "";
+    assert(srcsax_parse(context) == 0);
+    assert(filter_elements == "root@44:2:1;unit@90:3:1;function@111:3:23;name@121:3:33;text@127;/name@128:3:40;parameter_list@135:3:47;text@151;"
+                              "/parameter_list@153:3:65;text@173;block@173:4:3;text@180;/block@182:4:12;/function@190:4:20;/unit@201:4:31;/root@209:5:1;");
+    assert(srcsax_current_offset(context) == -1);
+
+    // the header of a function is at its start tag
+    handler.start_element = 0;
+    handler.end_element = 0;
+    handler.characters_unit = 0;
+    handler.start_function = position_start_function;
+    assert(srcsax_reset_context_memory(context, buffer, strlen(buffer), 0) == 0);
+    assert(srcsax_enable_function(context, 1) == 0);
+    filter_elements = "";
+    assert(srcsax_parse(context) == 0);
+    assert(filter_elements == "root@44:2:1;unit@90:3:1;function@111:3:23;/unit@201:4:31;/root@209:5:1;");
+
+    srcsax_free_context(context);
+
+    // the root of a non-archive is its unit, and its end_root is at its end tag
+    buffer = "<unit xmlns=\"http://www.srcML.org/srcML/src\">a<name>b</name></unit>\n";
+    handler.start_element = position_start_element;
+    context = srcsax_create_context_memory(buffer, strlen(buffer), 0);
+    context->handler = &handler;
+    filter_elements = "";
+    assert(srcsax_parse(context) == 0);
+    assert(filter_elements == "root@0:1:1;unit@0:1:1;name@46:1:47;/unit@60:1:61;/root@60:1:61;");
+
+    srcsax_free_context(context);
+
+  }
+
+  {
+
+    const char * buffer = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<unit xmlns=\"http://www.srcML.org/srcML/src\">\n"
+      "<unit filename=\"a.c\"><name>a</name>\n  <name>b</name></unit><unit filename=\"b.c\"><name>c</name></unit>\n"
+      "\n<unit filename=\"c.c\">\n<expr><name>d</name></expr></unit>\n</unit>\n";
+
+    srcsax_handler handler = srcsax_handler();
+    handler.start_root = position_start_root;
+    handler.start_unit = position_start_unit;
+    handler.start_element = position_start_element;
+    handler.end_unit = position_end_unit;
+    handler.end_element = position_end_element;
+
+    srcsax_context * context = srcsax_create_context_memory(buffer, strlen(buffer), 0);
+    context->handler = &handler;
+    filter_elements = "";
+    assert(srcsax_parse(context) == 0);
+    std::string positions = filter_elements;
+    srcsax_free_context(context);
+
+    // positions in the unit documents are reported in the complete input
+    context = srcsax_create_context_memory(buffer, strlen(buffer), 0);
+    context->handler = &handler;
+    filter_elements = "";
+    assert(srcsax_parse_parallel(context, 1, 0, 1) == 0);
+    assert(filter_elements == positions);
+    assert(filter_elements.find("unit@144:4:24;") != std::string::npos);
+    srcsax_free_context(context);
+
+  }
+
+  /*
+    srcsax_writer
+   */
+
+  {
+
+    srcsax_writer * writer = srcsax_create_writer_memory();
+    assert(writer != 0);
+
+    srcsax_namespace namespaces[2] = { { 0, "http://www.srcML.org/srcML/src" }, { "cpp", "http://www.srcML.org/srcML/cpp" } };
+    srcsax_attribute attributes[2] = { { "filename", 0, 0, "a<b>&\"c\".cpp" }, { "tabs", "pos", "http://www.srcML.org/srcML/position", "\t" } };
+    const char * text = "if(a < b && b > c) { s = \"x\"; }\r\n    /* more than sixteen characters & more */";
+
+    assert(srcsax_write_start_document(writer) == 0);
+    assert(srcsax_write_start_element(writer, "unit", 0, 2, namespaces, 2, attributes) == 0);
+    assert(srcsax_write_characters(writer, text, (int)strlen(text)) == 0);
+    assert(srcsax_write_start_element(writer, "include", "cpp", 0, 0, 0, 0) == 0);
+    assert(srcsax_write_end_element(writer, "include", "cpp") == 0);
+    assert(srcsax_write_start_element(writer, "unit", 0, 2, namespaces, 0, 0) == 0);
+    assert(srcsax_write_comment(writer, " c ") == 0);
+    assert(srcsax_write_cdata_block(writer, "<&>", 3) == 0);
+    assert(srcsax_write_processing_instruction(writer, "pi", "data") == 0);
+    assert(srcsax_write_end_element(writer, "unit", 0) == 0);
+    assert(srcsax_write_end_element(writer, "unit", 0) == 0);
+    assert(srcsax_write_end_document(writer) == 0);
+
+    size_t size = 0;
+    const char * output = srcsax_writer_memory(writer, &size);
+    assert(std::string(output, size) ==
+           "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+           "<unit xmlns=\"http://www.srcML.org/srcML/src\" xmlns:cpp=\"http://www.srcML.org/srcML/cpp\" filename=\"a&lt;b&gt;&amp;&quot;c&quot;.cpp\" pos:tabs=\"&#9;\">"
+           "if(a &lt; b &amp;&amp; b &gt; c) { s = \"x\"; }&#13;\n    /* more than sixteen characters &amp; more */"
+           "<cpp:include/>"
+           "<unit xmlns=\"http://www.srcML.org/srcML/src\" xmlns:cpp=\"http://www.srcML.org/srcML/cpp\"><!-- c --><![CDATA[<&>]]><?pi data?></unit></unit>\n");
+
+    assert(srcsax_write_start_element(writer, 0, 0, 0, 0, 0, 0) == -1);
+    assert(srcsax_write_characters(0, "a", 1) == -1);
+    assert(srcsax_writer_memory(0, &size) == 0);
+    assert(srcsax_free_writer(writer) == 0);
+
+    // identity copy of a parse, through a file larger than the output buffer
+    std::string srcml = "<unit xmlns=\"http://www.srcML.org/srcML/src\" xmlns:cpp=\"http://www.srcML.org/srcML/cpp\">";
+    for(int unit = 0; unit < 50; ++unit)
+      srcml += "<unit filename=\"a.cpp\"><cpp:include>#<cpp:directive>include</cpp:directive> <cpp:file>&lt;a&gt;</cpp:file></cpp:include>\n"
+               "<expr><name>a</name> &amp;&amp; <name>b</name></expr>;<empty/>\n" + std::string(unit == 25 ? 40000 : 2000, 'x') + "</unit>\n\n";
+    srcml += "</unit>";
+
+    srcsax_handler handler = srcsax_handler();
+    handler.start_document = copy_start_document;
+    handler.end_document = copy_end_document;
+    handler.start_root = copy_start_root;
+    handler.start_unit = copy_start;
+    handler.start_element = copy_start;
+    handler.end_root = copy_end_root;
+    handler.end_unit = copy_end;
+    handler.end_element = copy_end;
+    handler.characters_root = copy_characters;
+    handler.characters_unit = copy_characters;
+    handler.meta_tag = copy_meta_tag;
+
+    const char * filename = "srcsax_writer_test.xml";
+    writer = srcsax_create_writer_filename(filename);
+    assert(writer != 0);
+
+    srcsax_context * context = srcsax_create_context_memory(srcml.c_str(), srcml.size(), 0);
+    context->data = writer;
+    // whole text runs, so the long one is written directly
+    assert(srcsax_enable_coalescing(context, 1) == 0);
+    assert(srcsax_parse_handler(context, &handler) == 0);
+    srcsax_free_context(context);
+    assert(srcsax_free_writer(writer) == 0);
+
+    std::string copy;
+    FILE * file = fopen(filename, "r");
+    assert(file != 0);
+    char buffer[4096];
+    for(size_t count; (count = fread(buffer, 1, sizeof(buffer), file)) > 0; )
+      copy.append(buffer, count);
+    fclose(file);
+    unlink(filename);
+
+    assert(copy == "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n" + srcml + "\n");
+
+    assert(srcsax_create_writer_fd(-1) == 0);
+    assert(srcsax_create_writer_filename(0) == 0);
+
+  }
+
+  /*
+    srcsax_copy_subtree
+   */
+
+  {
+
+    // formatting and references the writer would not reproduce show what is copied
+    const char * declaration = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n";
+    std::string root = "<unit xmlns=\"http://www.srcML.org/srcML/src\" xmlns:cpp=\"http://www.srcML.org/srcML/cpp\">\n\n";
+    std::string unit_a = "<unit filename='a.cpp' >  <expr><name>a</name> &#x26;&amp; <empty /></expr>;" + std::string(100000, 'x') + "</unit>";
+    std::string expr_b = "<expr><name  >b</name >&gt;<call/></expr>";
+    std::string unit_c = "<unit filename='c.cpp'><cpp:empty /></unit>";
+    std::string srcml = declaration + root + unit_a + "\n\n"
+                      + "<unit filename=\"b.cpp\"><expr_stmt>" + expr_b + "</expr_stmt>;<name>c</name ></unit>\n\n"
+                      + unit_c + "\n\n</unit>\n";
+    std::string transformed = declaration + root + unit_a + "\n\n"
+                            + "<unit filename=\"b.cpp\"><expr_stmt>" + expr_b + "</expr_stmt>;<name>c</name></unit>\n\n"
+                            + unit_c + "\n\n</unit>\n";
+
+    srcsax_handler handler = srcsax_handler();
+    handler.start_document = copy_start_document;
+    handler.end_document = copy_end_document;
+    handler.start_root = copy_start_root;
+    handler.start_unit = transform_start_unit;
+    handler.start_element = transform_start_element;
+    handler.end_root = copy_end_root;
+    handler.end_unit = copy_end;
+    handler.end_element = copy_end;
+    handler.characters_root = copy_characters;
+    handler.characters_unit = copy_characters;
+
+    srcsax_writer * writer = srcsax_create_writer_memory();
+    srcsax_context * context = srcsax_create_context_memory(srcml.c_str(), srcml.size(), 0);
+    context->data = writer;
+    assert(srcsax_parse_handler(context, &handler) == 0);
+    assert(srcsax_copy_subtree(context, writer) == -1);
+    srcsax_free_context(context);
+
+    size_t size = 0;
+    const char * output = srcsax_writer_memory(writer, &size);
+    assert(std::string(output, size) == transformed);
+    assert(srcsax_free_writer(writer) == 0);
+
+    // through a file, from a memory mapped context
+    FILE * file = fopen("copy_test.xml", "wb");
+    fwrite(srcml.c_str(), 1, srcml.size(), file);
+    fclose(file);
+
+    writer = srcsax_create_writer_filename("copy_output_test.xml");
+    context = srcsax_create_context_mmap("copy_test.xml", 0);
+    context->data = writer;
+    assert(srcsax_parse_handler(context, &handler) == 0);
+    srcsax_free_context(context);
+    assert(srcsax_free_writer(writer) == 0);
+
+    std::string copy;
+    file = fopen("copy_output_test.xml", "r");
+    assert(file != 0);
+    char buffer[4096];
+    for(size_t count; (count = fread(buffer, 1, sizeof(buffer), file)) > 0; )
+      copy.append(buffer, count);
+    fclose(file);
+    remove("copy_output_test.xml");
+
+    assert(copy == transformed);
+
+    // without the original input everything is written
+    writer = srcsax_create_writer_memory();
+    context = srcsax_create_context_filename("copy_test.xml", 0);
+    context->data = writer;
+    assert(srcsax_parse_handler(context, &handler) == 0);
+    srcsax_free_context(context);
+    remove("copy_test.xml");
+
+    output = srcsax_writer_memory(writer, &size);
+    assert(std::string(output, size) == declaration + root
+           + "<unit filename=\"a.cpp\">  <expr><name>a</name> &amp;&amp; <empty/></expr>;" + std::string(100000, 'x') + "</unit>\n\n"
+           + "<unit filename=\"b.cpp\"><expr_stmt><expr><name>b</name>&gt;<call/></expr></expr_stmt>;<name>c</name></unit>\n\n"
+           + "<unit filename=\"c.cpp\"><cpp:empty/></unit>\n\n</unit>\n");
+    assert(srcsax_free_writer(writer) == 0);
+
+    // the unit of a non-archive is its root
+    std::string unit = "<unit xmlns=\"http://www.srcML.org/srcML/src\" filename = 'd.cpp'><name>d</name ></unit>";
+    srcml = declaration + unit;
+    writer = srcsax_create_writer_memory();
+    context = srcsax_create_context_memory(srcml.c_str(), srcml.size(), 0);
+    context->data = writer;
+    assert(srcsax_parse_handler(context, &handler) == 0);
+    srcsax_free_context(context);
+
+    output = srcsax_writer_memory(writer, &size);
+    assert(std::string(output, size) == declaration + unit + "\n");
+    assert(srcsax_free_writer(writer) == 0);
+
+  }
+
   return 0;
 
 }
@@ -0,0 +1,234 @@
+#!/usr/bin/env python
+#
+# srcml_element_id_gen.py
+#
+# Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+#
+# This file is part of the srcML SAX2 Framework.
+#
+# The srcML SAX2 Framework is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# The srcML SAX2 Framework is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with the srcML SAX2 Framework; if not, write to the Free Software
+# Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+#
+# Generates the srcML element ID enum (src/srcsax/srcml_element_id.h) and
+# its perfect hash lookup table (src/srcsax/srcml_element_id.cpp).
+#
+# Useage: python tools/srcml_element_id_gen.py
+#
+# The hash is hash and displace: a FNV-1a hash of the localname (seeded by
+# namespace) selects a bucket, and the bucket's displacement is mixed into
+# the hash to select a collision free slot.  Rerun after editing the tag lists.
+
+import os
+
+SRC_ELEMENTS = """
+unit macro-list escape comment literal operator modifier name type condition
+block index decl decl_stmt init range argument_list argument parameter_list param parameter
+krparameter_list krparameter member_list expr expr_stmt empty_stmt
+if then else elseif while do for foreach control incr switch case default break
+continue return goto label typedef asm macro enum
+function function_decl specifier struct struct_decl union union_decl
+class class_decl public private protected signal forever emit
+constructor constructor_decl destructor destructor_decl member_init_list super
+call template try catch throw throws finally extern namespace using lambda
+sizeof typeid noexcept decltype alignof alignas typename attribute annotation
+package import interface interface_decl static synchronized assert
+lock fixed checked unchecked unsafe event property delegate using_stmt friend
+ternary position
+""".split()
+
+CPP_ELEMENTS = """
+directive file include define undef line if ifdef ifndef else elif endif then
+pragma error warning value number literal macro empty region endregion import mark
+""".split()
+
+NAMESPACES = [ ("SRC", SRC_ELEMENTS), ("CPP", CPP_ELEMENTS) ]
+
+MASK = 0xffffffff
+
+def fnv1a(namespace, name):
+    h = (2166136261 ^ (namespace * 0x9e3779b9)) & MASK
+    for c in name.encode('ascii'):
+        h ^= c
+        h = (h * 16777619) & MASK
+    return h
+
+def mix(h):
+    h ^= h >> 16
+    h = (h * 0x85ebca6b) & MASK
+    h ^= h >> 13
+    h = (h * 0xc2b2ae35) & MASK
+    h ^= h >> 16
+    return h
+
+def build(keys, bucket_count, slot_count):
+
+    buckets = [[] for i in range(bucket_count)]
+    for key in keys:
+        buckets[fnv1a(key[0], key[1]) % bucket_count].append(key)
+
+    displacements = [0] * bucket_count
+    slots = [None] * slot_count
+    for bucket in sorted(range(bucket_count), key=lambda b: -len(buckets[b])):
+
+        if not buckets[bucket]: continue
+
+        for displacement in range(1, 1 << 20):
+
+            positions = [mix(fnv1a(key[0], key[1]) ^ displacement) & (slot_count - 1) for key in buckets[bucket]]
+            if len(set(positions)) == len(positions) and all(slots[pos] is None for pos in positions):
+                break
+
+        else:
+            raise Exception("no displacement found")
+
+        displacements[bucket] = displacement
+        for key, pos in zip(buckets[bucket], positions):
+            slots[pos] = key
+
+    return displacements, slots
+
+def enum_name(prefix, name):
+    return "SRCML_%s_%s" % (prefix, name.upper().replace('-', '_'))
+
+LICENSE = """ *
+ * @copyright Copyright (C) 2014 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcML SAX2 Framework.
+ *
+ * The srcML SAX2 Framework is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML SAX2 Framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML SAX2 Framework; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Generated by tools/srcml_element_id_gen.py, do not edit.
+ */
+"""
+
+def main():
+
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "srcsax")
+
+    keys = []
+    ids = {}
+    for namespace, (prefix, elements) in enumerate(NAMESPACES):
+        for name in elements:
+            ids[(namespace, name)] = len(keys) + 1
+            keys.append((namespace, name, enum_name(prefix, name)))
+
+    # slots are stored as unsigned char
+    assert len(keys) < 256
+
+    bucket_count = (len(keys) + 3) // 4
+    slot_count = 1
+    while slot_count < len(keys) * 2: slot_count *= 2
+
+    displacements, slots = build([(k[0], k[1]) for k in keys], bucket_count, slot_count)
+
+    with open(os.path.join(root, "srcml_element_id.h"), "w") as header:
+
+        header.write("/**\n * @file srcml_element_id.h\n" + LICENSE + "\n")
+        header.write("#ifndef INCLUDED_SRCML_ELEMENT_ID_H\n#define INCLUDED_SRCML_ELEMENT_ID_H\n\n")
+        header.write("/**\n * srcml_element_id\n *\n * IDs of the known srcML (src and cpp namespace) elements.\n")
+        header.write(" * Elements outside of this vocabulary are given IDs of SRCML_ELEMENT_ID_COUNT and up\n * as they are encountered.\n */\n")
+        header.write("enum srcml_element_id {\n\n    SRCML_ELEMENT_UNKNOWN = 0,\n\n")
+        for key in keys:
+            header.write("    %s,\n" % key[2])
+        header.write("\n    SRCML_ELEMENT_ID_COUNT\n\n};\n\n#endif\n")
+
+    with open(os.path.join(root, "srcml_element_id.cpp"), "w") as source:
+
+        source.write("/**\n * @file srcml_element_id.cpp\n" + LICENSE + "\n")
+        source.write("#include <srcml_element_table.hpp>\n\n#include <cstring>\n\n")
+
+        source.write("/** number of perfect hash buckets */\nstatic const unsigned int BUCKET_COUNT = %d;\n\n" % bucket_count)
+        source.write("/** number of perfect hash slots (power of 2) */\nstatic const unsigned int SLOT_COUNT = %d;\n\n" % slot_count)
+
+        source.write("/** perfect hash bucket displacements */\nstatic const unsigned int displacements[BUCKET_COUNT] = {")
+        for pos, displacement in enumerate(displacements):
+            source.write("%s%d," % ("\n    " if pos % 16 == 0 else " ", displacement))
+        source.write("\n};\n\n")
+
+        source.write("/** perfect hash slot element IDs */\nstatic const unsigned char slots[SLOT_COUNT] = {")
+        for pos, slot in enumerate(slots):
+            source.write("%s%d," % ("\n    " if pos % 16 == 0 else " ", ids[slot] if slot else 0))
+        source.write("\n};\n\n")
+
+        source.write("/** element namespace and localname by ID */\nstatic const struct { int ns; const char * localname; } elements[SRCML_ELEMENT_ID_COUNT] = {\n\n")
+        source.write("    { SRCML_NAMESPACE_OTHER, 0 },\n")
+        for key in keys:
+            source.write("    { %s, \"%s\" },\n" % ("SRCML_NAMESPACE_SRC" if key[0] == 0 else "SRCML_NAMESPACE_CPP", key[1]))
+        source.write("\n};\n\n")
+
+        source.write("""/**
+ * srcml_element_id_known
+ * @param ns the srcml_element_namespace of the element
+ * @param localname the name of the element
+ *
+ * Perfect hash lookup of a known srcML element.
+ *
+ * @returns the element's ID or SRCML_ELEMENT_UNKNOWN if not a known srcML element.
+ */
+int srcml_element_id_known(int ns, const char * localname) {
+
+    if(ns == SRCML_NAMESPACE_OTHER || localname == 0) return SRCML_ELEMENT_UNKNOWN;
+
+    unsigned int hash = 2166136261u ^ ((unsigned int)ns * 0x9e3779b9u);
+    for(const unsigned char * pos = (const unsigned char *)localname; *pos; ++pos) {
+
+        hash ^= *pos;
+        hash *= 16777619u;
+
+    }
+
+    unsigned int slot = hash ^ displacements[hash % BUCKET_COUNT];
+    slot ^= slot >> 16;
+    slot *= 0x85ebca6bu;
+    slot ^= slot >> 13;
+    slot *= 0xc2b2ae35u;
+    slot ^= slot >> 16;
+
+    int id = slots[slot & (SLOT_COUNT - 1)];
+    if(id == SRCML_ELEMENT_UNKNOWN || elements[id].ns != ns || strcmp(elements[id].localname, localname) != 0)
+        return SRCML_ELEMENT_UNKNOWN;
+
+    return id;
+
+}
+
+/**
+ * srcml_element_id_known_name
+ * @param id a known srcML element ID
+ *
+ * @returns the localname of the known element or 0 if not a known ID.
+ */
+const char * srcml_element_id_known_name(int id) {
+
+    if(id <= SRCML_ELEMENT_UNKNOWN || id >= SRCML_ELEMENT_ID_COUNT) return 0;
+
+    return elements[id].localname;
+
+}
+""")
+
+if __name__ == "__main__":
+    main()